@@ -0,0 +1,664 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2013 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+/**
+ * Benchmarks of the hot paths of Eliot (dictionary and move generation),
+ * on a synthetic dictionary (see SyntheticDic), so that they can be run
+ * anywhere, and compared between versions.
+ *
+ * The results are written in a tab-separated format (one line per
+ * benchmark, comments starting with '#'), and can be compared with
+ * the results of a previous run (see the --baseline option).
+ */
+
+#include "config.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <map>
+#include <cstdlib>
+#include <boost/foreach.hpp>
+#include <boost/format.hpp>
+#include <boost/function.hpp>
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <getopt.h>
+
+#include "synthetic_dic.h"
+#include "compdic.h"
+#include "dic.h"
+#include "dic_exception.h"
+#include "game_params.h"
+#include "game_factory.h"
+#include "game.h"
+#include "ai_percent.h"
+#include "history.h"
+#include "turn_data.h"
+#include "move.h"
+#include "board.h"
+#include "bag.h"
+#include "rack.h"
+#include "results.h"
+#include "random.h"
+#include "settings.h"
+#include "xml_writer.h"
+#include "xml_reader.h"
+#include "base_exception.h"
+
+using namespace std;
+
+#define FMT1(s, a1) (boost::format(s) % (a1)).str()
+
+
+/// Version of the format of the results
+static const int kFORMAT_VERSION = 1;
+
+/// Number of turns played on the canned boards
+static const unsigned kBOARD_TURNS[] = { 4, 8, 12, 16 };
+/// Number of racks searched on each board
+static const unsigned kNB_BOARD_RACKS = 16;
+/// Number of racks given to search7pl1()
+static const unsigned kNB_7PL1_RACKS = 100;
+/// Number of searchWord() calls (half of them on existing words)
+static const unsigned kNB_SEARCHED_WORDS = 20000;
+
+static const wchar_t * const kREGEXPS[] =
+{
+    L"A.*", L".*ENT", L"B.*S", L"[AEIOU][^AEIOU].*", L"CA.E.*", L":v::c:.*"
+};
+static const unsigned kNB_REGEXPS = sizeof(kREGEXPS) / sizeof(kREGEXPS[0]);
+
+/// Accumulate the results of the benchmarks, so that the compiler
+/// cannot optimize the calls away
+static volatile unsigned long g_sink = 0;
+
+
+typedef vector<boost::shared_ptr<Board> > BoardList;
+
+
+/// Options of the program
+struct Options
+{
+    unsigned nbWords;
+    uint64_t seed;
+    unsigned iterations;
+    unsigned nbThreads;
+    string dataDir;
+    string filter;
+    string output;
+    string baseline;
+    double tolerance;
+};
+
+
+/// Result of a benchmark
+struct BenchResult
+{
+    string name;
+    unsigned iterations;
+    /// Number of operations done by one iteration
+    unsigned nbOps;
+    /// Times of the iterations, in milliseconds (sorted)
+    vector<double> times;
+
+    double getMin() const { return times.front(); }
+    double getMedian() const { return times[times.size() / 2]; }
+    double getNsPerOp() const { return getMedian() * 1e6 / nbOps; }
+};
+
+
+/**
+ * Run the benchmarks and collect their results.
+ * Each benchmark is run once without being measured (to fill the caches),
+ * then the given number of times.
+ */
+class BenchRunner
+{
+public:
+    BenchRunner(unsigned iIterations, const string &iFilter)
+        : m_iterations(iIterations), m_filter(iFilter) {}
+
+    /// Return true if the benchmark with the given name must be run
+    bool isSelected(const string &iName) const
+    {
+        return m_filter.empty() || iName.find(m_filter) != string::npos;
+    }
+
+    void run(const string &iName, unsigned iNbOps,
+             const boost::function<void()> &iBody)
+    {
+        if (!isSelected(iName))
+            return;
+
+        cerr << "Running " << iName << "..." << endl;
+        iBody();
+
+        BenchResult result;
+        result.name = iName;
+        result.iterations = m_iterations;
+        result.nbOps = iNbOps;
+        for (unsigned i = 0; i < m_iterations; ++i)
+        {
+            const boost::posix_time::ptime start = Now();
+            iBody();
+            const boost::posix_time::time_duration elapsed = Now() - start;
+            result.times.push_back(elapsed.total_microseconds() / 1000.);
+        }
+        sort(result.times.begin(), result.times.end());
+        m_results.push_back(result);
+    }
+
+    const vector<BenchResult> & getResults() const { return m_results; }
+
+private:
+    unsigned m_iterations;
+    string m_filter;
+    vector<BenchResult> m_results;
+
+    static boost::posix_time::ptime Now()
+    {
+        return boost::posix_time::microsec_clock::universal_time();
+    }
+};
+
+
+static void buildDic(const string &iWordList, const string &iDawgFile,
+                     bool iGaddag)
+{
+    CompDic builder;
+    SyntheticDic::AddLetters(builder);
+    builder.setBuildGaddag(iGaddag);
+    const Header &header = builder.generateDawg(iWordList, iDawgFile, "Synthetic");
+    g_sink += header.getNbWords();
+}
+
+
+static void loadDic(const string &iDawgFile)
+{
+    Dictionary dic(iDawgFile);
+    g_sink += dic.getHeader().getNbWords();
+}
+
+
+static void searchWords(const Dictionary &iDic, const vector<wstring> &iWords)
+{
+    BOOST_FOREACH(const wstring &word, iWords)
+    {
+        g_sink += iDic.searchWord(word);
+    }
+}
+
+
+static void search7pl1(const Dictionary &iDic, const vector<wstring> &iRacks)
+{
+    vector<map<unsigned int, vector<wdstring> > > wordLists;
+    iDic.search7pl1(iRacks, wordLists, true);
+    g_sink += wordLists.size();
+}
+
+
+static void searchRegExps(const Dictionary &iDic)
+{
+    for (unsigned i = 0; i < kNB_REGEXPS; ++i)
+    {
+        vector<wdstring> wordList;
+        iDic.searchRegExp(kREGEXPS[i], wordList, 1, 15);
+        g_sink += wordList.size();
+    }
+}
+
+
+static void buildCross(const Dictionary &iDic, const BoardList &iBoards)
+{
+    BOOST_FOREACH(const boost::shared_ptr<Board> &board, iBoards)
+    {
+        board->beginBulkLoad(iDic);
+        board->endBulkLoad();
+    }
+}
+
+
+/**
+ * Search the racks on each board. Each search is done on a copy of the
+ * board, which starts with an empty search cache: otherwise all the
+ * measured searches would be replayed from the cache filled by the
+ * previous iterations. The copy of the grids is negligible compared
+ * to a search.
+ */
+static void searchBoards(const Dictionary &iDic, const BoardList &iBoards,
+                         const vector<Rack> &iRacks)
+{
+    BOOST_FOREACH(const boost::shared_ptr<Board> &board, iBoards)
+    {
+        BOOST_FOREACH(const Rack &rack, iRacks)
+        {
+            const Board boardCopy(*board);
+            BestResults results;
+            boardCopy.search(iDic, rack, results);
+            g_sink += results.size();
+        }
+    }
+}
+
+
+static void readXml(const Dictionary &iDic, const string &iFileName)
+{
+    boost::scoped_ptr<Game> game(XmlReader::read(iFileName, iDic));
+    g_sink += game->getHistory().getSize();
+}
+
+
+/// Play a complete duplicate game between 2 AI players
+static Game * playDuplicate(const Dictionary &iDic, uint64_t iSeed)
+{
+    GameParams params(iDic, GameParams::kDUPLICATE);
+    Game *game = GameFactory::Instance()->createGame(params);
+    game->accessRandom().setSeed(iSeed);
+    game->addPlayer(new AIPercent(1));
+    game->addPlayer(new AIPercent(0.8));
+    game->start();
+    return game;
+}
+
+
+static void benchDuplicate(const Dictionary &iDic, uint64_t iSeed)
+{
+    boost::scoped_ptr<Game> game(playDuplicate(iDic, iSeed));
+    g_sink += game->getPoints();
+}
+
+
+/// Build boards from the first turns of the game
+static void buildBoards(const Dictionary &iDic, const Game &iGame,
+                        BoardList &oBoards)
+{
+    const History &history = iGame.getHistory();
+    BOOST_FOREACH(unsigned nbTurns, kBOARD_TURNS)
+    {
+        if (nbTurns > history.getSize())
+            break;
+        boost::shared_ptr<Board> board(new Board(iGame.getParams()));
+        board->beginBulkLoad(iDic);
+        for (unsigned i = 0; i < nbTurns; ++i)
+        {
+            const Move &move = history.getTurn(i).getMove();
+            if (move.isValid())
+                board->addRound(iDic, move.getRound());
+        }
+        board->endBulkLoad();
+        oBoards.push_back(board);
+    }
+}
+
+
+/// Draw random racks of 7 tiles from a full bag
+static void drawRacks(const Dictionary &iDic, Random &ioRandom,
+                      unsigned iNbRacks, vector<Rack> &oRacks)
+{
+    const Bag fullBag(iDic);
+    for (unsigned i = 0; i < iNbRacks; ++i)
+    {
+        Bag bag(fullBag);
+        Rack rack;
+        for (unsigned j = 0; j < 7; ++j)
+        {
+            const Tile &tile = bag.selectRandom(ioRandom);
+            bag.takeTile(tile);
+            rack.add(tile);
+        }
+        oRacks.push_back(rack);
+    }
+}
+
+
+/// Return the letters of the rack, as expected by search7pl1()
+static wstring rackLetters(const Rack &iRack)
+{
+    vector<Tile> tiles;
+    iRack.getTiles(tiles);
+    wstring letters;
+    BOOST_FOREACH(const Tile &tile, tiles)
+    {
+        letters += tile.isJoker() ? L'?' : tile.toChar();
+    }
+    return letters;
+}
+
+
+static void runBenchmarks(const Options &iOptions, BenchRunner &ioRunner)
+{
+    const string wordListFile = iOptions.dataDir + "/bench-words.txt";
+    const string dawgFile = iOptions.dataDir + "/bench.dawg";
+    const string gaddagFile = iOptions.dataDir + "/bench-gaddag.dawg";
+    const string xmlFile = iOptions.dataDir + "/bench-game.xml";
+
+    cerr << "Generating " << iOptions.nbWords << " words..." << endl;
+    const SyntheticDic synthetic(iOptions.nbWords, iOptions.seed);
+    synthetic.writeWordList(wordListFile);
+
+    // The dictionaries are always built, since the other benchmarks need them
+    buildDic(wordListFile, dawgFile, false);
+    buildDic(wordListFile, gaddagFile, true);
+    ioRunner.run("compdic_dawg", 1,
+                 boost::bind(buildDic, wordListFile, dawgFile, false));
+    ioRunner.run("compdic_gaddag", 1,
+                 boost::bind(buildDic, wordListFile, gaddagFile, true));
+    ioRunner.run("dic_load", 1, boost::bind(loadDic, gaddagFile));
+
+    // The dictionary loaded last is the one returned by Dictionary::GetDic(),
+    // so the temporary dictionaries of dic_load must not be the last ones
+    const Dictionary dawgDic(dawgFile);
+    const Dictionary dic(gaddagFile);
+
+    // Existing words, and the same words with a modified letter
+    Random random(iOptions.seed);
+    const vector<wstring> &allWords = synthetic.getWords();
+    vector<wstring> words;
+    for (unsigned i = 0; i < kNB_SEARCHED_WORDS; ++i)
+    {
+        wstring word = allWords[random.getInt(allWords.size())];
+        if (i % 2)
+            word[random.getInt(word.size())] = L'A' + random.getInt(26);
+        words.push_back(word);
+    }
+    ioRunner.run("search_word", words.size(),
+                 boost::bind(searchWords, boost::cref(dic), boost::cref(words)));
+
+    vector<Rack> racks;
+    drawRacks(dic, random, kNB_7PL1_RACKS, racks);
+    vector<wstring> rackStrings;
+    BOOST_FOREACH(const Rack &rack, racks)
+    {
+        rackStrings.push_back(rackLetters(rack));
+    }
+    ioRunner.run("search_7pl1", rackStrings.size(),
+                 boost::bind(search7pl1, boost::cref(dic), boost::cref(rackStrings)));
+
+    ioRunner.run("search_regexp", kNB_REGEXPS,
+                 boost::bind(searchRegExps, boost::cref(dic)));
+
+    // Mid-game boards, taken from a reference game
+    boost::scoped_ptr<Game> game(playDuplicate(dic, iOptions.seed));
+    BoardList boards;
+    buildBoards(dic, *game, boards);
+    vector<Rack> boardRacks;
+    drawRacks(dic, random, kNB_BOARD_RACKS, boardRacks);
+    const unsigned nbSearches = boards.size() * boardRacks.size();
+
+    ioRunner.run("board_build_cross", boards.size(),
+                 boost::bind(buildCross, boost::cref(dic), boost::cref(boards)));
+    ioRunner.run("board_search", nbSearches,
+                 boost::bind(searchBoards, boost::cref(dic),
+                             boost::cref(boards), boost::cref(boardRacks)));
+    ioRunner.run("board_search_dawg", nbSearches,
+                 boost::bind(searchBoards, boost::cref(dawgDic),
+                             boost::cref(boards), boost::cref(boardRacks)));
+
+    if (ioRunner.isSelected("xml_read"))
+        XmlWriter::write(*game, xmlFile);
+    ioRunner.run("xml_read", 1,
+                 boost::bind(readXml, boost::cref(dic), xmlFile));
+
+    ioRunner.run("duplicate_game", 1,
+                 boost::bind(benchDuplicate, boost::cref(dic), iOptions.seed));
+}
+
+
+/// Parameters having an influence on the results
+static string getParameters(const Options &iOptions)
+{
+    ostringstream oss;
+    oss << "words=" << iOptions.nbWords
+        << " seed=" << iOptions.seed
+        << " threads=" << iOptions.nbThreads;
+    return oss.str();
+}
+
+
+static void writeResults(ostream &out, const Options &iOptions,
+                         const vector<BenchResult> &iResults)
+{
+    out << "# eliotbench format=" << kFORMAT_VERSION
+        << " version=" << VERSION
+        << " " << getParameters(iOptions) << endl;
+    out << "# name\titerations\tops\tmin_ms\tmedian_ms\tns_per_op" << endl;
+    BOOST_FOREACH(const BenchResult &result, iResults)
+    {
+        out << result.name << '\t' << result.iterations
+            << '\t' << result.nbOps
+            << '\t' << boost::format("%.3f") % result.getMin()
+            << '\t' << boost::format("%.3f") % result.getMedian()
+            << '\t' << boost::format("%.1f") % result.getNsPerOp()
+            << endl;
+    }
+}
+
+
+/**
+ * Read the time per operation of each benchmark of a results file.
+ * A warning is printed if the results were obtained with other parameters
+ * (they are not comparable).
+ */
+static void readBaseline(const string &iFileName, const Options &iOptions,
+                         map<string, double> &oTimes)
+{
+    ifstream in(iFileName.c_str());
+    if (!in.is_open())
+        throw BaseException(FMT1("Cannot open file '%1%'", iFileName));
+
+    string line;
+    while (getline(in, line))
+    {
+        if (line.compare(0, 12, "# eliotbench") == 0)
+        {
+            const string &params = getParameters(iOptions);
+            if (line.find(FMT1("format=%1% ", kFORMAT_VERSION)) == string::npos)
+                throw BaseException(FMT1("Unsupported format of the baseline file: '%1%'", line));
+            if (line.size() < params.size() ||
+                line.compare(line.size() - params.size(), params.size(), params) != 0)
+            {
+                cerr << "Warning: the baseline was obtained with other parameters ("
+                     << line.substr(2) << ")" << endl;
+            }
+        }
+        if (line.empty() || line[0] == '#')
+            continue;
+        istringstream iss(line);
+        string name;
+        unsigned iterations, nbOps;
+        double minTime, median, nsPerOp;
+        if (!(iss >> name >> iterations >> nbOps >> minTime >> median >> nsPerOp))
+            throw BaseException(FMT1("Invalid line in the baseline file: '%1%'", line));
+        oTimes[name] = nsPerOp;
+    }
+}
+
+
+/**
+ * Compare the results with the baseline, and return the number of
+ * benchmarks slower than the baseline by more than the tolerance
+ * (in percent)
+ */
+static unsigned compareResults(const vector<BenchResult> &iResults,
+                               const map<string, double> &iBaseline,
+                               double iTolerance)
+{
+    unsigned nbRegressions = 0;
+    cerr << boost::format("%-20s %14s %14s %9s") % "benchmark"
+        % "baseline ns/op" % "current ns/op" % "change" << endl;
+    BOOST_FOREACH(const BenchResult &result, iResults)
+    {
+        map<string, double>::const_iterator it = iBaseline.find(result.name);
+        if (it == iBaseline.end())
+        {
+            cerr << boost::format("%-20s %14s %14.1f %9s") % result.name
+                % "-" % result.getNsPerOp() % "new" << endl;
+            continue;
+        }
+        const double change = (result.getNsPerOp() / it->second - 1) * 100;
+        const bool regression = change > iTolerance;
+        if (regression)
+            ++nbRegressions;
+        cerr << boost::format("%-20s %14.1f %14.1f %+8.1f%%%s") % result.name
+            % it->second % result.getNsPerOp() % change
+            % (regression ? "  REGRESSION" : "") << endl;
+    }
+    return nbRegressions;
+}
+
+
+static void printUsage(const string &iBinaryName)
+{
+    cout << "Usage: " << iBinaryName << " [options]" << endl
+         << "Options:" << endl
+         << "  -w, --words <num>       Number of words of the synthetic dictionary (default: 100000)" << endl
+         << "  -s, --seed <num>        Seed of the generated data (default: 1)" << endl
+         << "  -n, --iterations <num>  Number of measured runs of each benchmark (default: 5)" << endl
+         << "  -j, --threads <num>     Number of threads used by the searches (default: 1)" << endl
+         << "  -d, --data-dir <dir>    Directory of the generated files (default: .)" << endl
+         << "  -f, --filter <string>   Only run the benchmarks containing this string" << endl
+         << "  -o, --output <file>     Write the results in this file (default: standard output)" << endl
+         << "  -b, --baseline <file>   Compare the results with a previous output" << endl
+         << "  -t, --tolerance <pct>   Accepted slowdown compared to the baseline (default: 10)" << endl
+         << "  -h, --help              Print this help and exit" << endl
+         << endl
+         << "The results are given with the median time of the runs." << endl
+         << "With --baseline, the exit status is 1 if at least one benchmark is slower" << endl
+         << "than the baseline by more than the tolerance." << endl;
+}
+
+
+int main(int argc, char* argv[])
+{
+    static const struct option long_options[] =
+    {
+        {"help", no_argument, NULL, 'h'},
+        {"words", required_argument, NULL, 'w'},
+        {"seed", required_argument, NULL, 's'},
+        {"iterations", required_argument, NULL, 'n'},
+        {"threads", required_argument, NULL, 'j'},
+        {"data-dir", required_argument, NULL, 'd'},
+        {"filter", required_argument, NULL, 'f'},
+        {"output", required_argument, NULL, 'o'},
+        {"baseline", required_argument, NULL, 'b'},
+        {"tolerance", required_argument, NULL, 't'},
+        {0, 0, 0, 0}
+    };
+    static const char short_options[] = "hw:s:n:j:d:f:o:b:t:";
+
+    Options options;
+    options.nbWords = 100000;
+    options.seed = 1;
+    options.iterations = 5;
+    options.nbThreads = 1;
+    options.dataDir = ".";
+    options.tolerance = 10;
+
+    int res;
+    int option_index = 1;
+    while ((res = getopt_long(argc, argv, short_options,
+                              long_options, &option_index)) != -1)
+    {
+        switch (res)
+        {
+            case 'h':
+                printUsage(argv[0]);
+                exit(0);
+            case 'w':
+                options.nbWords = atoi(optarg);
+                break;
+            case 's':
+                options.seed = strtoull(optarg, NULL, 10);
+                break;
+            case 'n':
+                options.iterations = atoi(optarg);
+                break;
+            case 'j':
+                options.nbThreads = atoi(optarg);
+                break;
+            case 'd':
+                options.dataDir = optarg;
+                break;
+            case 'f':
+                options.filter = optarg;
+                break;
+            case 'o':
+                options.output = optarg;
+                break;
+            case 'b':
+                options.baseline = optarg;
+                break;
+            case 't':
+                options.tolerance = atof(optarg);
+                break;
+            default:
+                printUsage(argv[0]);
+                exit(1);
+        }
+    }
+    if (options.nbWords == 0 || options.iterations == 0)
+    {
+        cerr << "The number of words and of iterations must be positive" << endl;
+        exit(1);
+    }
+
+    try
+    {
+        Settings::Instance().setInt("general.search-threads", options.nbThreads);
+
+        BenchRunner runner(options.iterations, options.filter);
+        runBenchmarks(options, runner);
+
+        if (options.output.empty())
+            writeResults(cout, options, runner.getResults());
+        else
+        {
+            ofstream out(options.output.c_str());
+            if (!out.is_open())
+                throw BaseException(FMT1("Cannot open file for writing: '%1%'", options.output));
+            writeResults(out, options, runner.getResults());
+        }
+
+        if (!options.baseline.empty())
+        {
+            map<string, double> baseline;
+            readBaseline(options.baseline, options, baseline);
+            unsigned nbRegressions =
+                compareResults(runner.getResults(), baseline, options.tolerance);
+            if (nbRegressions > 0)
+            {
+                cerr << nbRegressions << " benchmark(s) slower than the baseline" << endl;
+                return 1;
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        cerr << "Error: " << e.what() << endl;
+        return 2;
+    }
+
+    return 0;
+}
+
@@ -0,0 +1,201 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2013 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#include <set>
+#include <fstream>
+#include <boost/format.hpp>
+
+#include "synthetic_dic.h"
+#include "compdic.h"
+#include "dic_exception.h"
+#include "encoding.h"
+#include "random.h"
+
+#define FMT1(s, a1) (boost::format(s) % (a1)).str()
+
+using namespace std;
+
+
+/// Letters of the synthetic language (the french distribution)
+static const struct
+{
+    wchar_t letter;
+    int points;
+    int frequency;
+    bool isVowel;
+    bool isConsonant;
+} kLETTERS[] =
+{
+    { L'A', 1, 9, true, false },
+    { L'B', 3, 2, false, true },
+    { L'C', 3, 2, false, true },
+    { L'D', 2, 3, false, true },
+    { L'E', 1, 15, true, false },
+    { L'F', 4, 2, false, true },
+    { L'G', 2, 2, false, true },
+    { L'H', 4, 2, false, true },
+    { L'I', 1, 8, true, false },
+    { L'J', 8, 1, false, true },
+    { L'K', 10, 1, false, true },
+    { L'L', 1, 5, false, true },
+    { L'M', 2, 3, false, true },
+    { L'N', 1, 6, false, true },
+    { L'O', 1, 6, true, false },
+    { L'P', 3, 2, false, true },
+    { L'Q', 8, 1, false, true },
+    { L'R', 1, 6, false, true },
+    { L'S', 1, 6, false, true },
+    { L'T', 1, 6, false, true },
+    { L'U', 1, 6, true, false },
+    { L'V', 4, 2, false, true },
+    { L'W', 10, 1, false, true },
+    { L'X', 10, 1, false, true },
+    { L'Y', 10, 1, true, true },
+    { L'Z', 10, 1, false, true },
+    { L'?', 0, 2, true, true },
+};
+static const unsigned kNB_LETTERS = sizeof(kLETTERS) / sizeof(kLETTERS[0]);
+
+/// Relative frequencies of the lengths of the stems, starting at 2
+static const unsigned kLENGTHS[] = { 2, 5, 9, 12, 13, 12, 10, 7, 5, 3, 2, 1 };
+static const unsigned kNB_LENGTHS = sizeof(kLENGTHS) / sizeof(kLENGTHS[0]);
+
+/// Endings added to the stems, to get families of words
+static const wchar_t * const kENDINGS[] =
+{
+    L"S", L"E", L"ES", L"ER", L"ERA", L"ERAS", L"EZ", L"ONS",
+    L"ENT", L"AIT", L"ANT", L"IONS", L"ISME", L"ABLE", L"EUR", L"EUSE"
+};
+static const unsigned kNB_ENDINGS = sizeof(kENDINGS) / sizeof(kENDINGS[0]);
+
+
+/// Letters drawn with the frequencies of the bag
+class LetterPool
+{
+public:
+    void add(wchar_t iLetter, unsigned iWeight)
+    {
+        for (unsigned i = 0; i < iWeight; ++i)
+            m_letters.push_back(iLetter);
+    }
+
+    wchar_t draw(Random &ioRandom) const
+    {
+        return m_letters[ioRandom.getInt(m_letters.size())];
+    }
+
+private:
+    vector<wchar_t> m_letters;
+};
+
+
+/// Return an index drawn with the given relative frequencies
+static unsigned drawWeighted(Random &ioRandom, const unsigned *iWeights,
+                             unsigned iNb)
+{
+    unsigned total = 0;
+    for (unsigned i = 0; i < iNb; ++i)
+        total += iWeights[i];
+    unsigned value = ioRandom.getInt(total);
+    for (unsigned i = 0; i < iNb; ++i)
+    {
+        if (value < iWeights[i])
+            return i;
+        value -= iWeights[i];
+    }
+    return iNb - 1;
+}
+
+
+static wstring makeStem(Random &ioRandom, const LetterPool &iVowels,
+                        const LetterPool &iConsonants)
+{
+    const unsigned length = 2 + drawWeighted(ioRandom, kLENGTHS, kNB_LENGTHS);
+    // Alternate vowels and consonants, with some groups of 2 letters
+    bool vowel = ioRandom.getInt(5) < 2;
+    wstring stem;
+    while (stem.size() < length)
+    {
+        stem += vowel ? iVowels.draw(ioRandom) : iConsonants.draw(ioRandom);
+        if (ioRandom.getInt(5) != 0)
+            vowel = !vowel;
+    }
+    return stem;
+}
+
+
+SyntheticDic::SyntheticDic(unsigned iNbWords, uint64_t iSeed)
+{
+    LetterPool vowels;
+    LetterPool consonants;
+    for (unsigned i = 0; i < kNB_LETTERS; ++i)
+    {
+        if (kLETTERS[i].letter == L'?')
+            continue;
+        if (kLETTERS[i].isVowel)
+            vowels.add(kLETTERS[i].letter, kLETTERS[i].frequency);
+        if (kLETTERS[i].isConsonant)
+            consonants.add(kLETTERS[i].letter, kLETTERS[i].frequency);
+    }
+
+    Random random(iSeed);
+    set<wstring> words;
+    while (words.size() < iNbWords)
+    {
+        const wstring &stem = makeStem(random, vowels, consonants);
+        words.insert(stem);
+        // Add a few words of the same family
+        unsigned nbEndings = random.getInt(4);
+        for (unsigned i = 0; i < nbEndings && words.size() < iNbWords; ++i)
+        {
+            const wstring &word = stem + kENDINGS[random.getInt(kNB_ENDINGS)];
+            if (word.size() <= 15)
+                words.insert(word);
+        }
+    }
+    m_words.assign(words.begin(), words.end());
+}
+
+
+void SyntheticDic::writeWordList(const string &iFileName) const
+{
+    ofstream out(iFileName.c_str(), ios::out | ios::binary | ios::trunc);
+    if (!out.is_open())
+        throw DicException(FMT1("Cannot open file for writing: '%1%'", iFileName));
+
+    for (unsigned i = 0; i < m_words.size(); ++i)
+    {
+        out << writeInUTF8(m_words[i], "SyntheticDic::writeWordList") << '\n';
+    }
+    if (!out.good())
+        throw DicException(FMT1("Error while writing file '%1%'", iFileName));
+}
+
+
+void SyntheticDic::AddLetters(CompDic &ioBuilder)
+{
+    for (unsigned i = 0; i < kNB_LETTERS; ++i)
+    {
+        ioBuilder.addLetter(kLETTERS[i].letter, kLETTERS[i].points,
+                            kLETTERS[i].frequency, kLETTERS[i].isVowel,
+                            kLETTERS[i].isConsonant, vector<wstring>());
+    }
+}
+
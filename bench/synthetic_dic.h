@@ -0,0 +1,72 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2013 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#ifndef SYNTHETIC_DIC_H_
+#define SYNTHETIC_DIC_H_
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+class CompDic;
+
+using std::string;
+using std::wstring;
+using std::vector;
+
+
+/**
+ * Synthetic word list, used by the benchmarks instead of a real dictionary
+ * (the real ones cannot be distributed with Eliot).
+ *
+ * The words are made of alternating groups of vowels and consonants,
+ * drawn with the frequencies of the letters in the bag, and many of them
+ * share their stem or their ending, like in a real language. This gives
+ * a dictionary with a realistic structure (number of nodes, branching),
+ * and realistic boards when it is used to play games.
+ *
+ * The list only depends on the number of words and on the seed, so the
+ * results of the benchmarks can be compared between versions of Eliot.
+ */
+class SyntheticDic
+{
+public:
+    /// Generate a list of iNbWords distinct words
+    SyntheticDic(unsigned iNbWords, uint64_t iSeed);
+
+    /// Words of the list, sorted and without duplicates
+    const vector<wstring> & getWords() const { return m_words; }
+
+    /**
+     * Write the word list in the format expected by CompDic
+     * (UTF-8, one word per line).
+     * A DicException is thrown if the file cannot be written.
+     */
+    void writeWordList(const string &iFileName) const;
+
+    /// Declare the letters of the list (and the joker) to the builder
+    static void AddLetters(CompDic &ioBuilder);
+
+private:
+    vector<wstring> m_words;
+};
+
+#endif
+
@@ -22,6 +22,7 @@
 #include "config.h"
 
 #include <set>
+#include <map>
 #include <list>
 #include <algorithm>
 #include <fstream>
@@ -151,6 +152,7 @@ Automaton::Automaton(uint64_t iInitState, int *ptl, uint64_t *PS,
 #endif
 
     finalize(*dfa);
+    minimize();
     DMSG("Final automaton OK");
 #ifdef DEBUG_AUTOMATON
     dump("auto_fin");
@@ -161,29 +163,12 @@ Automaton::Automaton(uint64_t iInitState, int *ptl, uint64_t *PS,
 }
 
 
-Automaton::~Automaton()
-{
-    delete[] m_acceptors;
-    for (unsigned int i = 0; i <= m_nbStates; i++)
-    {
-        delete[] m_transitions[i];
-    }
-    delete[] m_transitions;
-}
-
-
 void Automaton::finalize(const AutomatonHelper &iHelper)
 {
     /* Creation */
     m_nbStates = iHelper.m_states.size();
-    m_acceptors = new bool[m_nbStates + 1];
-    memset(m_acceptors, 0, (m_nbStates + 1) * sizeof(bool));
-    m_transitions = new int*[m_nbStates + 1];
-    for (unsigned int i = 0; i <= m_nbStates; i++)
-    {
-        m_transitions[i] = new int[MAX_TRANSITION_LETTERS];
-        memset(m_transitions[i], 0, MAX_TRANSITION_LETTERS * sizeof(int));
-    }
+    m_acceptors.assign(m_nbStates + 1, false);
+    m_transitions.assign((m_nbStates + 1) * kNB_CODES, 0);
 
     /* Create new id for states */
     list<State *>::const_iterator it;
@@ -205,12 +190,78 @@ void Automaton::finalize(const AutomatonHelper &iHelper)
         if (s->m_accept)
             m_acceptors[i] = true;
 
-        for (int l = 0; l < MAX_TRANSITION_LETTERS; l++)
+        // The DFA only has transitions for the letter codes
+        for (unsigned int l = 0; l < kNB_CODES; l++)
         {
             if (s->m_next[l])
-                m_transitions[i][l] = s->m_next[l]->id_static;
+                m_transitions[i * kNB_CODES + l] = s->m_next[l]->id_static;
+        }
+    }
+}
+
+
+void Automaton::minimize()
+{
+    // Moore algorithm: start with 2 classes of states (accepting or not),
+    // and split the classes until all the states of a class have their
+    // transitions to the same classes. The invalid state 0 is handled like
+    // the other ones, so the states which cannot lead to an accepting state
+    // end up in its class.
+    vector<unsigned int> classes(m_nbStates + 1);
+    for (unsigned int i = 0; i <= m_nbStates; ++i)
+        classes[i] = m_acceptors[i] ? 1 : 0;
+    unsigned int nbClasses = 0;
+    while (true)
+    {
+        map<vector<unsigned int>, unsigned int> signatures;
+        vector<unsigned int> newClasses(m_nbStates + 1);
+        vector<unsigned int> sig(kNB_CODES + 1);
+        for (unsigned int i = 0; i <= m_nbStates; ++i)
+        {
+            sig[0] = classes[i];
+            for (unsigned int l = 0; l < kNB_CODES; ++l)
+                sig[l + 1] = classes[m_transitions[i * kNB_CODES + l]];
+            map<vector<unsigned int>, unsigned int>::const_iterator it =
+                signatures.insert(make_pair(sig, signatures.size())).first;
+            newClasses[i] = it->second;
         }
+        classes.swap(newClasses);
+        if (signatures.size() == nbClasses)
+            break;
+        nbClasses = signatures.size();
+    }
+
+    // Number the remaining states, keeping 0 for the invalid one
+    const unsigned int invalidClass = classes[0];
+    vector<int> newIds(nbClasses, -1);
+    newIds[invalidClass] = 0;
+    unsigned int nbStates = 0;
+    for (unsigned int i = 1; i <= m_nbStates; ++i)
+    {
+        if (newIds[classes[i]] < 0)
+            newIds[classes[i]] = ++nbStates;
     }
+
+    vector<bool> acceptors(nbStates + 1, false);
+    vector<int> transitions((nbStates + 1) * kNB_CODES, 0);
+    for (unsigned int i = 1; i <= m_nbStates; ++i)
+    {
+        const int id = newIds[classes[i]];
+        if (id == 0)
+            continue;
+        acceptors[id] = m_acceptors[i];
+        for (unsigned int l = 0; l < kNB_CODES; ++l)
+        {
+            transitions[id * kNB_CODES + l] =
+                newIds[classes[m_transitions[i * kNB_CODES + l]]];
+        }
+    }
+    DMSG("Minimization: " << m_nbStates << " -> " << nbStates << " states");
+
+    m_init = newIds[classes[m_init]];
+    m_nbStates = nbStates;
+    m_acceptors.swap(acceptors);
+    m_transitions.swap(transitions);
 }
 
 
@@ -230,11 +281,11 @@ void Automaton::dump(const string &iFileName) const
     out << "\n";
     for (unsigned int i = 1; i <= m_nbStates; i++)
     {
-        for (int l = 0; l < MAX_TRANSITION_LETTERS; l++)
+        for (unsigned int l = 0; l < kNB_CODES; l++)
         {
-            if (m_transitions[i][l])
+            if (m_transitions[i * kNB_CODES + l])
             {
-                out << format("\t%1% -> %2%") % i % m_transitions[i][l];
+                out << format("\t%1% -> %2%") % i % m_transitions[i * kNB_CODES + l];
                 out << format(" [label = \"%1%\"];\n") % regexpPrintLetter(l);
             }
         }
@@ -22,8 +22,13 @@
 #ifndef DIC_AUTOMATON_H_
 #define DIC_AUTOMATON_H_
 
+#include <vector>
+#include <stdint.h>
+
 #include "logging.h"
 
+using std::vector;
+
 class AutomatonHelper;
 struct searchRegExpLists;
 
@@ -34,14 +39,13 @@ public:
     /// Constructor
     /**
      * Build a static deterministic finite automaton from
-     * "init_state", "ptl" and "PS" given by the parser
+     * "init_state", "ptl" and "PS" given by the parser.
+     * The automaton is minimized: equivalent states are merged, and the
+     * states from which no accepting state can be reached are removed.
      */
     Automaton(uint64_t init_state, int *ptl, uint64_t *PS,
               const searchRegExpLists &iList);
 
-    /// Destructor
-    ~Automaton();
-
     /**
      * Get the number of states in the automaton.
      * @returns number of states
@@ -66,7 +70,7 @@ public:
      */
     uint64_t getNextState(uint64_t start, char l) const
     {
-        return m_transitions[start][(int)l];
+        return m_transitions[start * kNB_CODES + l];
     }
 
     /**
@@ -75,19 +79,28 @@ public:
     void dump(const string &iFileName) const;
 
 private:
+    /// Number of possible letter codes (size of a row of transitions)
+    static const unsigned int kNB_CODES = 64;
+
     /// Number of states
     unsigned int m_nbStates;
 
     /// ID of the init state
     uint64_t m_init;
 
-    /// Array of booleans, one for each state
-    bool *m_acceptors;
+    /// Acceptor flag of each state (the state 0 is the invalid one)
+    vector<bool> m_acceptors;
 
-    /// Matrix of transitions
-    int **m_transitions;
+    /**
+     * Transitions of all the states, in a single table: the transitions
+     * of the state i for the code c are at the index i * kNB_CODES + c
+     */
+    vector<int> m_transitions;
 
     void finalize(const AutomatonHelper &a);
+
+    /// Merge the equivalent states
+    void minimize();
 };
 
 #endif /* _DIC_AUTOMATON_H_ */
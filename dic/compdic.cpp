@@ -24,9 +24,15 @@
 #include <fstream>
 #include <sstream>
 #include <map>
+#include <set>
+#include <algorithm>
 #include <boost/format.hpp>
 #include <boost/foreach.hpp>
 #include <boost/functional/hash.hpp>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 #include <ctime>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -38,6 +44,7 @@
 #include <cstring>
 
 #include "compdic.h"
+#include "dic.h"
 #include "encoding.h"
 #include "dic_exception.h"
 
@@ -62,6 +69,11 @@
 
 #define MAX_STRING_LENGTH 200
 
+// Character used to represent the GADDAG separator in the word list.
+// It cannot clash with a real letter, since only alphabetical characters
+// and the joker are allowed as letters.
+#define GADDAG_SEPARATOR_CHAR L'+'
+
 // Useful shortcut
 #define fmt(a) boost::format(a)
 
@@ -70,14 +82,17 @@ INIT_LOGGER(dic, CompDic);
 
 
 CompDic::CompDic()
-    : m_currentRec(0), m_maxRec(0), m_loadTime(0), m_buildTime(0)
+    : m_nbThreads(1), m_buildGaddag(false), m_inGaddag(false),
+      m_currentRec(0), m_maxRec(0), m_loadTime(0), m_buildTime(0)
 {
     m_headerInfo.root       = 0;
+    m_headerInfo.gaddagroot = 0;
     m_headerInfo.nwords     = 0;
     m_headerInfo.nodesused  = 1;
     m_headerInfo.edgesused  = 1;
     m_headerInfo.nodessaved = 0;
     m_headerInfo.edgessaved = 0;
+    m_headerInfo.littleEndian = false;
 
     m_stringBuf = new wchar_t[MAX_STRING_LENGTH];
     m_endString = m_stringBuf;
@@ -138,47 +153,299 @@ void CompDic::addLetter(wchar_t chr, int points, int frequency,
 }
 
 
-void CompDic::loadWordList(const string &iFileName, vector<wstring> &oWordList)
+void CompDic::decodeLines(const char *iBuffer, size_t iSize,
+                          vector<wstring> &oWordList)
 {
-    ifstream file(iFileName.c_str(), ios::in | ios::binary);
-    if (!file.is_open())
-        throw DicException((fmt(_("Could not open file '%1%'")) % iFileName).str());
+    // Convert the whole buffer at once: the line separators are
+    // ASCII characters, so the lines can be split after the conversion.
+    // There are at most as many wide characters as bytes.
+    vector<wchar_t> wideBuf(iSize + 1);
+    const unsigned int size = readFromUTF8(&wideBuf.front(), iSize,
+                                           iBuffer, iSize, "loadWordList");
+
+    const wchar_t *pos = &wideBuf.front();
+    const wchar_t *end = pos + size;
+    while (pos < end)
+    {
+        const wchar_t *eol = std::find(pos, end, L'\n');
+        const wchar_t *next = (eol == end) ? end : eol + 1;
+        // Remove potential \r
+        if (eol > pos && *(eol - 1) == L'\r')
+            --eol;
+        // Ignore empty lines
+        if (eol > pos)
+        {
+            // Ensure the word is in upper case
+            oWordList.push_back(wstring(pos, eol));
+            wstring &wstr = oWordList.back();
+            std::transform(wstr.begin(), wstr.end(), wstr.begin(), towupper);
+        }
+        pos = next;
+    }
+
+    sort(oWordList.begin(), oWordList.end());
+}
+
+
+namespace
+{
+    /// Run the given tasks, with the given number of threads
+    template<typename Task>
+    class TaskRunner
+    {
+    public:
+        TaskRunner(vector<Task> &ioTasks) : m_tasks(ioTasks), m_next(0) {}
+
+        void run(unsigned iNbThreads)
+        {
+            boost::thread_group threads;
+            for (unsigned i = 1; i < std::min<size_t>(iNbThreads, m_tasks.size()); ++i)
+            {
+                threads.create_thread(boost::bind(&TaskRunner::runTasks, this));
+            }
+            // The calling thread works too
+            runTasks();
+            threads.join_all();
+        }
+
+    private:
+        vector<Task> &m_tasks;
+        size_t m_next;
+        boost::mutex m_mutex;
 
+        void runTasks()
+        {
+            while (true)
+            {
+                size_t index;
+                {
+                    boost::mutex::scoped_lock lock(m_mutex);
+                    if (m_next >= m_tasks.size())
+                        return;
+                    index = m_next++;
+                }
+                m_tasks[index]();
+            }
+        }
+    };
+
+
+    /// Decode a part of the word list (in a separate thread)
+    struct DecodeTask
+    {
+        typedef void (*DecodeFunc)(const char*, size_t, vector<wstring>&);
+
+        DecodeFunc func;
+        const char *buffer;
+        size_t size;
+        vector<wstring> words;
+        string error;
+
+        void operator()()
+        {
+            try
+            {
+                func(buffer, size, words);
+            }
+            catch (const std::exception &e)
+            {
+                error = e.what();
+            }
+        }
+    };
+}
+
+
+void CompDic::loadWordList(const string &iFileName, vector<wstring> &oWordList)
+{
     // Get the file size
     struct stat stat_buf;
     if (stat(iFileName.c_str(), &stat_buf) < 0)
         throw DicException((fmt(_("Could not open file '%1%'")) % iFileName).str());
-    int dicSize = (unsigned int)stat_buf.st_size;
+    // An empty file cannot be mapped
+    if (stat_buf.st_size == 0)
+        return;
+
+    // Map the file in memory. If it is not possible, read it the usual way.
+    boost::interprocess::mapped_region region;
+    string contents;
+    const char *buffer = NULL;
+    size_t size = 0;
+    try
+    {
+        using namespace boost::interprocess;
+        file_mapping mapping(iFileName.c_str(), read_only);
+        mapped_region(mapping, read_only).swap(region);
+        buffer = static_cast<const char*>(region.get_address());
+        size = region.get_size();
+    }
+    catch (const boost::interprocess::interprocess_exception &e)
+    {
+        LOG_WARN("Cannot map the word list in memory: " << e.what());
+        ifstream file(iFileName.c_str(), ios::in | ios::binary);
+        if (!file.is_open())
+            throw DicException((fmt(_("Could not open file '%1%'")) % iFileName).str());
+        ostringstream oss;
+        oss << file.rdbuf();
+        contents = oss.str();
+        buffer = contents.data();
+        size = contents.size();
+    }
+
+    // If there is a BOM in the file, ignore it
+    if (size >= 3 &&
+        (uint8_t)buffer[0] == 0xEF &&
+        (uint8_t)buffer[1] == 0xBB &&
+        (uint8_t)buffer[2] == 0xBF)
+    {
+        buffer += 3;
+        size -= 3;
+    }
+
+    // Split the buffer in parts ending with a whole line, and decode
+    // them in parallel. Each part is sorted by its thread.
+    const unsigned nbParts = getNbThreads();
+    vector<DecodeTask> tasks;
+    tasks.reserve(nbParts);
+    size_t begin = 0;
+    for (unsigned i = 0; i < nbParts && begin < size; ++i)
+    {
+        size_t end = (i == nbParts - 1) ? size : begin + (size - begin) / (nbParts - i);
+        while (end < size && buffer[end - 1] != '\n')
+            ++end;
+        DecodeTask task;
+        task.func = &CompDic::decodeLines;
+        task.buffer = buffer + begin;
+        task.size = end - begin;
+        tasks.push_back(task);
+        begin = end;
+    }
+
+    TaskRunner<DecodeTask>(tasks).run(nbParts);
+
+    // Merge the sorted parts, to obtain a sorted word list
+    size_t nbWords = 0;
+    BOOST_FOREACH(const DecodeTask &task, tasks)
+    {
+        if (!task.error.empty())
+            throw DicException(task.error);
+        nbWords += task.words.size();
+    }
+    oWordList.reserve(nbWords);
+    BOOST_FOREACH(DecodeTask &task, tasks)
+    {
+        const size_t middle = oWordList.size();
+        oWordList.insert(oWordList.end(), task.words.begin(), task.words.end());
+        vector<wstring>().swap(task.words);
+        std::inplace_merge(oWordList.begin(), oWordList.begin() + middle,
+                           oWordList.end());
+    }
+}
+
+
+unsigned CompDic::getNbThreads() const
+{
+    if (m_nbThreads != 0)
+        return m_nbThreads;
+    return std::max(1u, boost::thread::hardware_concurrency());
+}
 
-    // Reserve some space (heuristic: the average length of words is 11)
-    oWordList.reserve(dicSize / 11);
 
-    string line;
-    while (getline(file, line))
+namespace
+{
+    /// Build the GADDAG strings starting with the given letter
+    struct GaddagTask
     {
-        // If there is a BOM in the file, remove it from the first word
-        if (oWordList.empty() && line.size() >= 3 &&
-            (uint8_t)line[0] == 0xEF &&
-            (uint8_t)line[1] == 0xBB &&
-            (uint8_t)line[2] == 0xBF)
+        const vector<wstring> *wordList;
+        wchar_t firstChar;
+        vector<wstring> strings;
+
+        void operator()()
         {
-            line = line.substr(3);
+            BOOST_FOREACH(const wstring &word, *wordList)
+            {
+                // The strings start with the letter preceding the
+                // separator (or with the last letter of the word)
+                for (unsigned int i = 1; i <= word.size(); ++i)
+                {
+                    if (word[i - 1] != firstChar)
+                        continue;
+                    wstring str(word.rend() - i, word.rend());
+                    if (i < word.size())
+                    {
+                        str += GADDAG_SEPARATOR_CHAR;
+                        str.append(word.begin() + i, word.end());
+                    }
+                    strings.push_back(str);
+                }
+            }
+            sort(strings.begin(), strings.end());
         }
-        // Remove potential \r
-        if (line[line.size() - 1] == '\r')
-            line = line.substr(0, line.size() - 1);
-        // Ignore empty lines
-        if (line == "")
-            continue;
-        // Ensure the word is in upper case
-        wstring wstr = readFromUTF8(line, "loadWordList");
-        std::transform(wstr.begin(), wstr.end(), wstr.begin(), towupper);
+    };
+}
+
+
+void CompDic::buildGaddagList(const vector<wstring> &iWordList,
+                              vector<wstring> &oGaddagList) const
+{
+    const unsigned nbThreads = getNbThreads();
+    if (nbThreads > 1)
+    {
+        // Build the strings starting with each letter in parallel.
+        // Since the letters are sorted, the concatenation of the
+        // results is sorted.
+        set<wchar_t> letters;
+        BOOST_FOREACH(const wstring &word, iWordList)
+        {
+            letters.insert(word.begin(), word.end());
+        }
+        vector<GaddagTask> tasks;
+        BOOST_FOREACH(wchar_t chr, letters)
+        {
+            GaddagTask task;
+            task.wordList = &iWordList;
+            task.firstChar = chr;
+            tasks.push_back(task);
+        }
+        TaskRunner<GaddagTask>(tasks).run(nbThreads);
 
-        oWordList.push_back(wstr);
+        size_t nbStrings = 0;
+        BOOST_FOREACH(const GaddagTask &task, tasks)
+        {
+            nbStrings += task.strings.size();
+        }
+        oGaddagList.reserve(nbStrings);
+        BOOST_FOREACH(GaddagTask &task, tasks)
+        {
+            oGaddagList.insert(oGaddagList.end(),
+                               task.strings.begin(), task.strings.end());
+            vector<wstring>().swap(task.strings);
+        }
+        return;
     }
 
-    // Sort the word list, to perform a better compression
-    sort(oWordList.begin(), oWordList.end());
+    unsigned int nbStrings = 0;
+    BOOST_FOREACH(const wstring &word, iWordList)
+    {
+        nbStrings += word.size();
+    }
+    oGaddagList.reserve(nbStrings);
+
+    BOOST_FOREACH(const wstring &word, iWordList)
+    {
+        // Reversed prefix, followed by the separator and the suffix
+        for (unsigned int i = 1; i < word.size(); ++i)
+        {
+            wstring str(word.rend() - i, word.rend());
+            str += GADDAG_SEPARATOR_CHAR;
+            str.append(word.begin() + i, word.end());
+            oGaddagList.push_back(str);
+        }
+        // Reversed word, without separator
+        oGaddagList.push_back(wstring(word.rbegin(), word.rend()));
+    }
+
+    sort(oGaddagList.begin(), oGaddagList.end());
 }
 
 
@@ -196,9 +463,19 @@ void CompDic::writeNode(DicEdge *ioEdges, unsigned int num, ostream &outFile)
 {
     uint32_t *edgesAsUint = reinterpret_cast<uint32_t*>(ioEdges);
     // Handle endianness
-    for (unsigned int i = 0; i < num; ++i)
+    if (!m_headerInfo.littleEndian)
     {
-        edgesAsUint[i] = htonl(edgesAsUint[i]);
+        for (unsigned int i = 0; i < num; ++i)
+        {
+            edgesAsUint[i] = htonl(edgesAsUint[i]);
+        }
+    }
+    else if (Header::GetHostByteOrder() != Header::kLITTLE_ENDIAN)
+    {
+        for (unsigned int i = 0; i < num; ++i)
+        {
+            edgesAsUint[i] = swapBytes32(edgesAsUint[i]);
+        }
     }
 
     LOG_TRACE(fmt("writing %1% edges") % num);
@@ -261,7 +538,11 @@ unsigned int CompDic::makeNode(ostream &outFile, const Header &iHeader,
         newEdge.last = 0;
         try
         {
-            newEdge.chr = iHeader.getCodeFromChar(*m_endString = *itPosInWord);
+            *m_endString = *itPosInWord;
+            if (m_inGaddag && *m_endString == GADDAG_SEPARATOR_CHAR)
+                newEdge.chr = DIC_GADDAG_SEPARATOR;
+            else
+                newEdge.chr = iHeader.getCodeFromChar(*m_endString);
             ++m_endString;
             ++itPosInWord;
         }
@@ -315,7 +596,14 @@ unsigned int CompDic::makeNode(ostream &outFile, const Header &iHeader,
     // Mark the last edge
     edges.back().last = 1;
 
-    HashMap::const_iterator itMap = m_hashMap.find(edges);
+    return addNode(edges, outFile);
+}
+
+
+unsigned int CompDic::addNode(vector<DicEdge> &ioEdges, ostream &outFile)
+{
+    const unsigned int numedges = ioEdges.size();
+    HashMap::const_iterator itMap = m_hashMap.find(ioEdges);
     if (itMap != m_hashMap.end())
     {
         m_headerInfo.edgessaved += numedges;
@@ -326,23 +614,268 @@ unsigned int CompDic::makeNode(ostream &outFile, const Header &iHeader,
     else
     {
         unsigned int node_pos = m_headerInfo.edgesused;
-        m_hashMap[edges] = m_headerInfo.edgesused;
+        m_hashMap[ioEdges] = m_headerInfo.edgesused;
         m_headerInfo.edgesused += numedges;
         m_headerInfo.nodesused++;
-        writeNode(&edges.front(), numedges, outFile);
+        writeNode(&ioEdges.front(), numedges, outFile);
 
         return node_pos;
     }
 }
 
 
+/**
+ * Part of the DAWG, containing the words starting with the same letter.
+ * The nodes are identified by a local index (0 being the special node
+ * without edges), and the pointers of the edges are local indices.
+ * Since the part is minimized, two nodes have the same index if and only
+ * if they recognize the same suffixes, like in the final DAWG.
+ */
+struct CompDic::SubDawg
+{
+    /// Word list and range of the part in the list
+    const vector<wstring> *wordList;
+    size_t firstWord;
+    size_t lastWord;
+
+    /// Temporary header, to convert the chars into codes
+    const Header *header;
+    bool inGaddag;
+    /// Number of lines before the word list (for the error messages)
+    unsigned int lineOffset;
+
+    /// Edge of the root node leading to the part
+    DicEdge rootEdge;
+
+    /// Edges of all the nodes
+    vector<DicEdge> edges;
+    /// The edges of node i are between nodeStart[i] and nodeStart[i + 1]
+    vector<unsigned int> nodeStart;
+    /**
+     * Number of nodes and edges in the tree of node i, i.e. the number
+     * of nodes and edges makeNode() would find in the hash map when
+     * meeting the node once more
+     */
+    vector<unsigned int> treeNodes;
+    vector<unsigned int> treeEdges;
+    /// Index of node i in the generated file (0 until it is merged)
+    vector<unsigned int> finalPos;
+
+    HashMap hashMap;
+    /// Edges of the nodes being built, for each depth (to avoid allocations)
+    vector<vector<DicEdge> > depthEdges;
+    int maxRec;
+    string error;
+
+    void operator()() { CompDic::buildPart(*this); }
+};
+
+
+unsigned int CompDic::getPartCode(const SubDawg &iPart, size_t iWord,
+                                  unsigned int iDepth)
+{
+    const wchar_t chr = (*iPart.wordList)[iWord][iDepth];
+    try
+    {
+        if (iPart.inGaddag && chr == GADDAG_SEPARATOR_CHAR)
+            return DIC_GADDAG_SEPARATOR;
+        return iPart.header->getCodeFromChar(chr);
+    }
+    catch (DicException &e)
+    {
+        // Same message as in makeNode()
+        ostringstream oss;
+        oss << fmt(_("Error in the word list on line %1%, col %2%: %3%"))
+            % (1 + iPart.lineOffset + iWord)
+            % (1 + iDepth)
+            % e.what() << endl;
+        throw DicException(oss.str());
+    }
+}
+
+
+unsigned int CompDic::makePartNode(SubDawg &ioPart, size_t iFirst,
+                                   size_t iLast, unsigned int iDepth)
+{
+    // Same recursion level as makeNode() for this node
+    if ((int)iDepth + 1 > ioPart.maxRec)
+        ioPart.maxRec = iDepth + 1;
+
+    const vector<wstring> &words = *ioPart.wordList;
+    // The word equal to the prefix (if any) ends on the parent edge
+    while (iFirst < iLast && words[iFirst].size() == iDepth)
+        ++iFirst;
+    if (iFirst == iLast)
+        return 0;
+
+    // One edge for each letter following the prefix, in the same order
+    // as makeNode()
+    vector<DicEdge> &edges = ioPart.depthEdges[iDepth];
+    edges.clear();
+    unsigned int nbTreeNodes = 1;
+    unsigned int nbTreeEdges = 0;
+    size_t i = iFirst;
+    while (i < iLast)
+    {
+        const wchar_t chr = words[i][iDepth];
+        size_t j = i + 1;
+        while (j < iLast && words[j][iDepth] == chr)
+            ++j;
+
+        DicEdge newEdge = {0, 0, 0, 0};
+        newEdge.chr = getPartCode(ioPart, i, iDepth);
+        newEdge.term = (words[i].size() == iDepth + 1);
+        newEdge.ptr = makePartNode(ioPart, i, j, iDepth + 1);
+        edges.push_back(newEdge);
+        nbTreeNodes += ioPart.treeNodes[newEdge.ptr];
+        nbTreeEdges += ioPart.treeEdges[newEdge.ptr];
+        i = j;
+    }
+    edges.back().last = 1;
+    nbTreeEdges += edges.size();
+
+    HashMap::const_iterator itMap = ioPart.hashMap.find(edges);
+    if (itMap != ioPart.hashMap.end())
+        return itMap->second;
+
+    const unsigned int node = ioPart.nodeStart.size() - 1;
+    ioPart.hashMap[edges] = node;
+    ioPart.edges.insert(ioPart.edges.end(), edges.begin(), edges.end());
+    ioPart.nodeStart.push_back(ioPart.edges.size());
+    ioPart.treeNodes.push_back(nbTreeNodes);
+    ioPart.treeEdges.push_back(nbTreeEdges);
+    return node;
+}
+
+
+void CompDic::buildPart(SubDawg &ioPart)
+{
+    try
+    {
+        // Special node 0, without edges
+        ioPart.nodeStart.assign(2, 0);
+        ioPart.treeNodes.assign(1, 0);
+        ioPart.treeEdges.assign(1, 0);
+
+        const vector<wstring> &words = *ioPart.wordList;
+        size_t maxLength = 0;
+        for (size_t i = ioPart.firstWord; i < ioPart.lastWord; ++i)
+            maxLength = std::max(maxLength, words[i].size());
+        ioPart.depthEdges.resize(maxLength + 1);
+        BOOST_FOREACH(vector<DicEdge> &edges, ioPart.depthEdges)
+        {
+            edges.reserve(MAX_EDGES);
+        }
+
+        // Edge of the root node (i.e. first letter of the words)
+        DicEdge rootEdge = {0, 0, 0, 0};
+        rootEdge.chr = getPartCode(ioPart, ioPart.firstWord, 0);
+        rootEdge.term = (words[ioPart.firstWord].size() == 1);
+        rootEdge.ptr = makePartNode(ioPart, ioPart.firstWord,
+                                    ioPart.lastWord, 1);
+        ioPart.rootEdge = rootEdge;
+        ioPart.finalPos.assign(ioPart.treeNodes.size(), 0);
+    }
+    catch (const std::exception &e)
+    {
+        ioPart.error = e.what();
+    }
+    // The temporary data is not needed anymore
+    HashMap().swap(ioPart.hashMap);
+    vector<vector<DicEdge> >().swap(ioPart.depthEdges);
+}
+
+
+unsigned int CompDic::mergeNode(ostream &outFile, SubDawg &ioPart,
+                                unsigned int iLocalNode)
+{
+    if (iLocalNode == 0)
+        return 0;
+
+    // Node already merged: makeNode() would find it in the hash map,
+    // as well as all the nodes of its tree
+    if (ioPart.finalPos[iLocalNode] != 0)
+    {
+        m_headerInfo.nodessaved += ioPart.treeNodes[iLocalNode];
+        m_headerInfo.edgessaved += ioPart.treeEdges[iLocalNode];
+        return ioPart.finalPos[iLocalNode];
+    }
+
+    vector<DicEdge> edges(ioPart.edges.begin() + ioPart.nodeStart[iLocalNode],
+                          ioPart.edges.begin() + ioPart.nodeStart[iLocalNode + 1]);
+    BOOST_FOREACH(DicEdge &edge, edges)
+    {
+        edge.ptr = mergeNode(outFile, ioPart, edge.ptr);
+    }
+
+    const unsigned int pos = addNode(edges, outFile);
+    ioPart.finalPos[iLocalNode] = pos;
+    return pos;
+}
+
+
+unsigned int CompDic::buildParallel(ostream &outFile, const Header &iHeader,
+                                    const vector<wstring> &iWordList)
+{
+    // Split the word list on the first letter
+    vector<SubDawg> parts;
+    size_t first = 0;
+    while (first < iWordList.size())
+    {
+        size_t last = first + 1;
+        while (last < iWordList.size() &&
+               iWordList[last][0] == iWordList[first][0])
+        {
+            ++last;
+        }
+        parts.push_back(SubDawg());
+        SubDawg &part = parts.back();
+        part.wordList = &iWordList;
+        part.firstWord = first;
+        part.lastWord = last;
+        part.header = &iHeader;
+        part.inGaddag = m_inGaddag;
+        part.lineOffset = m_headerInfo.nwords;
+        part.maxRec = 1;
+        first = last;
+    }
+
+    // Build and minimize the parts in parallel
+    TaskRunner<SubDawg>(parts).run(getNbThreads());
+
+    // Merge the parts, in the order of the word list. The nodes are
+    // written in the same order as with makeNode(), so the generated file
+    // is identical.
+    vector<DicEdge> rootEdges;
+    BOOST_FOREACH(SubDawg &part, parts)
+    {
+        // Report the first error of the word list
+        if (!part.error.empty())
+            throw DicException(part.error);
+#ifdef CHECK_RECURSION
+        m_maxRec = std::max(m_maxRec, part.maxRec);
+#endif
+
+        DicEdge edge = part.rootEdge;
+        edge.ptr = mergeNode(outFile, part, edge.ptr);
+        rootEdges.push_back(edge);
+
+        // Free the memory as soon as possible
+        part = SubDawg();
+    }
+    m_headerInfo.nwords += iWordList.size();
+
+    rootEdges.back().last = 1;
+    return addNode(rootEdges, outFile);
+}
+
+
 Header CompDic::generateDawg(const string &iWordListFile,
                              const string &iDawgFile,
                              const string &iDicName)
 {
     m_headerInfo.dicName = wfl(iDicName);
-    // We are not (yet) able to build the GADDAG format
-    m_headerInfo.dawg = true;
+    m_headerInfo.dawg = !m_buildGaddag;
 
     // Open the output file
     ofstream outFile(iDawgFile.c_str(), ios::out | ios::binary | ios::trunc);
@@ -381,9 +914,47 @@ Header CompDic::generateDawg(const string &iWordListFile,
     DicEdge rootNode = {0, 0, 0, 0};
     m_endString = m_stringBuf;
     const clock_t startBuildTime = clock();
-    rootNode.ptr = makeNode(outFile, tempHeader,
-                            firstWord, wordList.end(),
-                            initialPos, m_endString);
+    const bool parallel = getNbThreads() > 1;
+    if (parallel)
+        rootNode.ptr = buildParallel(outFile, tempHeader, wordList);
+    else
+    {
+        rootNode.ptr = makeNode(outFile, tempHeader,
+                                firstWord, wordList.end(),
+                                initialPos, m_endString);
+    }
+
+    if (m_buildGaddag)
+    {
+        vector<wstring> gaddagList;
+        buildGaddagList(wordList, gaddagList);
+
+        // The number of words is not impacted by the GADDAG part
+        const uint32_t nbWords = m_headerInfo.nwords;
+        firstWord = gaddagList.begin();
+        initialPos = firstWord->begin();
+        m_endString = m_stringBuf;
+        m_inGaddag = true;
+        DicEdge gaddagRootNode = {0, 0, 0, 0};
+        if (parallel)
+            gaddagRootNode.ptr = buildParallel(outFile, tempHeader, gaddagList);
+        else
+        {
+            gaddagRootNode.ptr = makeNode(outFile, tempHeader,
+                                          firstWord, gaddagList.end(),
+                                          initialPos, m_endString);
+        }
+        m_inGaddag = false;
+        m_headerInfo.nwords = nbWords;
+
+        // The GADDAG root is written as a normal node, just before the
+        // DAWG root (which must stay the last edge of the file)
+        m_headerInfo.gaddagroot = m_headerInfo.edgesused;
+        m_headerInfo.edgesused++;
+        m_headerInfo.nodesused++;
+        writeNode(&gaddagRootNode, 1, outFile);
+    }
+
     // Reuse the temporary variable
     writeNode(&rootNode, 1, outFile);
     const clock_t endBuildTime = clock();
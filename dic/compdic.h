@@ -69,6 +69,32 @@ public:
 
     unsigned getLettersCount() const { return m_headerInfo.letters.size(); }
 
+    /**
+     * Specify whether a GADDAG part must be generated in addition
+     * to the DAWG (default: false). A dictionary with a GADDAG part
+     * allows a faster search of the moves on the board, but is bigger.
+     */
+    void setBuildGaddag(bool iBuildGaddag) { m_buildGaddag = iBuildGaddag; }
+
+    /**
+     * Specify the byte order of the edges in the generated file
+     * (default: big-endian, readable by all the versions of Eliot).
+     * When the byte order is the one of the machine using the dictionary,
+     * the dictionary file can be memory-mapped without any conversion.
+     */
+    void setByteOrder(Header::ByteOrder iOrder)
+    {
+        m_headerInfo.littleEndian = (iOrder == Header::kLITTLE_ENDIAN);
+    }
+
+    /**
+     * Specify the number of threads used to load the word list and to
+     * build the dictionary (default: 1, i.e. everything is done in the
+     * calling thread). 0 means one thread per core.
+     * The generated file does not depend on the number of threads.
+     */
+    void setNbThreads(unsigned iNbThreads) { m_nbThreads = iNbThreads; }
+
     /**
      * Generate the dictionary. You must have called addLetter() before
      * (once for each letter of the word list, and possible once for the
@@ -90,8 +116,19 @@ public:
 #endif
 
 private:
+    struct SubDawg;
+
     DictHeaderInfo m_headerInfo;
 
+    /// Number of threads (0 for one thread per core)
+    unsigned m_nbThreads;
+
+    /// True to generate the GADDAG part of the dictionary
+    bool m_buildGaddag;
+
+    /// True while the GADDAG part is being generated
+    bool m_inGaddag;
+
     HashMap m_hashMap;
 
     /// Space for the current string
@@ -117,6 +154,28 @@ private:
      */
     void loadWordList(const string &iFileName, vector<wstring> &oWordList);
 
+    /**
+     * Decode the UTF-8 lines of the given buffer, and append the
+     * corresponding words to oWordList (sorted)
+     * @param iBuffer: buffer to decode (it must end with a whole line)
+     * @param iSize: size of the buffer
+     * @param oWordList: sorted words of the buffer
+     */
+    static void decodeLines(const char *iBuffer, size_t iSize,
+                            vector<wstring> &oWordList);
+
+    /// Return the actual number of threads to use
+    unsigned getNbThreads() const;
+
+    /**
+     * Build the (sorted) list of strings stored in the GADDAG part of
+     * the dictionary, corresponding to the given word list.
+     * @param iWordList: Word list
+     * @param oGaddagList: GADDAG strings
+     */
+    void buildGaddagList(const vector<wstring> &iWordList,
+                         vector<wstring> &oGaddagList) const;
+
     Header writeHeader(ostream &outFile) const;
 
     /**
@@ -149,6 +208,50 @@ private:
                           wstring::const_iterator &itPosInWord,
                           const wchar_t *iPrefix);
 
+    /**
+     * Write the given node, unless an identical node was already written.
+     * @param ioEdges: edges of the node (modified when written)
+     * @param outFile: stream where to write the node
+     * @return the index of the node
+     */
+    unsigned int addNode(vector<DicEdge> &ioEdges, ostream &outFile);
+
+    /**
+     * Build the same DAWG as makeNode() (and write the same nodes, in the
+     * same order), using several threads. The word list is split on the
+     * first letter of the words: each part is built and minimized
+     * independently, then the parts are merged sequentially,
+     * using m_hashMap to share the common nodes.
+     * @param outfile: stream where to write the nodes
+     * @param iHeader: temporary header (see makeNode())
+     * @param iWordList: sorted word list
+     * @return the index of the root node of the DAWG
+     */
+    unsigned int buildParallel(ostream &outFile, const Header &iHeader,
+                               const vector<wstring> &iWordList);
+
+    /// Build and minimize the given part of the DAWG
+    static void buildPart(SubDawg &ioPart);
+
+    /**
+     * Equivalent of makeNode() for a part of the DAWG: return the local
+     * index of the node recognizing the suffixes of the words between
+     * iFirst and iLast (excluded), after their iDepth first letters
+     */
+    static unsigned int makePartNode(SubDawg &ioPart, size_t iFirst,
+                                     size_t iLast, unsigned int iDepth);
+
+    /// Return the code of a letter of the word list
+    static unsigned int getPartCode(const SubDawg &iPart, size_t iWord,
+                                    unsigned int iDepth);
+
+    /**
+     * Merge the given node of a part (and its children), and
+     * return its index in the generated file
+     */
+    unsigned int mergeNode(ostream &outFile, SubDawg &ioPart,
+                           unsigned int iLocalNode);
+
 };
 
 #endif /* DIC_COMPDIC_H_ */
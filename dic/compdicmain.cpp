@@ -130,6 +130,12 @@ void printUsage(const string &iBinaryName)
          << _("                          The words must be in alphabetical order, without duplicates") << endl
          << _("  -o, --output <string>   Path to the generated compressed dictionary file") << endl
          << _("Other options:") << endl
+         << _("  -g, --gaddag            Also generate the GADDAG part of the dictionary") << endl
+         << _("                          (faster search of moves, but bigger file)") << endl
+         << _("  -n, --native            Store the edges in the byte order of this machine") << endl
+         << _("                          (faster loading on machines with the same byte order)") << endl
+         << _("  -j, --threads <num>     Number of threads used to build the dictionary") << endl
+         << _("                          (default: 1, 0 means one thread per core)") << endl
          << _("  -h, --help              Print this help and exit") << endl
          << _("Example:") << endl
          << "  " << iBinaryName << _(" -d 'ODS 5.0' -l letters.txt -i ods5.txt -o ods5.dawg") << endl
@@ -194,9 +200,12 @@ int main(int argc, char* argv[])
         {"letters", required_argument, NULL, 'l'},
         {"input", required_argument, NULL, 'i'},
         {"output", required_argument, NULL, 'o'},
+        {"gaddag", no_argument, NULL, 'g'},
+        {"native", no_argument, NULL, 'n'},
+        {"threads", required_argument, NULL, 'j'},
         {0, 0, 0, 0}
     };
-    static const char short_options[] = "hd:l:i:o:";
+    static const char short_options[] = "hd:l:i:o:gnj:";
 
     bool found_d = false;
     bool found_l = false;
@@ -235,6 +244,15 @@ int main(int argc, char* argv[])
                     found_o = true;
                     outFileName = optarg;
                     break;
+                case 'g':
+                    builder.setBuildGaddag(true);
+                    break;
+                case 'n':
+                    builder.setByteOrder(Header::GetHostByteOrder());
+                    break;
+                case 'j':
+                    builder.setNbThreads(atoi(optarg));
+                    break;
             }
         }
 
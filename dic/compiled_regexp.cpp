@@ -0,0 +1,163 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2013 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#include "compiled_regexp.h"
+#include "dic.h"
+#include "header.h"
+#include "dic_exception.h"
+#include "encoding.h"
+#include "regexp.h"
+#include "automaton.h"
+#include "grammar.h"
+
+using namespace std;
+
+
+INIT_LOGGER(dic, CompiledRegexp);
+INIT_LOGGER(dic, RegexpCache);
+
+
+/**
+ * Initialize the lists of letters with pre-defined lists
+ * 0: all tiles
+ * 1: vowels
+ * 2: consonants
+ * 3: user defined 1
+ * 4: user defined 2
+ * x: lists used during parsing
+ */
+static void initLetterLists(const Dictionary &iDic,
+                            searchRegExpLists &iList)
+{
+    // Prepare the space for 5 items
+    iList.symbl.assign(5, 0);
+    iList.letters.assign(5, vector<bool>(DIC_LETTERS + 1, false));
+
+    iList.symbl[0] = RE_ALL_MATCH; // All letters
+    iList.symbl[1] = RE_VOWL_MATCH; // Vowels
+    iList.symbl[2] = RE_CONS_MATCH; // Consonants
+    iList.letters[0][0] = false;
+    iList.letters[1][0] = false;
+    iList.letters[2][0] = false;
+    const wstring &allLetters = iDic.getHeader().getLetters();
+    for (size_t i = 1; i <= allLetters.size(); ++i)
+    {
+        iList.letters[0][i] = true;
+        iList.letters[1][i] = iDic.getHeader().isVowel(i);
+        iList.letters[2][i] = iDic.getHeader().isConsonant(i);
+    }
+
+    iList.symbl[3] = RE_USR1_MATCH; // User defined list 1
+    iList.symbl[4] = RE_USR2_MATCH; // User defined list 2
+}
+
+
+CompiledRegexp::CompiledRegexp(const Dictionary &iDic, const wstring &iRegexp)
+    : m_dic(iDic), m_regexp(iRegexp), m_automaton(NULL)
+{
+    // Parsing
+    Node *root = NULL;
+    searchRegExpLists llist;
+    // Initialize the lists of letters
+    initLetterLists(iDic, llist);
+    bool parsingOk = parseRegexp(iDic, (iRegexp + L"#").c_str(), &root, llist);
+
+    if (!parsingOk)
+    {
+        delete root;
+        throw InvalidRegexpException(lfw(iRegexp));
+    }
+
+    int ptl[REGEXP_MAX+1];
+    uint64_t PS[REGEXP_MAX+1];
+
+    for (int i = 0; i < REGEXP_MAX; i++)
+    {
+        PS[i] = 0;
+        ptl[i] = 0;
+    }
+
+    int n = 1;
+    int p = 1;
+    root->traverse(p, n, ptl);
+    PS [0] = p - 1;
+    ptl[0] = p - 1;
+
+    root->nextPos(PS);
+
+    m_automaton = new Automaton(root->getFirstPos(), ptl, PS, llist);
+    delete root;
+    LOG_DEBUG("Compiled regexp " << lfw(iRegexp) << ": "
+              << m_automaton->getNbStates() << " states");
+}
+
+
+CompiledRegexp::~CompiledRegexp()
+{
+    delete m_automaton;
+}
+
+
+RegexpCache::RegexpCache(unsigned int iMaxSize)
+    : m_maxSize(iMaxSize), m_dic(NULL)
+{
+}
+
+
+RegexpCache::CompiledRegexpPtr RegexpCache::get(const Dictionary &iDic,
+                                                const wstring &iRegexp)
+{
+    if (m_dic != &iDic)
+    {
+        clear();
+        m_dic = &iDic;
+    }
+
+    map<wstring, list<CompiledRegexpPtr>::iterator>::iterator it =
+        m_index.find(iRegexp);
+    if (it != m_index.end())
+    {
+        // Move the regexp at the beginning of the list
+        m_lru.splice(m_lru.begin(), m_lru, it->second);
+        return m_lru.front();
+    }
+
+    // Compile it (this may throw)
+    CompiledRegexpPtr compiled(new CompiledRegexp(iDic, iRegexp));
+    m_lru.push_front(compiled);
+    m_index[iRegexp] = m_lru.begin();
+
+    // Forget the least recently used one, if needed
+    if (m_lru.size() > m_maxSize)
+    {
+        m_index.erase(m_lru.back()->getRegexp());
+        m_lru.pop_back();
+    }
+    return compiled;
+}
+
+
+void RegexpCache::clear()
+{
+    m_lru.clear();
+    m_index.clear();
+    m_dic = NULL;
+}
+
@@ -0,0 +1,108 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2013 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#ifndef COMPILED_REGEXP_H_
+#define COMPILED_REGEXP_H_
+
+#include <string>
+#include <list>
+#include <map>
+#include <boost/shared_ptr.hpp>
+
+#include "logging.h"
+
+class Dictionary;
+class Automaton;
+
+using std::wstring;
+using std::list;
+using std::map;
+
+
+/**
+ * Regular expression parsed and compiled into a (minimized) automaton,
+ * ready to be used with Dictionary::searchRegExp().
+ * The automaton depends on the letters of the dictionary, so the object
+ * can only be used with the dictionary given to the constructor.
+ */
+class CompiledRegexp
+{
+    DEFINE_LOGGER();
+public:
+    /**
+     * Parse and compile the regular expression
+     * @throw InvalidRegexpException When the regular expression cannot be parsed
+     */
+    CompiledRegexp(const Dictionary &iDic, const wstring &iRegexp);
+    ~CompiledRegexp();
+
+    const Dictionary & getDic() const { return m_dic; }
+    const wstring & getRegexp() const { return m_regexp; }
+    const Automaton & getAutomaton() const { return *m_automaton; }
+
+private:
+    // Prevent from copying
+    CompiledRegexp(const CompiledRegexp&);
+    CompiledRegexp &operator=(const CompiledRegexp&);
+
+    const Dictionary &m_dic;
+    wstring m_regexp;
+    Automaton *m_automaton;
+};
+
+
+/**
+ * Cache of the most recently used regular expressions, to avoid compiling
+ * them again when the same search is done several times (for instance when
+ * refreshing the results, or when changing only the length limits).
+ *
+ * The cache is not thread-safe: each user should have its own one.
+ */
+class RegexpCache
+{
+    DEFINE_LOGGER();
+public:
+    typedef boost::shared_ptr<const CompiledRegexp> CompiledRegexpPtr;
+
+    /// Keep at most iMaxSize regular expressions
+    explicit RegexpCache(unsigned int iMaxSize = 16);
+
+    /**
+     * Return the compiled regular expression, compiling it only if it
+     * is not already in the cache. The cache is emptied when the
+     * dictionary changes.
+     * @throw InvalidRegexpException When the regular expression cannot be parsed
+     */
+    CompiledRegexpPtr get(const Dictionary &iDic, const wstring &iRegexp);
+
+    /// Empty the cache
+    void clear();
+
+private:
+    unsigned int m_maxSize;
+    const Dictionary *m_dic;
+
+    /// Compiled regular expressions, the most recently used first
+    list<CompiledRegexpPtr> m_lru;
+    /// Position of each regular expression in m_lru
+    map<wstring, list<CompiledRegexpPtr>::iterator> m_index;
+};
+
+#endif
@@ -27,6 +27,8 @@
 #include <cerrno>
 #include <cctype>
 #include <boost/foreach.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 
 // For ntohl & Co.
 #ifdef WIN32
@@ -55,7 +57,8 @@ const Dictionary *Dictionary::m_dic = NULL;
 
 
 Dictionary::Dictionary(const string &iPath)
-    : m_dawg(NULL), m_hasDisplay(false)
+    : m_dawg(NULL), m_dawgData(NULL), m_mappedRegion(NULL),
+    m_displayFirstChar(0), m_hasDisplay(false)
 {
     ifstream file(iPath.c_str(), ios::in | ios::binary);
 
@@ -64,20 +67,23 @@ Dictionary::Dictionary(const string &iPath)
 
     // XXX: we should protect these allocations with auto_ptr
     m_header = new Header(file);
-    m_dawg = new uint32_t[m_header->getNbEdgesUsed() + 1];
 
-    streamsize toRead = (m_header->getNbEdgesUsed() + 1) * sizeof(uint32_t);
-    file.read((char*)m_dawg, toRead);
-    if (file.gcount() != toRead)
+    // If the edges are stored in the byte order of the machine, they can be
+    // used directly from the file. Otherwise, they have to be converted.
+    if (m_header->getByteOrder() != Header::GetHostByteOrder() ||
+        !mapEdges(iPath, file.tellg()))
     {
-        delete[] m_dawg;
-        delete m_header;
-        throw DicException("Problem reading dictionary arcs");
+        try
+        {
+            loadEdges(file);
+        }
+        catch (...)
+        {
+            delete m_header;
+            throw;
+        }
     }
 
-    // Handle endianness
-    convertDataToArch();
-
     initializeTiles();
 
     // Concatenate the uppercase and lowercase letters
@@ -86,29 +92,7 @@ Dictionary::Dictionary(const string &iPath)
     // Same for the input characters
     m_allInputChars = m_header->getInputChars() + toLower(m_header->getInputChars());
 
-    // Build the cache for the convertToDisplay() and convertFromInput()
-    // methods.
-    map<wchar_t, vector<wstring> >::const_iterator it;
-    for (it = m_header->getDisplayInputData().begin();
-         it != m_header->getDisplayInputData().end(); ++it)
-    {
-        // Save both the upper case and lower case versions
-        BOOST_FOREACH(wstring str, it->second)
-        {
-            // Make sure the string is in uppercase
-            str = toUpper(str);
-            // Make a lowercase copy
-            wstring lower = toLower(str);
-            // Fill the cache
-            m_displayInputCache[towupper(it->first)].push_back(str);
-            m_displayInputCache[towlower(it->first)].push_back(lower);
-        }
-
-        // Update the m_hasDisplay flag
-        if (!m_hasDisplay && it->second[0] != wstring(1, it->first))
-            m_hasDisplay = true;
-    }
-
+    initializeConversions();
 
     m_dic = this;
 }
@@ -116,16 +100,81 @@ Dictionary::Dictionary(const string &iPath)
 
 Dictionary::~Dictionary()
 {
-    delete[] m_dawg;
+    delete m_mappedRegion;
+    delete[] m_dawgData;
     delete m_header;
 }
 
 
+bool Dictionary::mapEdges(const string &iPath, streamoff iOffset)
+{
+    const size_t size = (m_header->getNbEdgesUsed() + 1) * sizeof(uint32_t);
+    // The edges must be properly aligned
+    if (iOffset < 0 || iOffset % sizeof(uint32_t) != 0)
+        return false;
+
+    try
+    {
+        using namespace boost::interprocess;
+        // The file mapping can be destroyed once the region is mapped
+        file_mapping mapping(iPath.c_str(), read_only);
+        mapped_region *region = new mapped_region(mapping, read_only);
+        if (region->get_size() < (size_t)iOffset + size)
+        {
+            // Truncated file: loadEdges() will report the problem
+            delete region;
+            return false;
+        }
+        m_mappedRegion = region;
+        m_dawg = reinterpret_cast<const uint32_t*>(
+                static_cast<const char*>(region->get_address()) + iOffset);
+    }
+    catch (const boost::interprocess::interprocess_exception &e)
+    {
+        LOG_WARN("Cannot map the dictionary in memory: " << e.what());
+        return false;
+    }
+    LOG_INFO("Dictionary " << iPath << " mapped in memory");
+    return true;
+}
+
+
+void Dictionary::loadEdges(istream &iStream)
+{
+    m_dawgData = new uint32_t[m_header->getNbEdgesUsed() + 1];
+
+    streamsize toRead = (m_header->getNbEdgesUsed() + 1) * sizeof(uint32_t);
+    iStream.read((char*)m_dawgData, toRead);
+    if (iStream.gcount() != toRead)
+    {
+        delete[] m_dawgData;
+        m_dawgData = NULL;
+        throw DicException("Problem reading dictionary arcs");
+    }
+
+    // Handle endianness
+    convertDataToArch();
+
+    m_dawg = m_dawgData;
+}
+
+
 void Dictionary::convertDataToArch()
 {
-    for (unsigned int i = 0; i < (m_header->getNbEdgesUsed() + 1); i++)
+    const unsigned int nbEdges = m_header->getNbEdgesUsed() + 1;
+    if (m_header->getByteOrder() == Header::kBIG_ENDIAN)
+    {
+        for (unsigned int i = 0; i < nbEdges; i++)
+        {
+            m_dawgData[i] = ntohl(m_dawgData[i]);
+        }
+    }
+    else if (Header::GetHostByteOrder() != Header::kLITTLE_ENDIAN)
     {
-        m_dawg[i] = ntohl(m_dawg[i]);
+        for (unsigned int i = 0; i < nbEdges; i++)
+        {
+            m_dawgData[i] = swapBytes32(m_dawgData[i]);
+        }
     }
 }
 
@@ -162,6 +211,86 @@ bool Dictionary::validateInputChars(const wistring &iLetters,
 }
 
 
+void Dictionary::initializeConversions()
+{
+    m_inputTrie.assign(1, InputNode());
+    m_inputTrie[0].letter = 0;
+
+    // Display strings and input strings of each char, for both the
+    // upper case and lower case versions
+    map<wchar_t, wdstring> display;
+    map<wchar_t, vector<wstring> >::const_iterator it;
+    for (it = m_header->getDisplayInputData().begin();
+         it != m_header->getDisplayInputData().end(); ++it)
+    {
+        const wchar_t upper = towupper(it->first);
+        const wchar_t lower = towlower(it->first);
+        BOOST_FOREACH(wstring str, it->second)
+        {
+            // Make sure the string is in uppercase
+            str = toUpper(str);
+            // The first string is the display string
+            if (display.find(upper) == display.end())
+            {
+                display[upper] = str;
+                display[lower] = toLower(str);
+            }
+            addInputString(str, upper);
+            addInputString(toLower(str), lower);
+        }
+
+        // Update the m_hasDisplay flag
+        if (!m_hasDisplay && it->second[0] != wstring(1, it->first))
+            m_hasDisplay = true;
+    }
+
+    if (!m_hasDisplay)
+        return;
+
+    // Build the display table, covering all the chars of the map
+    m_displayFirstChar = display.begin()->first;
+    m_displayTable.assign(display.rbegin()->first - m_displayFirstChar + 1,
+                          wdstring());
+    map<wchar_t, wdstring>::const_iterator itDisp;
+    for (itDisp = display.begin(); itDisp != display.end(); ++itDisp)
+    {
+        // Strings identical to the char are left empty
+        if (itDisp->second != wdstring(1, itDisp->first))
+            m_displayTable[itDisp->first - m_displayFirstChar] = itDisp->second;
+    }
+}
+
+
+void Dictionary::addInputString(const wistring &iInput, wchar_t iLetter)
+{
+    unsigned int node = 0;
+    BOOST_FOREACH(wchar_t chr, iInput)
+    {
+        unsigned int next = 0;
+        typedef pair<wchar_t, unsigned int> ChildType;
+        BOOST_FOREACH(const ChildType &child, m_inputTrie[node].children)
+        {
+            if (child.first == chr)
+            {
+                next = child.second;
+                break;
+            }
+        }
+        if (next == 0)
+        {
+            next = m_inputTrie.size();
+            m_inputTrie[node].children.push_back(make_pair(chr, next));
+            m_inputTrie.push_back(InputNode());
+            m_inputTrie.back().letter = 0;
+        }
+        node = next;
+    }
+    // In case of conflict, keep the first letter
+    if (m_inputTrie[node].letter == 0)
+        m_inputTrie[node].letter = iLetter;
+}
+
+
 wdstring Dictionary::convertToDisplay(const wstring &iWord) const
 {
     // Optimization for dictionaries without display nor input chars,
@@ -169,19 +298,15 @@ wdstring Dictionary::convertToDisplay(const wstring &iWord) const
     if (!m_hasDisplay)
         return iWord;
 
-    wdstring dispStr = iWord;
-    map<wchar_t, vector<wstring> >::const_iterator it;
-    for (it = m_displayInputCache.begin();
-         it != m_displayInputCache.end(); ++it)
+    wdstring dispStr;
+    dispStr.reserve(2 * iWord.size());
+    BOOST_FOREACH(wchar_t chr, iWord)
     {
-        const wstring &disp = it->second[0];
-        string::size_type pos = 0;
-        while (pos < dispStr.size() &&
-               (pos = dispStr.find(it->first, pos)) != string::npos)
-        {
-            dispStr.replace(pos, 1, disp);
-            pos += disp.size();
-        }
+        const unsigned int idx = chr - m_displayFirstChar;
+        if (idx < m_displayTable.size() && !m_displayTable[idx].empty())
+            dispStr += m_displayTable[idx];
+        else
+            dispStr += chr;
     }
     return dispStr;
 }
@@ -191,24 +316,53 @@ wstring Dictionary::convertFromInput(const wistring &iWord) const
 {
     // Optimization for dictionaries without display nor input chars,
     // which is the case in most languages.
-    if (m_displayInputCache.empty())
+    if (m_inputTrie[0].children.empty())
         return iWord;
 
-    wstring str = iWord;
-    map<wchar_t, vector<wstring> >::const_iterator it;
-    for (it = m_displayInputCache.begin();
-         it != m_displayInputCache.end(); ++it)
+    // At each position, replace the longest input string found
+    // by its internal char
+    wstring str;
+    str.reserve(iWord.size());
+    const unsigned int size = iWord.size();
+    unsigned int pos = 0;
+    while (pos < size)
     {
-        BOOST_FOREACH(const wstring &input, it->second)
+        wchar_t letter = 0;
+        unsigned int matchLen = 0;
+        unsigned int node = 0;
+        for (unsigned int i = pos; i < size; ++i)
         {
-            string::size_type pos = 0;
-            while (pos < str.size() &&
-                   (pos = str.find(input, pos)) != string::npos)
+            const vector<pair<wchar_t, unsigned int> > &children =
+                m_inputTrie[node].children;
+            unsigned int next = 0;
+            for (unsigned int c = 0; c < children.size(); ++c)
+            {
+                if (children[c].first == iWord[i])
+                {
+                    next = children[c].second;
+                    break;
+                }
+            }
+            if (next == 0)
+                break;
+            node = next;
+            if (m_inputTrie[node].letter != 0)
             {
-                str.replace(pos, input.size(), wstring(1, it->first));
-                pos += input.size();
+                letter = m_inputTrie[node].letter;
+                matchLen = i - pos + 1;
             }
         }
+
+        if (matchLen)
+        {
+            str += letter;
+            pos += matchLen;
+        }
+        else
+        {
+            str += iWord[pos];
+            ++pos;
+        }
     }
     return str;
 }
@@ -234,6 +388,12 @@ dic_elt_t Dictionary::getRoot() const
 }
 
 
+dic_elt_t Dictionary::getGaddagRoot() const
+{
+    return m_header->getGaddagRoot();
+}
+
+
 dic_code_t Dictionary::getCode(const dic_elt_t &e) const
 {
     return reinterpret_cast<const DicEdge*>(m_dawg + e)->chr;
@@ -23,6 +23,7 @@
 #define DIC_H_
 
 #include <stdint.h>
+#include <iosfwd>
 #include <string>
 #include <vector>
 #include <map>
@@ -30,6 +31,14 @@
 #include "tile.h"
 #include "logging.h"
 
+namespace boost
+{
+    namespace interprocess
+    {
+        class mapped_region;
+    }
+}
+
 using namespace std;
 
 
@@ -38,12 +47,18 @@ using namespace std;
  */
 #define DIC_WORD_MAX 16
 
+/**
+ * Code of the separator used in the GADDAG part of a dictionary.
+ * No letter can have this code (letter codes start at 1).
+ */
+#define DIC_GADDAG_SEPARATOR 0
+
 class Header;
+class CompiledRegexp;
 typedef unsigned int dic_elt_t;
 typedef unsigned char dic_code_t;
 struct params_cross_t;
 struct params_7plus1_t;
-struct params_regexp_t;
 struct DicEdge;
 
 /**
@@ -163,6 +178,17 @@ public:
      */
     dic_elt_t getRoot() const;
 
+    /**
+     * Returns the root of the GADDAG part of the dictionary.
+     * Only valid if the dictionary is of type Header::kGADDAG.
+     * In the GADDAG, each word x1...xn is stored n times:
+     * as the reversed prefix xi...x1, followed by the separator
+     * (code DIC_GADDAG_SEPARATOR) and the suffix x(i+1)...xn, for 1 <= i < n,
+     * and as the reversed word xn...x1 (without separator).
+     * @returns GADDAG root element
+     */
+    dic_elt_t getGaddagRoot() const;
+
     /**
      * Returns the next available neighbor (see isLast())
      * @returns next dictionary element at the same depth
@@ -249,6 +275,21 @@ public:
                     map<unsigned int, vector<wdstring> > &oWordList,
                     bool joker) const;
 
+    /**
+     * Same as the previous search7pl1(), for several racks at once.
+     * All the racks are searched during the same walk of the dictionary,
+     * which is much faster than searching them one by one when there are
+     * many racks.
+     *
+     * @param iRacks: letters of each rack
+     * @param oWordLists: results for each rack (the vector is resized to
+     *      the number of racks)
+     * @param joker: true if the search must be performed when a joker is in the rack
+     */
+    void search7pl1(const vector<wstring> &iRacks,
+                    vector<map<unsigned int, vector<wdstring> > > &oWordLists,
+                    bool joker) const;
+
     /**
      * Search for words matching a regular expression
      * @param iRegexp: regular expression
@@ -266,13 +307,37 @@ public:
                       unsigned int iMaxLength,
                       unsigned int iMaxResults = 0) const;
 
+    /**
+     * Same as the previous searchRegExp(), with an already compiled
+     * regular expression (see RegexpCache to reuse them).
+     * The regular expression must have been compiled for this dictionary.
+     * See also RegexpSearch, to get the results progressively.
+     */
+    bool searchRegExp(const CompiledRegexp &iRegexp,
+                      vector<wdstring> &oWordList,
+                      unsigned int iMinLength,
+                      unsigned int iMaxLength,
+                      unsigned int iMaxResults = 0) const;
+
 private:
     // Prevent from copying the dictionary!
     Dictionary &operator=(const Dictionary&);
     Dictionary(const Dictionary&);
 
     Header *m_header;
-    uint32_t *m_dawg;
+
+    /// Edges of the dictionary (either in m_dawgData or in m_mappedRegion)
+    const uint32_t *m_dawg;
+
+    /// Edges loaded in memory (NULL if the file is memory-mapped)
+    uint32_t *m_dawgData;
+
+    /**
+     * Memory-mapped dictionary file (NULL if the edges are loaded in memory).
+     * The file is mapped read-only, so its pages are shared between all the
+     * processes using the same dictionary.
+     */
+    boost::interprocess::mapped_region *m_mappedRegion;
 
     /**
      * Letters of the dictionary, both in uppercase and lowercase
@@ -290,29 +355,63 @@ private:
     vector<Tile> m_tilesVect;
 
     /**
-     * Associate to some internal chars (both the lower case and
-     * upper case versions) all the corresponding input strings.
-     * The first one is always the display string.
-     *
-     * Note: only the chars which have more than 1 input string,
-     * or which have a display string different from the internal char,
-     * are present in the map.
+     * Display string of some internal chars (both the lower case and
+     * upper case versions), used by convertToDisplay().
+     * The table is indexed by the char minus m_displayFirstChar.
+     * An empty string means that the char is displayed as is.
      */
-    map<wchar_t, vector<wstring> > m_displayInputCache;
+    vector<wdstring> m_displayTable;
+    wchar_t m_displayFirstChar;
 
     /**
      * True if at least one display strings is different from the internal
      * char, false otherwise. This flag is more precise than checking the size
-     * of m_displayInputCache, because a tile can have input strings even if
+     * of m_displayTable, because a tile can have input strings even if
      * its display string is equal to the internal char.
      */
     bool m_hasDisplay;
 
+    /// Node of the trie of the input strings
+    struct InputNode
+    {
+        /// Internal char for the input string ending here (0 if none)
+        wchar_t letter;
+        /// Children of the node: next char of the input, and node index
+        vector<pair<wchar_t, unsigned int> > children;
+    };
+
+    /**
+     * Trie of all the input strings (both the lower case and upper case
+     * versions), used by convertFromInput(). The root is the first node.
+     *
+     * Note: only the chars which have more than 1 input string,
+     * or which have a display string different from the internal char,
+     * have their input strings in the trie.
+     */
+    vector<InputNode> m_inputTrie;
+
     static const Dictionary *m_dic;
 
+    /**
+     * Try to map the dictionary file in memory, and to use the edges
+     * directly from the mapping.
+     * Return false if it is not possible (the caller should then load
+     * the edges in memory)
+     */
+    bool mapEdges(const string &iPath, streamoff iOffset);
+
+    /// Load the edges in memory, and convert them to the machine byte order
+    void loadEdges(istream &iStream);
+
     void convertDataToArch();
     void initializeTiles();
 
+    /// Build the tables used by convertToDisplay() and convertFromInput()
+    void initializeConversions();
+
+    /// Add an input string to m_inputTrie
+    void addInputString(const wistring &iInput, wchar_t iLetter);
+
     /**
      * Walk the dictionary until the end of the word
      * @param s: current pointer to letters
@@ -320,18 +419,11 @@ private:
      */
     const DicEdge * seekEdgePtr(const wchar_t *s, const DicEdge *eptr) const;
 
-    /// Helper for search7pl1()
+    /// Helpers for search7pl1()
+    void search7pl1Aux(struct params_7plus1_t &params) const;
     void searchWordByLen(struct params_7plus1_t &params,
-                         int i, const DicEdge *edgeptr) const;
-
-    /// Helper for searchRegExp()
-    void searchRegexpRec(const struct params_regexp_t &params,
-                         int state,
-                         const DicEdge *edgeptr,
-                         vector<wdstring> &oWordList,
-                         unsigned int iMaxResults,
-                         const wdstring &iCurrWord = L"",
-                         unsigned int iNbChars = 0) const;
+                         unsigned int i, const DicEdge *edgeptr) const;
+    void addWordByLen(struct params_7plus1_t &params, unsigned int len) const;
 };
 
 #endif /* _DIC_H_ */
@@ -30,6 +30,7 @@
  *  \n
  *  ----------------    \n
  *  header              \n
+ *  (padding)           \n
  *  ----------------    \n
  *  specialnode (0)     \n
  *  +                   \n
@@ -53,5 +54,15 @@ struct __attribute__ ((packed)) DicEdge
       }
 };
 
+/**
+ * Reverse the byte order of a 32 bits integer (used to convert the edges
+ * when they are not stored in the byte order of the machine)
+ */
+inline uint32_t swapBytes32(uint32_t x)
+{
+    return (x >> 24) | ((x >> 8) & 0x0000FF00) |
+        ((x << 8) & 0x00FF0000) | (x << 24);
+}
+
 #endif /* _DIC_INTERNALS_H */
 
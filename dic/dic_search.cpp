@@ -23,15 +23,16 @@
 #include <cstring>
 #include <cwchar>
 #include <cwctype>
+#include <algorithm>
+#include <boost/foreach.hpp>
 
 #include "dic_internals.h"
 #include "dic_exception.h"
 #include "dic.h"
 #include "header.h"
 #include "encoding.h"
-#include "regexp.h"
-#include "automaton.h"
-#include "grammar.h"
+#include "compiled_regexp.h"
+#include "regexp_search.h"
 
 
 static const unsigned int DEFAULT_VECT_ALLOC = 100;
@@ -70,147 +71,226 @@ bool Dictionary::searchWord(const wstring &iWord) const
  * A pointer to the structure is passed as a parameter
  * so that all the search_* variables appear to the functions
  * as global but the code remains re-entrant.
- * Should be better to change the algorithm ...
+ *
+ * All the racks of a search are handled in a single walk of the dictionary.
+ * The prefix being walked is shared by all the racks, and for each rack we
+ * only keep the number of letters of the prefix which are not in the rack
+ * (the "deficit"). Using the letters of the rack first, and then the jokers,
+ * is always the best choice, so a word can be done with the rack if its
+ * deficit is not greater than the number of jokers. With one additional
+ * letter, the deficit can be one more: the added letter is then one of
+ * the letters of the word which are not covered by the rack.
  */
-
 struct params_7plus1_t
 {
-    unsigned int added_code;
-    wdstring added_display;
-    map<unsigned int, vector<wdstring> > *results;
-    int search_len;
-    wchar_t search_wordtst[DIC_WORD_MAX];
-    char search_letters[63];
+    /// Letters of the racks (count for each code, the jokers use the code 0)
+    vector<unsigned char> letters;
+    /// Number of letters of each rack (including the jokers)
+    vector<unsigned int> lengths;
+    /// Current deficit of each rack
+    vector<unsigned int> deficit;
+    /// Results of each rack
+    vector<map<unsigned int, vector<wdstring> > *> results;
+    /// Racks which can still be completed, for each depth
+    vector<vector<unsigned int> > live;
+    /// Maximal length of the words to find
+    unsigned int max_len;
+    /// Number of letters of each code in the current prefix
+    unsigned int search_counts[64];
+    dic_code_t search_codes[DIC_WORD_MAX + 2];
+    wchar_t search_wordtst[DIC_WORD_MAX + 2];
 };
 
-void Dictionary::searchWordByLen(struct params_7plus1_t &params,
-                                 int i, const DicEdge *edgeptr) const
-{
-    /* depth first search in the dictionary */
-    do
-    {
-        /* the test is false only when reach the end-node */
-        if (edgeptr->chr)
-        {
-            /* is the letter available in search_letters */
-            if (params.search_letters[edgeptr->chr])
-            {
-                params.search_wordtst[i] = getHeader().getCharFromCode(edgeptr->chr);
-                params.search_letters[edgeptr->chr] --;
-                if (i == params.search_len)
-                {
-                    if (edgeptr->term)
-                    {
-                        // Add the solution
-                        vector<wdstring> &sols = (*params.results)[params.added_code];
-                        if (sols.empty() || sols.back() != params.search_wordtst)
-                            sols.push_back(convertToDisplay(params.search_wordtst));
-                    }
-                }
-                else
-                {
-                    searchWordByLen(params, i + 1, getEdgeAt(edgeptr->ptr));
-                }
-                params.search_letters[edgeptr->chr] ++;
-                params.search_wordtst[i] = L'\0';
-            }
-
-            /* the letter is of course available if we have a joker available */
-            if (params.search_letters[0])
-            {
-                params.search_wordtst[i] = getHeader().getCharFromCode(edgeptr->chr);
-                params.search_letters[0] --;
-                if (i == params.search_len)
-                {
-                    if (edgeptr->term)
-                    {
-                        // Add the solution
-                        vector<wdstring> &sols = (*params.results)[params.added_code];
-                        if (sols.empty() || sols.back() != params.search_wordtst)
-                            sols.push_back(convertToDisplay(params.search_wordtst));
-                    }
-                }
-                else
-                {
-                    searchWordByLen(params, i + 1, getEdgeAt(edgeptr->ptr));
-                }
-                params.search_letters[0] ++;
-                params.search_wordtst[i] = L'\0';
-            }
-        }
-    } while (! (*edgeptr++).last);
-}
-
 
-void Dictionary::search7pl1(const wstring &iRack,
-                            map<unsigned int, vector<wdstring> > &oWordList,
-                            bool joker) const
+/**
+ * Prepare the search of the given rack.
+ * Return false if the rack does not need to be searched
+ */
+static bool add7pl1Rack(const Header &iHeader, struct params_7plus1_t &params,
+                        const wstring &iRack,
+                        map<unsigned int, vector<wdstring> > &oWordList,
+                        bool joker)
 {
     if (iRack == L"" || iRack.size() > DIC_WORD_MAX)
-        return;
-
-    struct params_7plus1_t params;
-
-    for (unsigned int i = 0; i < sizeof(params.search_letters); i++)
-        params.search_letters[i] = 0;
+        return false;
 
     /*
      * the letters are verified and changed to the dic internal
      * representation (using getCodeFromChar(*r))
      */
-    int wordlen = 0;
+    unsigned char letters[64] = { 0 };
+    unsigned int wordlen = 0;
     for (const wchar_t* r = iRack.c_str(); *r; r++)
     {
         if (iswalpha(*r))
         {
-            params.search_letters[getHeader().getCodeFromChar(*r)]++;
+            letters[iHeader.getCodeFromChar(*r)]++;
             wordlen++;
         }
         else if (*r == L'?')
         {
             if (joker)
             {
-                params.search_letters[0]++;
+                letters[0]++;
                 wordlen++;
             }
             else
             {
                 oWordList[0].push_back(L"** joker **");
-                return;
+                return false;
             }
         }
     }
 
     if (wordlen < 1)
+        return false;
+
+    params.letters.insert(params.letters.end(), letters, letters + 64);
+    params.lengths.push_back(wordlen);
+    params.results.push_back(&oWordList);
+    params.max_len = std::max(params.max_len, wordlen + 1);
+    return true;
+}
+
+
+void Dictionary::addWordByLen(struct params_7plus1_t &params,
+                              unsigned int len) const
+{
+    // The word is converted only once, for all the racks
+    wdstring displayWord;
+    params.search_wordtst[len] = L'\0';
+    BOOST_FOREACH(unsigned int r, params.live[len])
+    {
+        const unsigned char *rack = &params.letters[64 * r];
+        const unsigned int nbJokers = rack[0];
+        if (len == params.lengths[r])
+        {
+            if (params.deficit[r] > nbJokers)
+                continue;
+            if (displayWord.empty())
+                displayWord = convertToDisplay(params.search_wordtst);
+            (*params.results[r])[0].push_back(displayWord);
+        }
+        else if (len == params.lengths[r] + 1)
+        {
+            // Try each distinct letter of the word as the added one
+            for (unsigned int i = 0; i < len; ++i)
+            {
+                const dic_code_t code = params.search_codes[i];
+                if (std::find(params.search_codes, params.search_codes + i, code)
+                    != params.search_codes + i)
+                {
+                    continue;
+                }
+                unsigned int deficit = params.deficit[r];
+                if (params.search_counts[code] > rack[code])
+                    --deficit;
+                if (deficit > nbJokers)
+                    continue;
+                if (displayWord.empty())
+                    displayWord = convertToDisplay(params.search_wordtst);
+                (*params.results[r])[code].push_back(displayWord);
+            }
+        }
+    }
+}
+
+
+void Dictionary::searchWordByLen(struct params_7plus1_t &params,
+                                 unsigned int i, const DicEdge *edgeptr) const
+{
+    const vector<unsigned int> &live = params.live[i];
+    vector<unsigned int> &next = params.live[i + 1];
+
+    /* depth first search in the dictionary */
+    do
+    {
+        /* the test is false only when reach the end-node */
+        const dic_code_t code = edgeptr->chr;
+        if (code)
+        {
+            const unsigned int count = ++params.search_counts[code];
+            params.search_codes[i] = code;
+            params.search_wordtst[i] = getHeader().getCharFromCode(code);
+
+            // Keep the racks which can still be completed
+            next.clear();
+            BOOST_FOREACH(unsigned int r, live)
+            {
+                const unsigned char *rack = &params.letters[64 * r];
+                if (count > rack[code])
+                    params.deficit[r]++;
+                if (params.deficit[r] <= rack[0] + 1u &&
+                    i + 1 <= params.lengths[r] + 1)
+                {
+                    next.push_back(r);
+                }
+            }
+
+            if (!next.empty())
+            {
+                if (edgeptr->term)
+                    addWordByLen(params, i + 1);
+                if (i + 1 < params.max_len && edgeptr->ptr)
+                    searchWordByLen(params, i + 1, getEdgeAt(edgeptr->ptr));
+            }
+
+            BOOST_FOREACH(unsigned int r, live)
+            {
+                if (count > params.letters[64 * r + code])
+                    params.deficit[r]--;
+            }
+            --params.search_counts[code];
+        }
+    } while (! (*edgeptr++).last);
+}
+
+
+void Dictionary::search7pl1Aux(struct params_7plus1_t &params) const
+{
+    const unsigned int nbRacks = params.lengths.size();
+    if (nbRacks == 0)
         return;
 
+    params.deficit.assign(nbRacks, 0);
+    params.live.resize(params.max_len + 1);
+    params.live[0].clear();
+    for (unsigned int r = 0; r < nbRacks; ++r)
+        params.live[0].push_back(r);
+    for (unsigned int i = 0; i < 64; ++i)
+        params.search_counts[i] = 0;
+
     const DicEdge *root_edge = getEdgeAt(getRoot());
-    root_edge = getEdgeAt(root_edge->ptr);
+    if (root_edge->ptr)
+        searchWordByLen(params, 0, getEdgeAt(root_edge->ptr));
+}
 
-    params.results = &oWordList;
 
-    /* search for all the words that can be done with the letters */
-    params.added_code = 0;
-    params.added_display = L"";
-    params.search_len = wordlen - 1;
-    params.search_wordtst[wordlen] = L'\0';
-    searchWordByLen(params, 0, root_edge);
+void Dictionary::search7pl1(const wstring &iRack,
+                            map<unsigned int, vector<wdstring> > &oWordList,
+                            bool joker) const
+{
+    struct params_7plus1_t params;
+    params.max_len = 0;
+    if (add7pl1Rack(getHeader(), params, iRack, oWordList, joker))
+        search7pl1Aux(params);
+}
 
-    /* search for all the words that can be done with the letters +1 */
-    params.search_len = wordlen;
-    params.search_wordtst[wordlen + 1] = L'\0';
-    const wstring &letters = getHeader().getLetters();
-    for (unsigned int i = 0; i < letters.size(); i++)
-    {
-        unsigned int code = getHeader().getCodeFromChar(letters[i]);
-        params.added_code = code;
-        params.added_display = getHeader().getDisplayStr(code);
-        params.search_letters[code]++;
 
-        searchWordByLen(params, 0, root_edge);
+void Dictionary::search7pl1(const vector<wstring> &iRacks,
+                            vector<map<unsigned int, vector<wdstring> > > &oWordLists,
+                            bool joker) const
+{
+    oWordLists.resize(iRacks.size());
 
-        params.search_letters[code]--;
-    }
+    struct params_7plus1_t params;
+    params.max_len = 0;
+    params.letters.reserve(64 * iRacks.size());
+    params.lengths.reserve(iRacks.size());
+    params.results.reserve(iRacks.size());
+    for (unsigned int r = 0; r < iRacks.size(); ++r)
+        add7pl1Rack(getHeader(), params, iRacks[r], oWordLists[r], joker);
+    search7pl1Aux(params);
 }
 
 /****************************************/
@@ -317,96 +397,26 @@ void Dictionary::searchBenj(const wstring &iWord, vector<wdstring> &oWordList,
 /****************************************/
 /****************************************/
 
-struct params_regexp_t
-{
-    unsigned int minlength;
-    unsigned int maxlength;
-    Automaton *automaton_field;
-};
-
-
-void Dictionary::searchRegexpRec(const struct params_regexp_t &params,
-                                 int state,
-                                 const DicEdge *edgeptr,
-                                 vector<wdstring> &oWordList,
-                                 unsigned int iMaxResults,
-                                 const wdstring &iCurrWord,
-                                 unsigned int iNbChars) const
-{
-    if (iMaxResults && oWordList.size() >= iMaxResults)
-        return;
-
-    int next_state;
-    /* if we have a valid word we store it */
-    if (params.automaton_field->accept(state) && edgeptr->term)
-    {
-        if (params.minlength <= iNbChars &&
-            params.maxlength >= iNbChars)
-        {
-            oWordList.push_back(iCurrWord);
-        }
-    }
-    /* we now drive the search by exploring the dictionary */
-    const DicEdge *current = getEdgeAt(edgeptr->ptr);
-    do
-    {
-        /* the current letter is current->chr */
-        next_state = params.automaton_field->getNextState(state, current->chr);
-        /* 1: the letter appears in the automaton as is */
-        if (next_state)
-        {
-            searchRegexpRec(params, next_state, current, oWordList, iMaxResults,
-                            iCurrWord + getHeader().getDisplayStr(current->chr), iNbChars + 1);
-        }
-    } while (!(*current++).last);
-}
-
-
-/**
- * Initialize the lists of letters with pre-defined lists
- * 0: all tiles
- * 1: vowels
- * 2: consonants
- * 3: user defined 1
- * 4: user defined 2
- * x: lists used during parsing
- */
-static void initLetterLists(const Dictionary &iDic,
-                            searchRegExpLists &iList)
+bool Dictionary::searchRegExp(const wstring &iRegexp,
+                              vector<wdstring> &oWordList,
+                              unsigned int iMinLength,
+                              unsigned int iMaxLength,
+                              unsigned int iMaxResults) const
 {
-    memset(&iList, 0, sizeof(iList));
-    // Prepare the space for 5 items
-    iList.symbl.assign(5, 0);
-    iList.letters.assign(5, vector<bool>(DIC_LETTERS + 1, false));
-
-    iList.symbl[0] = RE_ALL_MATCH; // All letters
-    iList.symbl[1] = RE_VOWL_MATCH; // Vowels
-    iList.symbl[2] = RE_CONS_MATCH; // Consonants
-    iList.letters[0][0] = false;
-    iList.letters[1][0] = false;
-    iList.letters[2][0] = false;
-    const wstring &allLetters = iDic.getHeader().getLetters();
-    for (size_t i = 1; i <= allLetters.size(); ++i)
-    {
-        iList.letters[0][i] = true;
-        iList.letters[1][i] = iDic.getHeader().isVowel(i);
-        iList.letters[2][i] = iDic.getHeader().isConsonant(i);
-    }
+    if (iRegexp == L"")
+        return true;
 
-    iList.symbl[3] = RE_USR1_MATCH; // User defined list 1
-    iList.symbl[4] = RE_USR2_MATCH; // User defined list 2
+    const CompiledRegexp regexp(*this, iRegexp);
+    return searchRegExp(regexp, oWordList, iMinLength, iMaxLength, iMaxResults);
 }
 
 
-bool Dictionary::searchRegExp(const wstring &iRegexp,
+bool Dictionary::searchRegExp(const CompiledRegexp &iRegexp,
                               vector<wdstring> &oWordList,
                               unsigned int iMinLength,
                               unsigned int iMaxLength,
                               unsigned int iMaxResults) const
 {
-    if (iRegexp == L"")
-        return true;
-
     // Allocate room for all the results
     // XXX: is it really a good idea?
     if (iMaxResults)
@@ -414,49 +424,8 @@ bool Dictionary::searchRegExp(const wstring &iRegexp,
     else
         oWordList.reserve(DEFAULT_VECT_ALLOC);
 
-    // Parsing
-    Node *root = NULL;
-    searchRegExpLists llist;
-    // Initialize the lists of letters
-    initLetterLists(*this, llist);
-    bool parsingOk = parseRegexp(*this, (iRegexp + L"#").c_str(), &root, llist);
-
-    if (!parsingOk)
-    {
-        delete root;
-        throw InvalidRegexpException(lfw(iRegexp));
-    }
-
-    int ptl[REGEXP_MAX+1];
-    uint64_t PS[REGEXP_MAX+1];
-
-    for (int i = 0; i < REGEXP_MAX; i++)
-    {
-        PS[i] = 0;
-        ptl[i] = 0;
-    }
-
-    int n = 1;
-    int p = 1;
-    root->traverse(p, n, ptl);
-    PS [0] = p - 1;
-    ptl[0] = p - 1;
-
-    root->nextPos(PS);
-
-    Automaton *a = new Automaton(root->getFirstPos(), ptl, PS, llist);
-    if (a)
-    {
-        struct params_regexp_t params;
-        params.minlength = iMinLength;
-        params.maxlength = iMaxLength;
-        params.automaton_field = a;
-        searchRegexpRec(params, a->getInitId(),
-                        getEdgeAt(getRoot()), oWordList,
-                        iMaxResults ? iMaxResults + 1 : 0);
-        delete a;
-    }
-    delete root;
+    RegexpSearch search(*this, iRegexp, iMinLength, iMaxLength);
+    search.next(oWordList, iMaxResults ? iMaxResults + 1 : 0);
 
     // Check whether the maximum number of results was reached
     if (iMaxResults && oWordList.size() > iMaxResults)
@@ -186,10 +186,50 @@ struct Dict_header_ext_2
     // --- we have a multiple of 64 bytes here
 };
 
+/**
+ * Extension of the extension of the extension (used in version 3).
+ * This version is only written for GADDAG dictionaries, so that DAWG
+ * dictionaries stay readable by older versions of Eliot.
+ */
+struct Dict_header_ext_3
+{
+    Dict_header_ext_3()
+    {
+        // Make sure we won't write uninitialized bytes
+        memset(this, 0, sizeof(*this));
+    }
+
+    // Root of the GADDAG part of the dictionary (0 for a DAWG)
+    uint32_t gaddagRoot;
+    // Byte order of the edges (a Header::ByteOrder value)
+    uint8_t byteOrder;
+    // Number of padding bytes between the header and the first edge,
+    // to have properly aligned edges in a memory-mapped file
+    uint8_t padding;
+    // Unused at the moment, reserved for future use
+    char unused[58];
+
+    // --- we have a multiple of 64 bytes here
+};
+
+
+/// Alignment of the first edge in the dictionary file (version 3 and later)
+#define _EDGES_ALIGNMENT_ 8
+
+
+Header::ByteOrder Header::GetHostByteOrder()
+{
+#if defined(WORDS_BIGENDIAN)
+    return kBIG_ENDIAN;
+#else
+    return kLITTLE_ENDIAN;
+#endif
+}
+
 
 Header::Header(istream &iStream)
-    : m_root(0), m_nbWords(0), m_nodesUsed(0), m_edgesUsed(0),
-      m_nodesSaved(0), m_edgesSaved(0), m_type(kDAWG)
+    : m_root(0), m_gaddagRoot(0), m_nbWords(0), m_nodesUsed(0), m_edgesUsed(0),
+      m_nodesSaved(0), m_edgesSaved(0), m_type(kDAWG), m_byteOrder(kBIG_ENDIAN)
 {
     // Simply delegate to the read() method
     // The code is not moved here because I find it more natural to have a
@@ -201,8 +241,10 @@ Header::Header(istream &iStream)
 
 Header::Header(const DictHeaderInfo &iInfo)
 {
-    // Use the latest serialization format
-    m_version = 2;
+    // Use the latest serialization format, unless the additional data of
+    // the latest format is not needed (to keep compatibility with older
+    // versions of Eliot)
+    m_version = (iInfo.dawg && !iInfo.littleEndian) ? 2 : 3;
 
     // Sanity checks
     if (iInfo.letters.size() > _MAX_LETTERS_NB_)
@@ -236,12 +278,14 @@ Header::Header(const DictHeaderInfo &iInfo)
     m_compressDate = time(NULL);
     m_userHost = wfl(ELIOT_COMPILE_BY + string("@") + ELIOT_COMPILE_HOST);
     m_root = iInfo.root;
+    m_gaddagRoot = iInfo.dawg ? 0 : iInfo.gaddagroot;
     m_nbWords = iInfo.nwords;
     m_nodesUsed = iInfo.nodesused;
     m_edgesUsed = iInfo.edgesused;
     m_nodesSaved = iInfo.nodessaved;
     m_edgesSaved = iInfo.edgessaved;
     m_type = iInfo.dawg ? kDAWG : kGADDAG;
+    m_byteOrder = iInfo.littleEndian ? kLITTLE_ENDIAN : kBIG_ENDIAN;
     m_dicName = iInfo.dicName;
     m_letters = iInfo.letters;
     m_points = iInfo.points;
@@ -483,6 +527,32 @@ void Header::read(istream &iStream)
         // Parse this string and structure the data
         readDisplayAndInput(serialized);
     }
+
+    // Read the root of the GADDAG
+    if (m_version >= 3)
+    {
+        Dict_header_ext_3 aHeaderExt3;
+        iStream.read((char*)&aHeaderExt3, sizeof(Dict_header_ext_3));
+        if (iStream.gcount() != sizeof(Dict_header_ext_3))
+            throw DicException("Header::read: expected to read more bytes (ext3)");
+
+        // Handle endianness
+        m_gaddagRoot = ntohl(aHeaderExt3.gaddagRoot);
+
+        if (aHeaderExt3.byteOrder != kBIG_ENDIAN &&
+            aHeaderExt3.byteOrder != kLITTLE_ENDIAN)
+        {
+            throw DicException("Header::read: unknown byte order for the edges");
+        }
+        m_byteOrder = static_cast<ByteOrder>(aHeaderExt3.byteOrder);
+
+        // Skip the padding, to be positioned on the first edge
+        iStream.ignore(aHeaderExt3.padding);
+        if (iStream.gcount() != aHeaderExt3.padding)
+            throw DicException("Header::read: expected to read more bytes (padding)");
+    }
+    if (m_type == kGADDAG && m_gaddagRoot == 0)
+        throw DicException("Header::read: GADDAG dictionary without GADDAG root");
 }
 
 
@@ -569,6 +639,26 @@ void Header::write(ostream &oStream) const
     oStream.write((char*)&aHeaderExt2, sizeof(Dict_header_ext_2));
     if (!oStream.good())
         throw DicException("Header::write: error when writing to file (ext2)");
+
+    if (m_version < 3)
+        return;
+
+    // Write the third extension
+    Dict_header_ext_3 aHeaderExt3;
+    aHeaderExt3.gaddagRoot = htonl(m_gaddagRoot);
+    aHeaderExt3.byteOrder = m_byteOrder;
+    const unsigned int size = sizeof(Dict_header_old) + sizeof(Dict_header_ext) +
+        sizeof(Dict_header_ext_2) + sizeof(Dict_header_ext_3);
+    aHeaderExt3.padding = (_EDGES_ALIGNMENT_ - size % _EDGES_ALIGNMENT_) % _EDGES_ALIGNMENT_;
+    oStream.write((char*)&aHeaderExt3, sizeof(Dict_header_ext_3));
+    if (!oStream.good())
+        throw DicException("Header::write: error when writing to file (ext3)");
+
+    // Write the padding
+    const char padding[_EDGES_ALIGNMENT_] = { 0 };
+    oStream.write(padding, aHeaderExt3.padding);
+    if (!oStream.good())
+        throw DicException("Header::write: error when writing to file (padding)");
 }
 
 
@@ -658,8 +748,16 @@ void Header::print(ostream &out) const
     out << fmt(_("Number of words: %1%")) % m_nbWords << endl;
     long unsigned int size = sizeof(Dict_header_old) +
         sizeof(Dict_header_ext) + sizeof(Dict_header_ext_2);
+    if (m_version >= 3)
+    {
+        size += sizeof(Dict_header_ext_3);
+        size += (_EDGES_ALIGNMENT_ - size % _EDGES_ALIGNMENT_) % _EDGES_ALIGNMENT_;
+    }
     out << fmt(_("Header size: %1% bytes")) % size << endl;
+    out << fmt(_("Edges byte order: %1%")) % (m_byteOrder == kBIG_ENDIAN ? "big-endian" : "little-endian") << endl;
     out << fmt(_("Root: %1% (edge)")) % m_root << endl;
+    if (m_type == kGADDAG)
+        out << fmt(_("GADDAG root: %1% (edge)")) % m_gaddagRoot << endl;
     out << fmt(_("Nodes: %1% used + %2% saved")) % m_nodesUsed % m_nodesSaved << endl;
     out << fmt(_("Edges: %1% used + %2% saved")) % m_edgesUsed % m_edgesSaved << endl;
 #undef fmt
@@ -49,7 +49,11 @@ struct DictHeaderInfo
     uint32_t nodesused;
     uint32_t nodessaved;
     uint32_t edgessaved;
+    /// Root of the GADDAG part (only meaningful when dawg is false)
+    uint32_t gaddagroot;
     bool dawg;
+    /// True to store the edges in little-endian order (big-endian otherwise)
+    bool littleEndian;
     wstring dicName;
     wstring letters;
     vector<uint8_t> points;
@@ -81,7 +85,13 @@ class Header
     DEFINE_LOGGER();
 public:
 
-    /// Dictionary type
+    /**
+     * Dictionary type.
+     * A GADDAG dictionary is a DAWG dictionary with an additional GADDAG
+     * part, reachable from getGaddagRoot(): getRoot() always gives access
+     * to the DAWG part, so both types can be used in the same way by the
+     * code which doesn't care about the GADDAG.
+     */
     enum DictType
     {
         kDAWG = 1,
@@ -89,7 +99,24 @@ public:
     };
 
     /**
-     * Constructor from an input stream
+     * Byte order of the edges of the dictionary.
+     * The historical format uses the big-endian order, which requires a
+     * conversion on little-endian machines. When the edges are stored in
+     * the byte order of the machine, the dictionary can be used directly
+     * from a memory-mapped file.
+     */
+    enum ByteOrder
+    {
+        kBIG_ENDIAN = 0,
+        kLITTLE_ENDIAN = 1
+    };
+
+    /// Byte order of the current machine
+    static ByteOrder GetHostByteOrder();
+
+    /**
+     * Constructor from an input stream.
+     * After the call, the stream is positioned on the first edge
      * @param iStream: Input stream where to read the header
      */
     Header(istream &iStream);
@@ -106,6 +133,7 @@ public:
     /// Getters
     //@{
     unsigned int getRoot()         const { return m_root; }
+    unsigned int getGaddagRoot()   const { return m_gaddagRoot; }
     unsigned int getNbWords()      const { return m_nbWords; }
     unsigned int getNbNodesUsed()  const { return m_nodesUsed; }
     unsigned int getNbEdgesUsed()  const { return m_edgesUsed; }
@@ -113,6 +141,7 @@ public:
     unsigned int getNbEdgesSaved() const { return m_edgesSaved; }
     wstring      getName()         const { return m_dicName; }
     DictType     getType()         const { return m_type; }
+    ByteOrder    getByteOrder()    const { return m_byteOrder; }
     wstring      getLetters()      const { return m_letters; }
     wstring      getInputChars()   const { return m_inputChars; }
     unsigned int getMinCode()      const { return 1; }
@@ -170,6 +199,7 @@ private:
     time_t m_compressDate;
 
     uint32_t m_root;
+    uint32_t m_gaddagRoot;
     uint32_t m_nbWords;
     uint32_t m_nodesUsed;
     uint32_t m_edgesUsed;
@@ -179,6 +209,9 @@ private:
     /// Specify whether the dictionary is a DAWG or a GADDAG
     DictType m_type;
 
+    /// Byte order of the edges
+    ByteOrder m_byteOrder;
+
     /// Dictionary name (e.g.: ODS 5.0)
     wstring m_dicName;
 
@@ -0,0 +1,125 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2013 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#include "regexp_search.h"
+#include "compiled_regexp.h"
+#include "automaton.h"
+#include "dic_internals.h"
+#include "header.h"
+#include "debug.h"
+
+using namespace std;
+
+
+/// Visitor adding the words to a vector
+class WordListVisitor : public RegexpSearch::Visitor
+{
+public:
+    WordListVisitor(vector<wdstring> &oWordList) : m_wordList(oWordList) {}
+
+    virtual bool visit(const wdstring &iWord)
+    {
+        m_wordList.push_back(iWord);
+        return true;
+    }
+
+private:
+    vector<wdstring> &m_wordList;
+};
+
+
+RegexpSearch::RegexpSearch(const Dictionary &iDic,
+                           const CompiledRegexp &iRegexp,
+                           unsigned int iMinLength,
+                           unsigned int iMaxLength)
+    : m_dic(iDic), m_automaton(iRegexp.getAutomaton()),
+    m_minLength(iMinLength), m_maxLength(iMaxLength), m_depth(0)
+{
+    ASSERT(&iRegexp.getDic() == &iDic,
+           "The regexp was compiled for another dictionary");
+
+    // The empty word is never in the dictionary, so we can start
+    // directly with the first letters
+    const DicEdge *root = m_dic.getEdgeAt(m_dic.getRoot());
+    m_stack[0].edge = root->ptr ? m_dic.getEdgeAt(root->ptr) : NULL;
+    m_stack[0].state = m_automaton.getInitId();
+    // The words of the dictionary have less than DIC_WORD_MAX letters
+    if (m_maxLength >= DIC_WORD_MAX)
+        m_maxLength = DIC_WORD_MAX - 1;
+}
+
+
+unsigned int RegexpSearch::next(Visitor &iVisitor, unsigned int iMaxResults)
+{
+    unsigned int nbResults = 0;
+    while (m_depth >= 0)
+    {
+        Frame &frame = m_stack[m_depth];
+        const DicEdge *edge = frame.edge;
+        if (edge == NULL)
+        {
+            // All the words with this prefix have been explored
+            --m_depth;
+            continue;
+        }
+        frame.edge = edge->last ? NULL : edge + 1;
+
+        const int nextState = m_automaton.getNextState(frame.state, edge->chr);
+        if (!nextState)
+            continue;
+
+        // Go down in the dictionary, if longer words are allowed
+        m_codes[m_depth] = edge->chr;
+        const unsigned int len = m_depth + 1;
+        if (len < m_maxLength && edge->ptr)
+        {
+            ++m_depth;
+            m_stack[m_depth].edge = m_dic.getEdgeAt(edge->ptr);
+            m_stack[m_depth].state = nextState;
+        }
+
+        if (edge->term && m_automaton.accept(nextState) &&
+            len >= m_minLength && len <= m_maxLength)
+        {
+            const Header &header = m_dic.getHeader();
+            m_word.clear();
+            for (unsigned int i = 0; i < len; ++i)
+                m_word += header.getDisplayStr(m_codes[i]);
+            ++nbResults;
+            // The position in the dictionary is already saved,
+            // so the search can be stopped here and resumed later
+            if (!iVisitor.visit(m_word) ||
+                (iMaxResults && nbResults >= iMaxResults))
+            {
+                break;
+            }
+        }
+    }
+    return nbResults;
+}
+
+
+unsigned int RegexpSearch::next(vector<wdstring> &oWordList,
+                                unsigned int iMaxResults)
+{
+    WordListVisitor visitor(oWordList);
+    return next(visitor, iMaxResults);
+}
+
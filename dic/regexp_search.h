@@ -0,0 +1,112 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2013 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#ifndef REGEXP_SEARCH_H_
+#define REGEXP_SEARCH_H_
+
+#include <vector>
+
+#include "dic.h"
+
+class CompiledRegexp;
+class Automaton;
+struct DicEdge;
+
+using std::vector;
+
+
+/**
+ * Incremental search of the words matching a regular expression.
+ *
+ * The matching words are given one by one to a visitor, in the order of
+ * the dictionary. The search can be interrupted at any time (by the visitor,
+ * or after a given number of results), and resumed later with another call
+ * to next(). This allows displaying the results of a broad search
+ * progressively, without computing all of them first.
+ *
+ * The walk of the dictionary uses an explicit stack, and the letters of the
+ * current word are kept in a fixed-size buffer: the display string of a word
+ * is only built when the word matches.
+ *
+ * The dictionary and the compiled regular expression must outlive
+ * the search.
+ */
+class RegexpSearch
+{
+public:
+    /// Interface of the objects receiving the matching words
+    class Visitor
+    {
+    public:
+        virtual ~Visitor() {}
+
+        /**
+         * Called for each matching word.
+         * The string is only valid during the call.
+         * @return false to interrupt the search (it can be resumed later)
+         */
+        virtual bool visit(const wdstring &iWord) = 0;
+    };
+
+    RegexpSearch(const Dictionary &iDic, const CompiledRegexp &iRegexp,
+                 unsigned int iMinLength, unsigned int iMaxLength);
+
+    /**
+     * Continue the search, until iMaxResults new words are found
+     * (0 means no limit), or until the visitor interrupts it.
+     * @return the number of words given to the visitor during this call
+     */
+    unsigned int next(Visitor &iVisitor, unsigned int iMaxResults = 0);
+
+    /**
+     * Same as the previous method, the words being added
+     * at the end of oWordList
+     */
+    unsigned int next(vector<wdstring> &oWordList, unsigned int iMaxResults = 0);
+
+    /// Return true when all the matching words have been found
+    bool isFinished() const { return m_depth < 0; }
+
+private:
+    /// Position in the dictionary for a given depth
+    struct Frame
+    {
+        /// Next edge to explore (NULL when all the edges have been explored)
+        const DicEdge *edge;
+        /// State of the automaton
+        int state;
+    };
+
+    const Dictionary &m_dic;
+    const Automaton &m_automaton;
+    unsigned int m_minLength;
+    unsigned int m_maxLength;
+
+    /// Stack of the walk (the index is the length of the current word)
+    Frame m_stack[DIC_WORD_MAX + 1];
+    /// Current depth in the stack (-1 when the search is finished)
+    int m_depth;
+    /// Letter codes of the current word
+    unsigned int m_codes[DIC_WORD_MAX];
+    /// Buffer for the display string of the matching words
+    wdstring m_word;
+};
+
+#endif
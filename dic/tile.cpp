@@ -154,7 +154,10 @@ Tile Tile::toLower() const
 {
     ASSERT(iswalpha(m_char),
            "toLower() should be called on alphabetical tiles");
-    return Tile(towlower(m_char));
+    // Avoid the char --> code conversion of the wchar_t constructor
+    Tile tile(*this);
+    tile.m_joker = true;
+    return tile;
 }
 
 
@@ -162,7 +165,10 @@ Tile Tile::toUpper() const
 {
     ASSERT(iswalpha(m_char),
            "toUpper() should be called on alphabetical tiles");
-    return Tile(towupper(m_char));
+    // Avoid the char --> code conversion of the wchar_t constructor
+    Tile tile(*this);
+    tile.m_joker = false;
+    return tile;
 }
 
 
@@ -32,6 +32,7 @@ INIT_LOGGER(game, AIPercent);
 
 
 AIPercent::AIPercent(float iPercent)
+    : m_equityResults(NULL)
 {
     if (iPercent < 0)
         iPercent = 0;
@@ -63,6 +64,15 @@ void AIPercent::compute(const Dictionary &iDic, const Board &iBoard, bool iFirst
 }
 
 
+void AIPercent::compute(const Results &iAllResults)
+{
+    if (m_equityResults != NULL)
+        m_equityResults->setRack(getCurrentRack().getRack());
+    // The rounds are chosen with the same rules as in the search
+    m_results->select(iAllResults);
+}
+
+
 Move AIPercent::getMove() const
 {
     if (m_results->isEmpty())
@@ -74,8 +84,30 @@ Move AIPercent::getMove() const
     }
     else
     {
-        // TODO: use MoveSelector to select a correct move
+        // When a leave table is set, m_results is already ordered by
+        // equity (see EquityResults), so the first round is the best one
         return Move(m_results->get(0));
     }
 }
 
+
+void AIPercent::setLeaveTable(const boost::shared_ptr<const LeaveTable> &iTable)
+{
+    // Only the best AI uses the leave table
+    if (m_percent < 1 || iTable == m_leaveTable)
+        return;
+
+    m_leaveTable = iTable;
+    delete m_results;
+    if (iTable)
+    {
+        m_equityResults = new EquityResults(iTable);
+        m_results = m_equityResults;
+    }
+    else
+    {
+        m_equityResults = NULL;
+        m_results = new BestResults;
+    }
+}
+
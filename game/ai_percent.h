@@ -35,6 +35,10 @@
  * the highest score), while a percentage of 0 should return the worst one.
  * This kind of AI will never change letters (unless it cannot play anything,
  * in which case it just passes without changing letters).
+ *
+ * When a leave table is given, an AI with a percentage of 1 chooses the
+ * round with the best equity instead of the best score (see EquityResults).
+ * The other levels ignore the table.
  */
 class AIPercent: public AIPlayer
 {
@@ -51,14 +55,28 @@ public:
      * of the following methods, so it must prepare everything for them.
      */
     virtual void compute(const Dictionary &iDic, const Board &iBoard, bool iFirstWord);
+    virtual void compute(const Results &iAllResults);
 
     /// Return the move played by the AI
     virtual Move getMove() const;
 
+    virtual void setLeaveTable(const boost::shared_ptr<const LeaveTable> &iTable);
+
+    /**
+     * Return a filter applying the rules used by this AI to ignore the
+     * rounds with a too low score (see Results::createFilter()).
+     * The rules of a given level are less strict than the ones of any
+     * higher level. The caller takes ownership of the returned object.
+     */
+    Results * createFilter() const { return m_results->createFilter(); }
+
 private:
     float m_percent;
     /// Container for all the found solutions
     Results *m_results;
+    /// Same object as m_results when a leave table is used, NULL otherwise
+    EquityResults *m_equityResults;
+    boost::shared_ptr<const LeaveTable> m_leaveTable;
 };
 
 #endif
@@ -21,12 +21,16 @@
 #ifndef AI_PLAYER_H_
 #define AI_PLAYER_H_
 
+#include <boost/shared_ptr.hpp>
+
 #include "player.h"
 
 class Dictionary;
 class Round;
 class Board;
 class Tile;
+class Results;
+class LeaveTable;
 
 /**
  * This class is a pure interface, that must be implemented by all the AI
@@ -72,9 +76,27 @@ public:
      */
     virtual void compute(const Dictionary &iDic, const Board &iBoard, bool iFirstWord) = 0;
 
+    /**
+     * Same as compute(), but the move is chosen among the given results,
+     * which must contain all the rounds playable with the current rack,
+     * except maybe the ones that the player would ignore anyway
+     * (see Results::select()). This allows sharing a single search between
+     * several AI players having the same rack, in duplicate mode.
+     */
+    virtual void compute(const Results &iAllResults) = 0;
+
     /// Return the move played by the AI
     virtual Move getMove() const = 0;
 
+    /**
+     * Give a leave table to the AI, to evaluate the tiles kept on the rack
+     * by the moves (see LeaveTable), or an empty pointer to consider the
+     * score only. The game only gives a table when the tiles kept by the
+     * player matter (i.e. not in duplicate mode).
+     * The default implementation ignores the table.
+     */
+    virtual void setLeaveTable(const boost::shared_ptr<const LeaveTable> &) {}
+
 protected:
     /// This class is a pure interface, forbid any direct instanciation
     AIPlayer() {}
@@ -19,12 +19,13 @@
  * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
  *****************************************************************************/
 
+#include <algorithm>
+#include <cstring> // For memset()
 #include <boost/foreach.hpp>
 
-#include <cstdlib> // For rand()
-
 #include <dic.h>
 #include "bag.h"
+#include "random.h"
 #include "debug.h"
 #include "encoding.h"
 
@@ -33,50 +34,90 @@ INIT_LOGGER(game, Bag);
 
 
 Bag::Bag(const Dictionary &iDic)
-    : m_dic(iDic), m_nbTiles(0)
+    : m_dic(iDic)
 {
-    BOOST_FOREACH(const Tile &tile, m_dic.getAllTiles())
+    Layout *layout = new Layout;
+    m_layout.reset(layout);
+
+    layout->tiles = m_dic.getAllTiles();
+    ASSERT(layout->tiles.size() <= kMAX_TILES, "Too many tiles in the dictionary");
+    std::sort(layout->tiles.begin(), layout->tiles.end());
+
+    for (unsigned i = 0; i < kMAX_TILES; ++i)
+        layout->positions[i] = -1;
+    layout->jokerPos = -1;
+    layout->topStep = 1;
+    while (2 * layout->topStep <= layout->tiles.size())
+        layout->topStep *= 2;
+
+    memset(m_counts, 0, sizeof(m_counts));
+    memset(m_trees, 0, sizeof(m_trees));
+    memset(m_nbTiles, 0, sizeof(m_nbTiles));
+
+    for (unsigned i = 0; i < layout->tiles.size(); ++i)
     {
-        m_tilesMap[tile] = tile.maxNumber();
-        m_nbTiles += tile.maxNumber();
+        const Tile &tile = layout->tiles[i];
+        if (tile.isJoker())
+            layout->jokerPos = i;
+        else
+        {
+            ASSERT(tile.toCode() < kMAX_TILES, "Invalid tile code");
+            layout->positions[tile.toCode()] = i;
+        }
+
+        unsigned kinds = 1 << kALL;
+        if (tile.isVowel())
+            kinds |= 1 << kVOWELS;
+        if (tile.isConsonant())
+            kinds |= 1 << kCONSONANTS;
+        layout->kinds.push_back(kinds);
+
+        update(i, tile.maxNumber());
     }
 }
 
 
-unsigned Bag::count(const Tile &iTile) const
+Bag::Bag(const Bag &iOther)
+    : m_dic(iOther.m_dic)
 {
-    map<Tile, int>::const_iterator it = m_tilesMap.find(iTile);
-    if (it != m_tilesMap.end())
-        return it->second;
-    return 0;
+    *this = iOther;
 }
 
 
-unsigned Bag::getNbVowels() const
+int Bag::getPosition(const Tile &iTile) const
 {
-    int v = 0;
+    // Like with Tile::operator<(), all the jokers are equivalent
+    if (iTile.isJoker())
+        return m_layout->jokerPos;
+    const unsigned code = iTile.toCode();
+    if (code >= kMAX_TILES)
+        return -1;
+    return m_layout->positions[code];
+}
 
-    std::pair<Tile, int> p;
-    BOOST_FOREACH(p, m_tilesMap)
+
+void Bag::update(int iPos, int iDelta)
+{
+    const unsigned kinds = m_layout->kinds[iPos];
+    const unsigned size = m_layout->tiles.size();
+    m_counts[iPos] += iDelta;
+    for (unsigned k = 0; k < kNB_KINDS; ++k)
     {
-        if (p.first.isVowel())
-            v += p.second;
+        if (!(kinds & (1 << k)))
+            continue;
+        m_nbTiles[k] += iDelta;
+        for (unsigned i = iPos + 1; i <= size; i += i & -i)
+            m_trees[k][i] += iDelta;
     }
-    return v;
 }
 
 
-unsigned Bag::getNbConsonants() const
+unsigned Bag::count(const Tile &iTile) const
 {
-    int c = 0;
-
-    std::pair<Tile, int> p;
-    BOOST_FOREACH(p, m_tilesMap)
-    {
-        if (p.first.isConsonant())
-            c += p.second;
-    }
-    return c;
+    const int pos = getPosition(iTile);
+    if (pos < 0)
+        return 0;
+    return m_counts[pos];
 }
 
 
@@ -85,8 +126,7 @@ void Bag::takeTile(const Tile &iTile)
     ASSERT(contains(iTile),
            "The bag does not contain the letter " + lfw(iTile.getDisplayStr()));
 
-    m_tilesMap[iTile]--;
-    m_nbTiles--;
+    update(getPosition(iTile), -1);
 }
 
 
@@ -95,56 +135,58 @@ void Bag::replaceTile(const Tile &iTile)
     ASSERT(count(iTile) < iTile.maxNumber(),
            "Cannot replace tile: " + lfw(iTile.getDisplayStr()));
 
-    m_tilesMap[iTile]++;
-    m_nbTiles++;
+    update(getPosition(iTile), 1);
 }
 
 
-Tile Bag::selectRandom() const
+Tile Bag::selectRandom(Random &ioRandom) const
 {
-    return selectRandomTile(m_nbTiles, false, false);
+    return selectRandomTile(ioRandom, kALL);
 }
 
 
-Tile Bag::selectRandomVowel() const
+Tile Bag::selectRandomVowel(Random &ioRandom) const
 {
-    return selectRandomTile(getNbVowels(), true, false);
+    return selectRandomTile(ioRandom, kVOWELS);
 }
 
 
-Tile Bag::selectRandomConsonant() const
+Tile Bag::selectRandomConsonant(Random &ioRandom) const
 {
-    return selectRandomTile(getNbConsonants(), false, true);
+    return selectRandomTile(ioRandom, kCONSONANTS);
 }
 
 
-Tile Bag::selectRandomTile(unsigned total,
-                           bool onlyVowels, bool onlyConsonants) const
+Tile Bag::selectRandomTile(Random &ioRandom, Kind iKind) const
 {
-    ASSERT(total > 0, "Not enough tiles (of the requested kind) in the bag");
-
-    int n = (int)((double)total * rand() / (RAND_MAX + 1.0));
-    std::pair<Tile, int> p;
-    BOOST_FOREACH(p, m_tilesMap)
+    ASSERT(m_nbTiles[iKind] > 0,
+           "Not enough tiles (of the requested kind) in the bag");
+
+    // Find the first position whose cumulated count is greater than n,
+    // by descending the Fenwick tree
+    unsigned n = ioRandom.getInt(m_nbTiles[iKind]);
+    const unsigned *tree = m_trees[iKind];
+    const unsigned size = m_layout->tiles.size();
+    unsigned pos = 0;
+    for (unsigned step = m_layout->topStep; step > 0; step /= 2)
     {
-        if (onlyVowels && !p.first.isVowel())
-            continue;
-        if (onlyConsonants && !p.first.isConsonant())
-            continue;
-        if (n < p.second)
-            return p.first;
-        n -= p.second;
+        if (pos + step <= size && tree[pos + step] <= n)
+        {
+            pos += step;
+            n -= tree[pos];
+        }
     }
-    ASSERT(false, "We should not come here");
-    return Tile();
+    ASSERT(pos < size, "We should not come here");
+    return m_layout->tiles[pos];
 }
 
 
 Bag & Bag::operator=(const Bag &iOther)
 {
-    m_tilesMap = iOther.m_tilesMap;
-    m_nbTiles = iOther.m_nbTiles;
+    m_layout = iOther.m_layout;
+    memcpy(m_counts, iOther.m_counts, sizeof(m_counts));
+    memcpy(m_trees, iOther.m_trees, sizeof(m_trees));
+    memcpy(m_nbTiles, iOther.m_nbTiles, sizeof(m_nbTiles));
     return *this;
 }
 
-
@@ -22,23 +22,34 @@
 #ifndef BAG_H_
 #define BAG_H_
 
-#include <map>
+#include <vector>
+#include <boost/shared_ptr.hpp>
 #include "tile.h"
 #include "logging.h"
 
-using std::map;
+using std::vector;
 
 class Dictionary;
+class Random;
 
 
 /**
  * A bag stores the set of free tiles for the game.
+ *
+ * The number of tiles of each letter is stored in an array, and Fenwick
+ * trees (one for all the tiles, one for the vowels, one for the consonants)
+ * allow drawing a random tile in logarithmic time. The letters are ordered
+ * like the Tile objects (with the joker last), so that a given random number
+ * always gives the same tile as with the previous implementations.
+ *
+ * Copying a bag doesn't allocate any memory, so temporary copies are cheap.
  */
 class Bag
 {
     DEFINE_LOGGER();
 public:
     explicit Bag(const Dictionary &iDic);
+    Bag(const Bag &iOther);
 
     /// Take a tile in the bag
     void takeTile(const Tile &iTile);
@@ -59,27 +70,27 @@ public:
      * Warning: b.getNbVowels() + b.getNbConsonants() != b.getNbTiles(),
      * because of the jokers and the 'Y'.
      */
-    unsigned getNbTiles() const { return m_nbTiles; }
-    unsigned getNbVowels() const;
-    unsigned getNbConsonants() const;
+    unsigned getNbTiles() const { return m_nbTiles[kALL]; }
+    unsigned getNbVowels() const { return m_nbTiles[kVOWELS]; }
+    unsigned getNbConsonants() const { return m_nbTiles[kCONSONANTS]; }
 
     /**
-     * Return a random available tile
+     * Return a random available tile, drawn with the given generator.
      * The tile is not taken out of the bag.
      */
-    Tile selectRandom() const;
+    Tile selectRandom(Random &ioRandom) const;
 
     /**
      * Return a random available vowel.
      * The tile is not taken out of the bag.
      */
-    Tile selectRandomVowel() const;
+    Tile selectRandomVowel(Random &ioRandom) const;
 
     /**
      * Return a random available consonant.
      * The tile is not taken out of the bag.
      */
-    Tile selectRandomConsonant() const;
+    Tile selectRandomConsonant(Random &ioRandom) const;
 
     Bag & operator=(const Bag &iOther);
 
@@ -87,18 +98,59 @@ public:
     const Dictionary & getDic() const { return m_dic; }
 
 private:
+    /// Maximal number of different tiles (the codes are stored on 6 bits)
+    static const unsigned kMAX_TILES = 64;
+
+    /// Kinds of tiles, each one having its own Fenwick tree
+    enum Kind
+    {
+        kALL,
+        kVOWELS,
+        kCONSONANTS,
+        kNB_KINDS
+    };
+
+    /**
+     * Description of the tiles of the dictionary, shared by a bag
+     * and all its copies
+     */
+    struct Layout
+    {
+        /// Tiles of the dictionary, in the order of Tile::operator<()
+        vector<Tile> tiles;
+        /// Kinds of each tile (bit field of (1 << Kind))
+        vector<unsigned> kinds;
+        /// Position in 'tiles' of each tile code (-1 if unknown)
+        int positions[kMAX_TILES];
+        /// Position of the joker (-1 if the dictionary has no joker)
+        int jokerPos;
+        /// Highest power of 2 lower or equal to the number of tiles
+        unsigned topStep;
+    };
+
     /// Dictionary
     const Dictionary &m_dic;
 
-    /// Associate to each tile its number of occurrences in the bag
-    map<Tile, int> m_tilesMap;
+    /// Description of the tiles
+    boost::shared_ptr<const Layout> m_layout;
+
+    /// Number of occurrences of each tile in the bag, by position
+    unsigned m_counts[kMAX_TILES];
+
+    /// Fenwick trees of the counts for each kind of tiles (1-based)
+    unsigned m_trees[kNB_KINDS][kMAX_TILES + 1];
+
+    /// Total number of tiles in the bag, for each kind of tiles
+    unsigned m_nbTiles[kNB_KINDS];
+
+    /// Return the position of the given tile, or -1 if it is unknown
+    int getPosition(const Tile &iTile) const;
 
-    /// Total number of tiles in the bag
-    unsigned m_nbTiles;
+    /// Add iDelta to the count of the tile at the given position
+    void update(int iPos, int iDelta);
 
     /// Helper method, used by the various selectRandom*() methods
-    Tile selectRandomTile(unsigned total,
-                          bool onlyVowels, bool onlyConsonants) const;
+    Tile selectRandomTile(Random &ioRandom, Kind iKind) const;
 };
 
 #endif
@@ -0,0 +1,212 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2013 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#ifndef BINARY_FORMAT_H_
+#define BINARY_FORMAT_H_
+
+#include <string>
+#include <stdint.h>
+
+#include "game_exception.h"
+
+using std::string;
+
+
+/**
+ * Definitions shared by the binary game format (see BinaryWriter and
+ * BinaryReader) and the game archives (see GameArchive).
+ *
+ * All the integers are stored in little-endian order, whatever the
+ * endianness of the machine. The strings are stored in UTF-8, preceded
+ * by their length in bytes (on 16 bits).
+ *
+ * A game record has the following layout:
+ *  - header: magic (4 bytes), format version (16 bits), record flags
+ *    (16 bits, see RecordFlag)
+ *  - dictionary: number of words (32 bits), letters of the dictionary
+ *  - game: mode (8 bits), variants (8 bits), then if the kRANDOM_STATE
+ *    flag is set, the seed and the state of the random generator
+ *    (5 x 64 bits), then the number of players (8 bits),
+ *    and for each player: type (8 bits), level (8 bits),
+ *    table number (16 bits) and name
+ *  - turn index: number of turns (16 bits), then the offset of each turn
+ *    from the beginning of the record (32 bits)
+ *  - turns: number of commands (16 bits), then the commands, each one
+ *    starting with its tag (8 bits)
+ *
+ * The tiles are stored with their code (on 8 bits), the highest bit being
+ * set for jokers.
+ */
+namespace BinaryFormat
+{
+    /// Magic string at the beginning of a game record
+    static const char kGAME_MAGIC[] = "ELGB";
+    /// Magic string at the beginning of a game archive
+    static const char kARCHIVE_MAGIC[] = "ELGA";
+    static const unsigned kMAGIC_SIZE = 4;
+
+    /**
+     * Current version of the binary formats. Bump it when they become
+     * incompatible
+     */
+    static const uint16_t kCURRENT_VERSION = 1;
+
+    /// Flags of the record header
+    enum RecordFlag
+    {
+        /// The state of the random generator is saved
+        kRANDOM_STATE = 1,
+    };
+
+    /// Flag set on the tile codes for jokers
+    static const uint8_t kJOKER_FLAG = 0x80;
+
+    /// Command tags
+    enum CommandTag
+    {
+        kGAME_RACK = 1,
+        kPLAYER_RACK = 2,
+        kPLAYER_MOVE = 3,
+        kGAME_MOVE = 4,
+        kMASTER_MOVE = 5,
+        kTOPPING_MOVE = 6,
+        kPLAYER_EVENT = 7,
+    };
+
+    /// Move types
+    enum MoveType
+    {
+        kMOVE_VALID = 0,
+        kMOVE_INVALID = 1,
+        kMOVE_CHANGE = 2,
+        kMOVE_PASS = 3,
+        kMOVE_NONE = 4,
+    };
+
+    /// Append a value to a buffer, in little-endian order
+    inline void putU8(string &ioBuf, unsigned iVal)
+    {
+        ioBuf += (char)(iVal & 0xFF);
+    }
+
+    inline void putU16(string &ioBuf, unsigned iVal)
+    {
+        putU8(ioBuf, iVal);
+        putU8(ioBuf, iVal >> 8);
+    }
+
+    inline void putU32(string &ioBuf, uint32_t iVal)
+    {
+        putU16(ioBuf, iVal & 0xFFFF);
+        putU16(ioBuf, iVal >> 16);
+    }
+
+    inline void putU64(string &ioBuf, uint64_t iVal)
+    {
+        putU32(ioBuf, (uint32_t)(iVal & 0xFFFFFFFF));
+        putU32(ioBuf, (uint32_t)(iVal >> 32));
+    }
+
+    inline void putString(string &ioBuf, const string &iStr)
+    {
+        if (iStr.size() > 0xFFFF)
+            throw SaveGameException("String too long for the binary format");
+        putU16(ioBuf, iStr.size());
+        ioBuf += iStr;
+    }
+
+    /// Overwrite a 32 bits value previously appended to a buffer
+    inline void patchU32(string &ioBuf, size_t iPos, uint32_t iVal)
+    {
+        string tmp;
+        putU32(tmp, iVal);
+        ioBuf.replace(iPos, tmp.size(), tmp);
+    }
+
+    /**
+     * Cursor used to read the values stored in a buffer.
+     * Reading past the end of the buffer throws a LoadGameException.
+     */
+    class Input
+    {
+    public:
+        Input(const string &iBuf, size_t iPos = 0)
+            : m_buf(iBuf), m_pos(iPos) {}
+
+        size_t getPos() const { return m_pos; }
+        void setPos(size_t iPos)
+        {
+            if (iPos > m_buf.size())
+                throw LoadGameException("Invalid offset in binary game");
+            m_pos = iPos;
+        }
+
+        unsigned getU8()
+        {
+            check(1);
+            return (unsigned char)m_buf[m_pos++];
+        }
+
+        unsigned getU16()
+        {
+            unsigned low = getU8();
+            return low | (getU8() << 8);
+        }
+
+        uint32_t getU32()
+        {
+            uint32_t low = getU16();
+            return low | ((uint32_t)getU16() << 16);
+        }
+
+        uint64_t getU64()
+        {
+            uint64_t low = getU32();
+            return low | ((uint64_t)getU32() << 32);
+        }
+
+        string getString()
+        {
+            unsigned size = getU16();
+            return getBytes(size);
+        }
+
+        string getBytes(size_t iSize)
+        {
+            check(iSize);
+            string s = m_buf.substr(m_pos, iSize);
+            m_pos += iSize;
+            return s;
+        }
+
+    private:
+        const string &m_buf;
+        size_t m_pos;
+
+        void check(size_t iSize) const
+        {
+            if (m_pos + iSize > m_buf.size())
+                throw LoadGameException("Truncated binary game");
+        }
+    };
+}
+
+#endif
+
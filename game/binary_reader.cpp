@@ -0,0 +1,455 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2013 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#include <fstream>
+#include <sstream>
+#include <boost/foreach.hpp>
+#include <boost/format.hpp>
+
+#include "config.h"
+#if ENABLE_NLS
+#   include <libintl.h>
+#   define _(String) gettext(String)
+#else
+#   define _(String) String
+#endif
+
+#include "binary_reader.h"
+#include "dic.h"
+#include "header.h"
+#include "encoding.h"
+#include "game_exception.h"
+#include "game_factory.h"
+#include "game.h"
+#include "board.h"
+#include "duplicate.h"
+#include "player.h"
+#include "ai_percent.h"
+#include "navigation.h"
+#include "cmd/game_rack_cmd.h"
+#include "cmd/game_move_cmd.h"
+#include "cmd/player_rack_cmd.h"
+#include "cmd/player_move_cmd.h"
+#include "cmd/player_event_cmd.h"
+#include "cmd/master_move_cmd.h"
+#include "cmd/topping_move_cmd.h"
+
+#define FMT1(s, a1) (boost::format(s) % (a1)).str()
+#define FMT2(s, a1, a2) (boost::format(s) % (a1) % (a2)).str()
+
+
+using namespace std;
+using namespace BinaryFormat;
+
+INIT_LOGGER(game, BinaryReader);
+
+
+static wstring fromUtf8(const string &str)
+{
+    return readFromUTF8(str, "Loading game");
+}
+
+
+BinaryReader::BinaryReader(const string &iData, const Dictionary &iDic)
+    : m_data(iData), m_dic(iDic)
+{
+    Input in(m_data);
+
+    // Header
+    if (in.getBytes(kMAGIC_SIZE) != string(kGAME_MAGIC, kMAGIC_SIZE))
+        throw LoadGameException(_("Not a binary saved game"));
+    unsigned version = in.getU16();
+    if (version != kCURRENT_VERSION)
+    {
+        LOG_ERROR("Incompatible binary game format: current="
+                  << kCURRENT_VERSION << " savegame=" << version);
+        throw LoadGameException(_("This saved game is not compatible with the current version of Eliot."));
+    }
+    unsigned flags = in.getU16();
+
+    // Dictionary
+    const Header &header = m_dic.getHeader();
+    unsigned nbWords = in.getU32();
+    const wstring &letters = fromUtf8(in.getString());
+    if (nbWords != header.getNbWords() || letters != header.getLetters())
+        throw LoadGameException(_("The current dictionary is different from the one used in the saved game"));
+
+    // Game
+    unsigned mode = in.getU8();
+    if (mode > GameParams::kTOPPING)
+        throw LoadGameException(FMT1(_("Invalid game mode: %1%"), mode));
+    m_mode = (GameParams::GameMode)mode;
+    m_variants = in.getU8();
+
+    // Random generator
+    m_hasRandomState = (flags & kRANDOM_STATE) != 0;
+    m_randomSeed = 0;
+    for (unsigned i = 0; i < Random::kSTATE_SIZE; ++i)
+        m_randomState[i] = 0;
+    if (m_hasRandomState)
+    {
+        m_randomSeed = in.getU64();
+        for (unsigned i = 0; i < Random::kSTATE_SIZE; ++i)
+            m_randomState[i] = in.getU64();
+    }
+
+    // Players
+    unsigned nbPlayers = in.getU8();
+    for (unsigned i = 0; i < nbPlayers; ++i)
+    {
+        PlayerInfo info;
+        info.isHuman = in.getU8() == 0;
+        info.level = in.getU8();
+        info.tableNb = in.getU16();
+        info.name = fromUtf8(in.getString());
+        m_players.push_back(info);
+    }
+
+    // Turn index
+    unsigned nbTurns = in.getU16();
+    m_turnOffsets.reserve(nbTurns);
+    for (unsigned i = 0; i < nbTurns; ++i)
+    {
+        uint32_t offset = in.getU32();
+        if (offset >= m_data.size())
+            throw LoadGameException(_("Invalid offset in binary game"));
+        m_turnOffsets.push_back(offset);
+    }
+}
+
+
+Game * BinaryReader::read(const string &iFileName, const Dictionary &iDic)
+{
+    LOG_INFO("Reading binary savegame '" << iFileName << "'");
+
+    ifstream is(iFileName.c_str(), ios::in | ios::binary);
+    if (!is.is_open())
+        throw LoadGameException(FMT1(_("Cannot open file '%1%'"), iFileName));
+    ostringstream oss;
+    oss << is.rdbuf();
+    const string &data = oss.str();
+
+    BinaryReader reader(data, iDic);
+    Game *game = reader.buildGame();
+
+    LOG_INFO("Binary savegame read successfully");
+    return game;
+}
+
+
+bool BinaryReader::IsBinaryFile(const string &iFileName)
+{
+    ifstream is(iFileName.c_str(), ios::in | ios::binary);
+    char magic[kMAGIC_SIZE];
+    if (!is.read(magic, kMAGIC_SIZE))
+        return false;
+    return string(magic, kMAGIC_SIZE) == string(kGAME_MAGIC, kMAGIC_SIZE);
+}
+
+
+Game * BinaryReader::buildGame() const
+{
+    GameParams params(m_dic, m_mode);
+    if (m_variants & GameParams::kJOKER)
+        params.addVariant(GameParams::kJOKER);
+    if (m_variants & GameParams::kEXPLOSIVE)
+        params.addVariant(GameParams::kEXPLOSIVE);
+    if (m_variants & GameParams::k7AMONG8)
+        params.addVariant(GameParams::k7AMONG8);
+
+    Game *game = GameFactory::Instance()->createGame(params);
+    try
+    {
+        if (m_hasRandomState)
+            game->accessRandom().setState(m_randomSeed, m_randomState);
+
+        // The moves are replayed without updating the cross checks
+        // after each of them
+        game->accessBoard().beginBulkLoad(m_dic);
+
+        BOOST_FOREACH(const PlayerInfo &info, m_players)
+        {
+            Player *p;
+            if (info.isHuman)
+                p = new HumanPlayer();
+            else
+                p = new AIPercent(0.01 * info.level);
+            p->setName(info.name);
+            p->setTableNb(info.tableNb);
+            game->addPlayer(p);
+        }
+
+        Navigation &navigation = game->accessNavigation();
+        vector<TurnCommand> commands;
+        for (unsigned i = 0; i < getNbTurns(); ++i)
+        {
+            if (i > 0)
+                navigation.newTurn();
+
+            readTurn(i, commands);
+            BOOST_FOREACH(const TurnCommand &tc, commands)
+            {
+                if (tc.tag != kGAME_RACK && tc.tag != kGAME_MOVE &&
+                    tc.tag != kMASTER_MOVE && tc.playerId >= m_players.size())
+                {
+                    throw LoadGameException(FMT1(_("Invalid player ID: %1%"), tc.playerId));
+                }
+                if (tc.tag != kGAME_MOVE)
+                    checkMove(game->getBoard(), tc.move, false);
+
+                Command *cmd = NULL;
+                if (tc.tag == kGAME_RACK)
+                    cmd = new GameRackCmd(*game, tc.rack);
+                else if (tc.tag == kPLAYER_RACK)
+                    cmd = new PlayerRackCmd(game->accessPlayer(tc.playerId), tc.rack);
+                else if (tc.tag == kPLAYER_MOVE)
+                {
+                    // FIXME: this is game-related logic. It should not be done here.
+                    bool isArbitrationGame = m_mode == GameParams::kARBITRATION;
+                    cmd = new PlayerMoveCmd(game->accessPlayer(tc.playerId),
+                                            tc.move, isArbitrationGame);
+                }
+                else if (tc.tag == kGAME_MOVE)
+                {
+                    // The move is added to the board
+                    checkMove(game->getBoard(), tc.move, true);
+                    cmd = new GameMoveCmd(*game, tc.move);
+                }
+                else if (tc.tag == kMASTER_MOVE)
+                {
+                    Duplicate *duplicateGame = dynamic_cast<Duplicate*>(game);
+                    if (duplicateGame == NULL)
+                        throw LoadGameException(_("Master moves should only be present for duplicate games"));
+                    cmd = new MasterMoveCmd(*duplicateGame, tc.move);
+                }
+                else if (tc.tag == kTOPPING_MOVE)
+                    cmd = new ToppingMoveCmd(tc.playerId, tc.move, tc.elapsed);
+                else
+                {
+                    cmd = new PlayerEventCmd(game->accessPlayer(tc.playerId),
+                                             (PlayerEventCmd::EventType)tc.eventType,
+                                             tc.points);
+                }
+                navigation.addAndExecute(cmd);
+            }
+        }
+
+        // Build the cross checks for the final position
+        game->accessBoard().endBulkLoad();
+    }
+    catch (...)
+    {
+        delete game;
+        throw;
+    }
+
+    return game;
+}
+
+
+void BinaryReader::readTurn(unsigned iTurn, vector<TurnCommand> &oCommands) const
+{
+    if (iTurn >= getNbTurns())
+        throw LoadGameException(FMT1(_("Invalid turn number: %1%"), iTurn));
+
+    oCommands.clear();
+    Input in(m_data, m_turnOffsets[iTurn]);
+    unsigned nbCommands = in.getU16();
+    for (unsigned i = 0; i < nbCommands; ++i)
+    {
+        TurnCommand tc;
+        tc.playerId = 0;
+        tc.eventType = 0;
+        tc.points = 0;
+        tc.elapsed = 0;
+        unsigned tag = in.getU8();
+        switch (tag)
+        {
+            case kGAME_RACK:
+                tc.rack = readRack(in);
+                break;
+            case kPLAYER_RACK:
+                tc.playerId = in.getU8();
+                tc.rack = readRack(in);
+                break;
+            case kPLAYER_MOVE:
+                tc.playerId = in.getU8();
+                tc.move = readMove(in);
+                break;
+            case kGAME_MOVE:
+            case kMASTER_MOVE:
+                tc.move = readMove(in);
+                break;
+            case kTOPPING_MOVE:
+                tc.playerId = in.getU8();
+                tc.elapsed = (int32_t)in.getU32();
+                tc.move = readMove(in);
+                break;
+            case kPLAYER_EVENT:
+                tc.playerId = in.getU8();
+                tc.eventType = in.getU8();
+                if (tc.eventType > PlayerEventCmd::END_GAME)
+                    throw LoadGameException(FMT1(_("Invalid event type: %1%"), tc.eventType));
+                tc.points = (int32_t)in.getU32();
+                break;
+            default:
+                throw LoadGameException(FMT1(_("Unsupported command: %1%"), tag));
+        }
+        tc.tag = (CommandTag)tag;
+        oCommands.push_back(tc);
+    }
+}
+
+
+void BinaryReader::checkMove(const Board &iBoard, const Move &iMove,
+                             bool iAddedToBoard) const
+{
+    if (!iMove.isValid())
+        return;
+
+    const Round &round = iMove.getRound();
+    const Coord &coord = round.getCoord();
+    int row = coord.getRow();
+    int col = coord.getCol();
+    for (unsigned i = 0; i < round.getWordLen(); ++i)
+    {
+        if (!round.isPlayedFromRack(i))
+        {
+            // The letter must already be on the board
+            if (iBoard.isVacant(row, col) ||
+                iBoard.getTile(row, col).toCode() != round.getTile(i).toCode())
+            {
+                throw LoadGameException(FMT2(_("Move not matching the board in binary game: %1% (%2%)"),
+                                             lfw(round.getWord()), lfw(coord.toString())));
+            }
+        }
+        else if (iAddedToBoard && !iBoard.isVacant(row, col))
+        {
+            throw LoadGameException(FMT2(_("Move overwriting a tile in binary game: %1% (%2%)"),
+                                         lfw(round.getWord()), lfw(coord.toString())));
+        }
+        if (coord.getDir() == Coord::HORIZONTAL)
+            ++col;
+        else
+            ++row;
+    }
+}
+
+
+Tile BinaryReader::readTile(Input &ioInput) const
+{
+    unsigned value = ioInput.getU8();
+    unsigned code = value & ~kJOKER_FLAG;
+    if (code == 0 || code > m_dic.getHeader().getLetters().size())
+        throw LoadGameException(FMT1(_("Invalid tile code: %1%"), code));
+    return Tile(code, value & kJOKER_FLAG);
+}
+
+
+void BinaryReader::readTiles(Input &ioInput, vector<Tile> &oTiles) const
+{
+    oTiles.clear();
+    unsigned nbTiles = ioInput.getU8();
+    for (unsigned i = 0; i < nbTiles; ++i)
+        oTiles.push_back(readTile(ioInput));
+}
+
+
+PlayedRack BinaryReader::readRack(Input &ioInput) const
+{
+    PlayedRack pldrack;
+    pldrack.setReject(ioInput.getU8() != 0);
+    vector<Tile> tiles;
+    readTiles(ioInput, tiles);
+    BOOST_FOREACH(const Tile &tile, tiles)
+    {
+        pldrack.addOld(tile);
+    }
+    readTiles(ioInput, tiles);
+    BOOST_FOREACH(const Tile &tile, tiles)
+    {
+        pldrack.addNew(tile);
+    }
+    return pldrack;
+}
+
+
+Move BinaryReader::readMove(Input &ioInput) const
+{
+    unsigned type = ioInput.getU8();
+    int score = (int32_t)ioInput.getU32();
+    if (type == kMOVE_VALID)
+    {
+        // The round is rebuilt directly: since it was valid when
+        // the game was saved, there is no need to check it again.
+        // Only its consistency is checked (see also checkMove()),
+        // to avoid corrupting the board with a damaged file
+        Round round;
+        unsigned row = ioInput.getU8();
+        unsigned col = ioInput.getU8();
+        Coord::Direction dir = ioInput.getU8() ? Coord::VERTICAL : Coord::HORIZONTAL;
+        round.accessCoord() = Coord(row, col, dir);
+        if (!round.getCoord().isValid())
+            throw LoadGameException(_("Invalid coordinates in binary game"));
+        round.setBonus(ioInput.getU8() != 0);
+        unsigned len = ioInput.getU8();
+        if (len == 0 || len > Round::kMAX_LENGTH)
+            throw LoadGameException(_("Invalid word length in binary game"));
+        unsigned start = dir == Coord::HORIZONTAL ? col : row;
+        if (start + len - 1 > BOARD_DIM)
+            throw LoadGameException(_("Word going out of the board in binary game"));
+        vector<Tile> tiles;
+        for (unsigned i = 0; i < len; ++i)
+            tiles.push_back(readTile(ioInput));
+        round.setWord(tiles);
+        uint32_t fromRack = ioInput.getU32();
+        for (unsigned i = 0; i < len; ++i)
+        {
+            if (!(fromRack & (1u << i)))
+                round.setFromBoard(i);
+        }
+        round.setPoints(score);
+        return Move(round);
+    }
+    else if (type == kMOVE_INVALID)
+    {
+        const wstring &word = fromUtf8(ioInput.getString());
+        const wstring &coord = fromUtf8(ioInput.getString());
+        return Move(word, coord);
+    }
+    else if (type == kMOVE_CHANGE)
+    {
+        vector<Tile> tiles;
+        readTiles(ioInput, tiles);
+        wstring letters;
+        BOOST_FOREACH(const Tile &tile, tiles)
+        {
+            letters += tile.toChar();
+        }
+        return Move(letters);
+    }
+    else if (type == kMOVE_PASS)
+        return Move(L"");
+    else if (type == kMOVE_NONE)
+        return Move(score);
+    else
+        throw LoadGameException(FMT1(_("Invalid move type: %1%"), type));
+}
+
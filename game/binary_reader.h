@@ -0,0 +1,142 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2013 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#ifndef BINARY_READER_H_
+#define BINARY_READER_H_
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "binary_format.h"
+#include "game_params.h"
+#include "pldrack.h"
+#include "move.h"
+#include "random.h"
+#include "logging.h"
+
+class Dictionary;
+class Game;
+class Board;
+
+using std::string;
+using std::wstring;
+using std::vector;
+
+
+/**
+ * Read a game record in the binary format (see binary_format.h and
+ * BinaryWriter).
+ *
+ * Besides rebuilding the whole game (like XmlReader does), this class
+ * gives a direct access to the players and to the commands of any turn,
+ * thanks to the turn index of the record. This allows gathering
+ * statistics on a game without replaying it.
+ *
+ * The methods throw a LoadGameException in case of problem.
+ */
+class BinaryReader
+{
+    DEFINE_LOGGER();
+public:
+    struct PlayerInfo
+    {
+        bool isHuman;
+        /// Level of the AI player, in percents
+        unsigned level;
+        unsigned tableNb;
+        wstring name;
+    };
+
+    /// Decoded command
+    struct TurnCommand
+    {
+        BinaryFormat::CommandTag tag;
+        /// Player ID (for player commands and topping moves)
+        unsigned playerId;
+        /// Rack (for kGAME_RACK and kPLAYER_RACK)
+        PlayedRack rack;
+        /// Move (for the kXXX_MOVE commands)
+        Move move;
+        /// Event type, as a PlayerEventCmd::EventType (for kPLAYER_EVENT)
+        int eventType;
+        /// Event points (for kPLAYER_EVENT)
+        int points;
+        /// Elapsed time (for kTOPPING_MOVE)
+        int elapsed;
+    };
+
+    /**
+     * Parse the header and the turn index of the given record.
+     * The record must have been written with the same dictionary,
+     * and it must outlive the reader.
+     */
+    BinaryReader(const string &iData, const Dictionary &iDic);
+
+    /**
+     * Create a Game object, from a file created using the BinaryWriter class
+     */
+    static Game * read(const string &iFileName, const Dictionary &iDic);
+
+    /// Return true if the given file looks like a binary game
+    static bool IsBinaryFile(const string &iFileName);
+
+    /// Replay all the turns and return the built game
+    Game * buildGame() const;
+
+    GameParams::GameMode getMode() const { return m_mode; }
+    unsigned getVariants() const { return m_variants; }
+    /// Return true if the state of the random generator is saved
+    bool hasRandomState() const { return m_hasRandomState; }
+    const vector<PlayerInfo> & getPlayers() const { return m_players; }
+
+    unsigned getNbTurns() const { return m_turnOffsets.size(); }
+
+    /// Decode the commands of the given turn (starting from 0)
+    void readTurn(unsigned iTurn, vector<TurnCommand> &oCommands) const;
+
+private:
+    const string &m_data;
+    const Dictionary &m_dic;
+
+    GameParams::GameMode m_mode;
+    unsigned m_variants;
+    bool m_hasRandomState;
+    uint64_t m_randomSeed;
+    uint64_t m_randomState[Random::kSTATE_SIZE];
+    vector<PlayerInfo> m_players;
+    vector<uint32_t> m_turnOffsets;
+
+    Tile readTile(BinaryFormat::Input &ioInput) const;
+    void readTiles(BinaryFormat::Input &ioInput, vector<Tile> &oTiles) const;
+    PlayedRack readRack(BinaryFormat::Input &ioInput) const;
+    Move readMove(BinaryFormat::Input &ioInput) const;
+
+    /**
+     * Check that the letters of a valid move taken from the board match
+     * the board. If iAddedToBoard is true, the move is about to be added
+     * to the board, so its other letters must be on empty squares
+     */
+    void checkMove(const Board &iBoard, const Move &iMove,
+                   bool iAddedToBoard) const;
+};
+
+#endif
+
@@ -0,0 +1,305 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2013 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#include <vector>
+#include <fstream>
+#include <cmath>
+#include <boost/foreach.hpp>
+#include <boost/format.hpp>
+
+#include "config.h"
+#if ENABLE_NLS
+#   include <libintl.h>
+#   define _(String) gettext(String)
+#else
+#   define _(String) String
+#endif
+
+#include "binary_writer.h"
+#include "binary_format.h"
+#include "encoding.h"
+#include "turn.h"
+#include "game_params.h"
+#include "game.h"
+#include "random.h"
+#include "player.h"
+#include "ai_percent.h"
+#include "game_exception.h"
+#include "cmd/game_rack_cmd.h"
+#include "cmd/game_move_cmd.h"
+#include "cmd/player_rack_cmd.h"
+#include "cmd/player_move_cmd.h"
+#include "cmd/player_event_cmd.h"
+#include "cmd/master_move_cmd.h"
+#include "cmd/topping_move_cmd.h"
+#include "dic.h"
+#include "header.h"
+
+#define FMT1(s, a1) (boost::format(s) % (a1)).str()
+
+
+using namespace std;
+using namespace BinaryFormat;
+
+INIT_LOGGER(game, BinaryWriter);
+
+
+static string toUtf8(const wstring &s)
+{
+    return writeInUTF8(s, "Saving game");
+}
+
+static void writeTile(string &ioBuf, const Tile &iTile)
+{
+    putU8(ioBuf, iTile.toCode() | (iTile.isJoker() ? kJOKER_FLAG : 0));
+}
+
+static void writeTiles(string &ioBuf, const vector<Tile> &iTiles)
+{
+    putU8(ioBuf, iTiles.size());
+    BOOST_FOREACH(const Tile &tile, iTiles)
+    {
+        writeTile(ioBuf, tile);
+    }
+}
+
+static void writeRack(string &ioBuf, const PlayedRack &iRack)
+{
+    putU8(ioBuf, iRack.isReject() ? 1 : 0);
+    vector<Tile> tiles;
+    iRack.getOldTiles(tiles);
+    writeTiles(ioBuf, tiles);
+    iRack.getNewTiles(tiles);
+    writeTiles(ioBuf, tiles);
+}
+
+static void writeMove(string &ioBuf, const Move &iMove)
+{
+    if (iMove.isValid())
+    {
+        const Round &round = iMove.getRound();
+        putU8(ioBuf, kMOVE_VALID);
+        putU32(ioBuf, iMove.getScore());
+        const Coord &coord = round.getCoord();
+        putU8(ioBuf, coord.getRow());
+        putU8(ioBuf, coord.getCol());
+        putU8(ioBuf, coord.getDir() == Coord::VERTICAL ? 1 : 0);
+        putU8(ioBuf, round.getBonus() ? 1 : 0);
+        putU8(ioBuf, round.getWordLen());
+        uint32_t fromRack = 0;
+        for (unsigned int i = 0; i < round.getWordLen(); ++i)
+        {
+            writeTile(ioBuf, round.getTile(i));
+            if (round.isPlayedFromRack(i))
+                fromRack |= 1u << i;
+        }
+        putU32(ioBuf, fromRack);
+    }
+    else if (iMove.isInvalid())
+    {
+        putU8(ioBuf, kMOVE_INVALID);
+        putU32(ioBuf, iMove.getScore());
+        putString(ioBuf, toUtf8(iMove.getBadWord()));
+        putString(ioBuf, toUtf8(iMove.getBadCoord()));
+    }
+    else if (iMove.isChangeLetters())
+    {
+        putU8(ioBuf, kMOVE_CHANGE);
+        putU32(ioBuf, iMove.getScore());
+        vector<Tile> tiles;
+        BOOST_FOREACH(wchar_t ch, iMove.getChangedLetters())
+        {
+            tiles.push_back(Tile(ch));
+        }
+        writeTiles(ioBuf, tiles);
+    }
+    else if (iMove.isPass())
+    {
+        putU8(ioBuf, kMOVE_PASS);
+        putU32(ioBuf, iMove.getScore());
+    }
+    else if (iMove.isNull())
+    {
+        putU8(ioBuf, kMOVE_NONE);
+        putU32(ioBuf, iMove.getScore());
+    }
+    else
+        throw SaveGameException(FMT1(_("Unsupported move: %1%"), lfw(iMove.toString())));
+}
+
+
+/// Write the command, and return false if it is not supported
+static bool writeCommand(string &ioBuf, const Command *iCmd)
+{
+    if (dynamic_cast<const GameRackCmd*>(iCmd))
+    {
+        const GameRackCmd *rackCmd = static_cast<const GameRackCmd*>(iCmd);
+        putU8(ioBuf, kGAME_RACK);
+        writeRack(ioBuf, rackCmd->getRack());
+    }
+    else if (dynamic_cast<const PlayerRackCmd*>(iCmd))
+    {
+        const PlayerRackCmd *rackCmd = static_cast<const PlayerRackCmd*>(iCmd);
+        putU8(ioBuf, kPLAYER_RACK);
+        putU8(ioBuf, rackCmd->getPlayer().getId());
+        writeRack(ioBuf, rackCmd->getRack());
+    }
+    else if (dynamic_cast<const PlayerMoveCmd*>(iCmd))
+    {
+        const PlayerMoveCmd *moveCmd = static_cast<const PlayerMoveCmd*>(iCmd);
+        putU8(ioBuf, kPLAYER_MOVE);
+        putU8(ioBuf, moveCmd->getPlayer().getId());
+        writeMove(ioBuf, moveCmd->getMove());
+    }
+    else if (dynamic_cast<const GameMoveCmd*>(iCmd))
+    {
+        const GameMoveCmd *moveCmd = static_cast<const GameMoveCmd*>(iCmd);
+        putU8(ioBuf, kGAME_MOVE);
+        writeMove(ioBuf, moveCmd->getMove());
+    }
+    else if (dynamic_cast<const MasterMoveCmd*>(iCmd))
+    {
+        const MasterMoveCmd *moveCmd = static_cast<const MasterMoveCmd*>(iCmd);
+        putU8(ioBuf, kMASTER_MOVE);
+        writeMove(ioBuf, moveCmd->getMove());
+    }
+    else if (dynamic_cast<const ToppingMoveCmd*>(iCmd))
+    {
+        const ToppingMoveCmd *moveCmd = static_cast<const ToppingMoveCmd*>(iCmd);
+        putU8(ioBuf, kTOPPING_MOVE);
+        putU8(ioBuf, moveCmd->getPlayerId());
+        putU32(ioBuf, moveCmd->getElapsedTime());
+        writeMove(ioBuf, moveCmd->getMove());
+    }
+    else if (dynamic_cast<const PlayerEventCmd*>(iCmd))
+    {
+        const PlayerEventCmd *eventCmd = static_cast<const PlayerEventCmd*>(iCmd);
+        putU8(ioBuf, kPLAYER_EVENT);
+        putU8(ioBuf, eventCmd->getPlayer().getId());
+        putU8(ioBuf, eventCmd->getEventType());
+        putU32(ioBuf, eventCmd->getPoints());
+    }
+    else
+    {
+        LOG_ERROR("Unsupported command: " << lfw(iCmd->toString()));
+        return false;
+    }
+    return true;
+}
+
+
+void BinaryWriter::write(const Game &iGame, const string &iFileName)
+{
+    LOG_INFO("Saving game into '" << iFileName << "' (binary format)");
+    ofstream out(iFileName.c_str(), ios::out | ios::binary);
+    if (!out.is_open())
+        throw SaveGameException(FMT1(_("Cannot open file for writing: '%1%'"), iFileName));
+
+    const string &data = encode(iGame);
+    out.write(data.data(), data.size());
+    if (!out.good())
+        throw SaveGameException(FMT1(_("Error while writing file '%1%'"), iFileName));
+}
+
+
+string BinaryWriter::encode(const Game &iGame)
+{
+    string buf;
+
+    // Header
+    const Random &random = iGame.getRandom();
+    buf.append(kGAME_MAGIC, kMAGIC_SIZE);
+    putU16(buf, kCURRENT_VERSION);
+    putU16(buf, random.isLegacy() ? 0 : kRANDOM_STATE);
+
+    // Dictionary information
+    const Header &header = iGame.getDic().getHeader();
+    putU32(buf, header.getNbWords());
+    putString(buf, toUtf8(header.getLetters()));
+
+    // Game information
+    putU8(buf, iGame.getMode());
+    unsigned variants = 0;
+    if (iGame.getParams().hasVariant(GameParams::kJOKER))
+        variants |= GameParams::kJOKER;
+    if (iGame.getParams().hasVariant(GameParams::kEXPLOSIVE))
+        variants |= GameParams::kEXPLOSIVE;
+    if (iGame.getParams().hasVariant(GameParams::k7AMONG8))
+        variants |= GameParams::k7AMONG8;
+    putU8(buf, variants);
+
+    // Random generator (the state of rand() cannot be saved)
+    if (!random.isLegacy())
+    {
+        putU64(buf, random.getSeed());
+        for (unsigned i = 0; i < Random::kSTATE_SIZE; ++i)
+            putU64(buf, random.getState(i));
+    }
+
+    // Players
+    putU8(buf, iGame.getNPlayers());
+    for (unsigned int i = 0; i < iGame.getNPlayers(); ++i)
+    {
+        const Player &player = iGame.getPlayer(i);
+        putU8(buf, player.isHuman() ? 0 : 1);
+        unsigned level = 0;
+        if (!player.isHuman())
+        {
+            const AIPercent *ai = dynamic_cast<const AIPercent *>(&player);
+            if (ai == NULL)
+                throw SaveGameException(FMT1(_("Invalid player type for player %1%"), i));
+            level = lrint(ai->getPercent() * 100);
+        }
+        putU8(buf, level);
+        putU16(buf, player.getTableNb());
+        putString(buf, toUtf8(player.getName()));
+    }
+
+    // Turn index. Like in the XML format, the last turn is
+    // not saved if it is empty
+    const vector<Turn *> &turnVect = iGame.getNavigation().getTurns();
+    unsigned nbTurns = turnVect.size();
+    if (nbTurns > 0 && turnVect.back()->getCommands().empty())
+        --nbTurns;
+    putU16(buf, nbTurns);
+    const size_t indexPos = buf.size();
+    for (unsigned i = 0; i < nbTurns; ++i)
+        putU32(buf, 0);
+
+    // Turns
+    for (unsigned i = 0; i < nbTurns; ++i)
+    {
+        patchU32(buf, indexPos + 4 * i, buf.size());
+
+        const size_t countPos = buf.size();
+        putU16(buf, 0);
+        unsigned nbCommands = 0;
+        BOOST_FOREACH(const Command *cmd, turnVect[i]->getCommands())
+        {
+            if (writeCommand(buf, cmd))
+                ++nbCommands;
+        }
+        buf[countPos] = (char)(nbCommands & 0xFF);
+        buf[countPos + 1] = (char)(nbCommands >> 8);
+    }
+
+    return buf;
+}
+
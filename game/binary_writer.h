@@ -0,0 +1,49 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2013 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#ifndef BINARY_WRITER_H_
+#define BINARY_WRITER_H_
+
+#include <string>
+#include "logging.h"
+
+class Game;
+
+using std::string;
+
+
+/**
+ * Save a game in the compact binary format described in binary_format.h.
+ * It contains the same information as the XML format (except for the
+ * statistics), and can be loaded with the BinaryReader class.
+ */
+class BinaryWriter
+{
+    DEFINE_LOGGER();
+public:
+    /// Save the game into the given file
+    static void write(const Game &iGame, const string &iFileName);
+
+    /// Return the game record, without writing it anywhere
+    static string encode(const Game &iGame);
+};
+
+#endif
+
@@ -21,6 +21,10 @@
 
 #include <cwctype>
 #include <cstdio>
+#include <algorithm>
+#include <boost/foreach.hpp>
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
 
 #include "dic.h"
 
@@ -33,26 +37,28 @@
 #include "rack.h"
 #include "results.h"
 #include "encoding.h"
+#include "settings.h"
+#include "thread_pool.h"
 #include "debug.h"
 
-#define BOARD_REALDIM (BOARD_DIM + 2)
-
 
 INIT_LOGGER(game, Board);
 
 
 Board::Board(const GameParams &iParams):
     m_params(iParams), m_layout(iParams.getBoardLayout()),
-    m_tilesRow(BOARD_REALDIM, Tile()),
-    m_tilesCol(BOARD_REALDIM, Tile()),
-    m_jokerRow(BOARD_REALDIM, false),
-    m_jokerCol(BOARD_REALDIM, false),
-    m_crossRow(BOARD_REALDIM, Cross()),
-    m_crossCol(BOARD_REALDIM, Cross()),
-    m_pointRow(BOARD_REALDIM, -1),
-    m_pointCol(BOARD_REALDIM, -1),
-    m_testsRow(BOARD_REALDIM, Tile()),
-    m_isEmpty(true)
+    m_tilesRow(Tile()),
+    m_tilesCol(Tile()),
+    m_jokerRow(false),
+    m_jokerCol(false),
+    m_crossRow(Cross()),
+    m_crossCol(Cross()),
+    m_pointRow(-1),
+    m_pointCol(-1),
+    m_testsRow(Tile()),
+    m_isEmpty(true),
+    m_hash(0),
+    m_bulkDic(NULL)
 {
     // No cross check allowed around the board
     for (int i = 0; i < BOARD_REALDIM; i++)
@@ -99,6 +105,25 @@ bool Board::isVacant(int iRow, int iCol) const
 }
 
 
+namespace
+{
+    /**
+     * Return the Zobrist key of the given tile on the given square.
+     * Instead of storing a table of random numbers, the keys are computed
+     * with the SplitMix64 mixing function, which gives well distributed
+     * values for consecutive inputs.
+     */
+    uint64_t GetSquareKey(int iRow, int iCol, const Tile &iTile, bool iJoker)
+    {
+        uint64_t z = ((iRow * BOARD_REALDIM + iCol) * 64 + iTile.toCode()) * 2 + iJoker;
+        z += 0x9E3779B97F4A7C15ULL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+}
+
+
 void Board::addRound(const Dictionary &iDic, const Round &iRound)
 {
     int row = iRound.getCoord().getRow();
@@ -111,6 +136,7 @@ void Board::addRound(const Dictionary &iDic, const Round &iRound)
             if (isVacant(row, col + i))
             {
                 ASSERT(iRound.isPlayedFromRack(i), "Invalid round (1)");
+                m_hash ^= GetSquareKey(row, col + i, t, iRound.isJoker(i));
                 m_tilesRow[row][col + i] = t;
                 m_jokerRow[row][col + i] = iRound.isJoker(i);
                 m_tilesCol[col + i][row] = t;
@@ -131,6 +157,7 @@ void Board::addRound(const Dictionary &iDic, const Round &iRound)
             if (isVacant(row + i, col))
             {
                 ASSERT(iRound.isPlayedFromRack(i), "Invalid round (1)");
+                m_hash ^= GetSquareKey(row + i, col, t, iRound.isJoker(i));
                 m_tilesRow[row + i][col] = t;
                 m_jokerRow[row + i][col] = iRound.isJoker(i);
                 m_tilesCol[col][row + i] = t;
@@ -143,12 +170,15 @@ void Board::addRound(const Dictionary &iDic, const Round &iRound)
             }
         }
     }
-    buildCross(iDic);
+    // During a bulk load, the cross checks are built at the end only
+    if (m_bulkDic == NULL)
+        updateCross(iDic, iRound);
 #ifdef DEBUG
     checkDouble();
 #endif
 
     removeTestRound();
+    m_searchCache.clear();
 
     m_isEmpty = false;
 }
@@ -169,6 +199,8 @@ void Board::removeRound(const Dictionary &iDic, const Round &iRound)
             {
                 ASSERT(iRound.isJoker(i) == m_jokerRow[row][col + i],
                        "Invalid round removal");
+                m_hash ^= GetSquareKey(row, col + i, m_tilesRow[row][col + i],
+                                       m_jokerRow[row][col + i]);
                 m_tilesRow[row][col + i] = Tile();
                 m_jokerRow[row][col + i] = false;
                 m_tilesCol[col + i][row] = Tile();
@@ -186,6 +218,8 @@ void Board::removeRound(const Dictionary &iDic, const Round &iRound)
             {
                 ASSERT(iRound.isJoker(i) == m_jokerRow[row + i][col],
                        "Invalid round removal");
+                m_hash ^= GetSquareKey(row + i, col, m_tilesRow[row + i][col],
+                                       m_jokerRow[row + i][col]);
                 m_tilesRow[row + i][col] = Tile();
                 m_jokerRow[row + i][col] = false;
                 m_tilesCol[col][row + i] = Tile();
@@ -194,13 +228,16 @@ void Board::removeRound(const Dictionary &iDic, const Round &iRound)
         }
     }
 
-    // Rebuild all the cross checks, because they are now invalid
-    buildCross(iDic);
+    // Update the cross checks, because they are now invalid
+    // (during a bulk load, they are built at the end only)
+    if (m_bulkDic == NULL)
+        updateCross(iDic, iRound);
 #ifdef DEBUG
     checkDouble();
 #endif
 
     removeTestRound();
+    m_searchCache.clear();
 
     // Update the m_isEmpty flag
     for (int i = 1; i <= BOARD_DIM; i++)
@@ -217,10 +254,10 @@ void Board::removeRound(const Dictionary &iDic, const Round &iRound)
 
 /* XXX: There is duplicated code with board_search.c.
  * We could probably factorize something... */
-int Board::checkRoundAux(const Matrix<Tile> &iTilesMx,
-                         const Matrix<Cross> &iCrossMx,
-                         const Matrix<int> &iPointsMx,
-                         const Matrix<bool> &iJokerMx,
+int Board::checkRoundAux(const TileGrid &iTilesMx,
+                         const CrossGrid &iCrossMx,
+                         const IntGrid &iPointsMx,
+                         const BoolGrid &iJokerMx,
                          Round &iRound, bool checkJunction) const
 {
     bool isolated = true;
@@ -341,6 +378,9 @@ int Board::checkRoundAux(const Matrix<Tile> &iTilesMx,
 
 int Board::checkRound(Round &iRound, bool checkJunction) const
 {
+    if (m_bulkDic != NULL)
+        return checkRoundBulk(*m_bulkDic, iRound, checkJunction);
+
     if (iRound.getCoord().getDir() == Coord::HORIZONTAL)
     {
         return checkRoundAux(m_tilesRow, m_crossRow,
@@ -464,22 +504,84 @@ void Board::checkDouble()
 #endif
 
 
+namespace
+{
+    /**
+     * Results implementation keeping all the rounds, in the order they are
+     * added. It is used to fill the search cache, and as a per-thread
+     * buffer during a parallel search.
+     */
+    class RoundBuffer: public Results
+    {
+    public:
+        /**
+         * Use the filtering rules of the given results (see
+         * Results::createFilter()). The rounds ignored by the filter would
+         * also be ignored by iResults when replaying the buffer, because
+         * iResults will have seen at least the same rounds at that time.
+         */
+        void setFilter(const Results &iResults)
+        {
+            m_filter.reset(iResults.createFilter());
+        }
+
+        virtual void search(const Dictionary &, const Board &,
+                            const Rack &, bool)
+        {
+            ASSERT(false, "RoundBuffer cannot perform a search");
+        }
+        virtual void clear()
+        {
+            m_rounds.clear();
+            if (m_filter)
+                m_filter->clear();
+        }
+        virtual void add(const Round &iRound)
+        {
+            if (m_filter)
+            {
+                if (iRound.getPoints() < m_filter->getMinScore())
+                    return;
+                m_filter->add(iRound);
+            }
+            m_rounds.push_back(iRound);
+        }
+        virtual int getMinScore() const
+        {
+            return m_filter ? m_filter->getMinScore() : 0;
+        }
+        virtual Results * createFilter() const
+        {
+            return m_filter ? m_filter->createFilter() : NULL;
+        }
+
+        /// Move the buffered rounds into oRounds, without copying them
+        void takeRounds(vector<Round> &oRounds)
+        {
+            oRounds.clear();
+            oRounds.swap(m_rounds);
+        }
+
+    private:
+        boost::shared_ptr<Results> m_filter;
+    };
+
+
+    /// Search of one row (or column), with its own rack and results
+    void searchRowTask(const BoardSearch *iSearch, const Rack *iRack,
+                       RoundBuffer *oBuffer, Coord::Direction iDir, int iRow)
+    {
+        Rack copyRack = *iRack;
+        iSearch->searchRow(copyRack, *oBuffer, iDir, iRow);
+    }
+}
+
+
 void Board::search(const Dictionary &iDic,
                    const Rack &iRack,
                    Results &oResults) const
 {
-    // Create a copy of the rack to avoid modifying the given one
-    Rack copyRack = iRack;
-
-    // Search horizontal words
-    BoardSearch horizSearch(iDic, m_params, m_tilesRow, m_crossRow,
-                            m_pointRow, m_jokerRow);
-    horizSearch.search(copyRack, oResults, Coord::HORIZONTAL);
-
-    // Search vertical words
-    BoardSearch vertSearch(iDic, m_params, m_tilesCol, m_crossCol,
-                            m_pointCol, m_jokerCol);
-    vertSearch.search(copyRack, oResults, Coord::VERTICAL);
+    searchCached(iDic, iRack, oResults, false);
 }
 
 
@@ -487,12 +589,109 @@ void Board::searchFirst(const Dictionary &iDic,
                         const Rack &iRack,
                         Results &oResults) const
 {
-    // Create a copy of the rack to avoid modifying the given one
-    Rack copyRack = iRack;
+    searchCached(iDic, iRack, oResults, true);
+}
+
+
+void Board::searchCached(const Dictionary &iDic, const Rack &iRack,
+                         Results &oResults, bool iFirstTurn) const
+{
+    ASSERT(m_bulkDic == NULL, "Search not allowed during a bulk load");
+
+    if (m_searchCache.replay(m_hash, iDic, iRack, iFirstTurn, oResults))
+        return;
+
+    // The rounds kept by the search are replayed into oResults, then
+    // moved into the cache without being copied again
+    SearchCache::RoundLists rounds;
+    const int minScore = searchRounds(iDic, iRack, oResults, iFirstTurn, rounds);
+    SearchCache::Replay(rounds, oResults);
+    m_searchCache.store(m_hash, iDic, iRack, iFirstTurn, rounds, minScore);
+}
+
+
+int Board::searchRounds(const Dictionary &iDic, const Rack &iRack,
+                        const Results &iResults, bool iFirstTurn,
+                        SearchCache::RoundLists &oRounds) const
+{
+    if (iFirstTurn)
+    {
+        // Create a copy of the rack to avoid modifying the given one
+        Rack copyRack = iRack;
+
+        // Search horizontal words
+        BoardSearch horizSearch(iDic, m_params, m_tilesRow, m_crossRow,
+                                m_pointRow, m_jokerRow, true);
+        RoundBuffer buffer;
+        buffer.setFilter(iResults);
+        horizSearch.search(copyRack, buffer, Coord::HORIZONTAL);
+        oRounds.resize(1);
+        buffer.takeRounds(oRounds[0]);
+        return buffer.getMinScore();
+    }
 
-    // Search horizontal words
     BoardSearch horizSearch(iDic, m_params, m_tilesRow, m_crossRow,
-                            m_pointRow, m_jokerRow, true);
-    horizSearch.search(copyRack, oResults, Coord::HORIZONTAL);
+                            m_pointRow, m_jokerRow);
+    BoardSearch vertSearch(iDic, m_params, m_tilesCol, m_crossCol,
+                            m_pointCol, m_jokerCol);
+
+    // 0 means "use all the cores"
+    unsigned nbThreads = std::max(0, Settings::Instance().getInt("general.search-threads"));
+    if (nbThreads == 0)
+        nbThreads = ThreadPool::GetNbCores();
+
+    if (nbThreads <= 1)
+    {
+        // Create a copy of the rack to avoid modifying the given one
+        Rack copyRack = iRack;
+
+        RoundBuffer buffer;
+        buffer.setFilter(iResults);
+
+        // Search horizontal words
+        horizSearch.search(copyRack, buffer, Coord::HORIZONTAL);
+
+        // Search vertical words
+        vertSearch.search(copyRack, buffer, Coord::VERTICAL);
+
+        oRounds.resize(1);
+        buffer.takeRounds(oRounds[0]);
+        return buffer.getMinScore();
+    }
+
+    // Parallel search: one task per row and per column, each one with
+    // its own buffer. The Results implementations are not thread-safe,
+    // and the result of some of them depends on the order of the calls
+    // to add(), so the buffers are kept in the order of the sequential
+    // search (rows first, then columns) and replayed afterwards.
+    vector<RoundBuffer> buffers(2 * BOARD_DIM);
+    BOOST_FOREACH(RoundBuffer &buffer, buffers)
+    {
+        buffer.setFilter(iResults);
+    }
+    vector<ThreadPool::Task> tasks;
+    tasks.reserve(2 * BOARD_DIM);
+    for (int row = 1; row <= BOARD_DIM; row++)
+    {
+        tasks.push_back(boost::bind(&searchRowTask, &horizSearch, &iRack,
+                                    &buffers[row - 1], Coord::HORIZONTAL, row));
+    }
+    for (int col = 1; col <= BOARD_DIM; col++)
+    {
+        tasks.push_back(boost::bind(&searchRowTask, &vertSearch, &iRack,
+                                    &buffers[BOARD_DIM + col - 1],
+                                    Coord::VERTICAL, col));
+    }
+    ThreadPool::Instance().run(tasks, nbThreads);
+
+    // Each buffer only ignored the rounds below its own minimum score
+    int minScore = buffers[0].getMinScore();
+    oRounds.resize(buffers.size());
+    for (unsigned int i = 0; i < buffers.size(); ++i)
+    {
+        minScore = std::min(minScore, buffers[i].getMinScore());
+        buffers[i].takeRounds(oRounds[i]);
+    }
+    return minScore;
 }
 
@@ -23,10 +23,12 @@
 #define BOARD_H_
 
 #include <string>
+#include <stdint.h>
 
-#include "matrix.h"
+#include "grid.h"
 #include "tile.h"
 #include "cross.h"
+#include "search_cache.h"
 #include "logging.h"
 
 class GameParams;
@@ -42,9 +44,24 @@ using namespace std;
 #define BOARD_MAX 15
 #define BOARD_DIM 15
 
+/// Size of the grids of the board, including a border of empty squares
+#define BOARD_REALDIM (BOARD_DIM + 2)
+
+/// Grids used to store the state of the board
+//@{
+typedef Grid<Tile, BOARD_REALDIM> TileGrid;
+typedef Grid<bool, BOARD_REALDIM> BoolGrid;
+typedef Grid<Cross, BOARD_REALDIM> CrossGrid;
+typedef Grid<int, BOARD_REALDIM> IntGrid;
+//@}
+
 
 /**
  * Representation of the board.
+ * All the data is stored in fixed-size grids inside the object, so
+ * copying a board does not involve any dynamic allocation. The only
+ * exception is the search cache, which is not copied: a copy of a board
+ * (or the target of an assignment) starts with an empty cache.
  *
  * In all the methods, the given coordinates
  * have to be BOARD_MIN <= int <= BOARD_MAX.
@@ -67,6 +84,16 @@ public:
     void removeRound(const Dictionary &iDic, const Round &iRound);
     int  checkRound(Round &iRound, bool checkJunction = true) const;
 
+    /**
+     * Bulk loading, used to replay the moves of a saved game quickly.
+     * Between these calls, the cross checks are not updated when rounds
+     * are added or removed: they are built only once, in endBulkLoad().
+     * checkRound() can still be used (it computes the cross checks of the
+     * squares of the round only), but searching is not allowed.
+     */
+    void beginBulkLoad(const Dictionary &iDic);
+    void endBulkLoad();
+
     /**
      * Preview
      */
@@ -75,9 +102,24 @@ public:
     void testRound(const Round &iRound);
     void removeTestRound();
 
+    /**
+     * Search the rounds playable with the given rack, and add them
+     * to oResults. The rounds are kept in a cache until the next call
+     * to addRound() or removeRound(), so searching again with the same
+     * rack is cheap (whatever the Results implementation).
+     * Because of this cache, these methods are not thread-safe, even if
+     * they are const: a board must not be searched by several threads
+     * at the same time.
+     */
     void search(const Dictionary &iDic, const Rack &iRack, Results &oResults) const;
     void searchFirst(const Dictionary &iDic, const Rack &iRack, Results &oResults) const;
 
+    /**
+     * Return a hash of the tiles of the board (Zobrist hashing),
+     * updated by addRound() and removeRound()
+     */
+    uint64_t getHash() const { return m_hash; }
+
     /**
      * 
      */
@@ -90,36 +132,72 @@ private:
 
     const BoardLayout &m_layout;
 
-    Matrix<Tile> m_tilesRow;
-    Matrix<Tile> m_tilesCol;
+    TileGrid m_tilesRow;
+    TileGrid m_tilesCol;
 
-    Matrix<bool> m_jokerRow;
-    Matrix<bool> m_jokerCol;
+    BoolGrid m_jokerRow;
+    BoolGrid m_jokerCol;
 
-    Matrix<Cross> m_crossRow;
-    Matrix<Cross> m_crossCol;
+    CrossGrid m_crossRow;
+    CrossGrid m_crossCol;
 
-    Matrix<int> m_pointRow;
-    Matrix<int> m_pointCol;
+    IntGrid m_pointRow;
+    IntGrid m_pointCol;
 
-    Matrix<Tile> m_testsRow;
+    TileGrid m_testsRow;
 
     /// Flag indicating if the board is empty or if it has letters
     bool m_isEmpty;
 
+    /// Hash of the tiles of the board
+    uint64_t m_hash;
+
+    /// Dictionary given to beginBulkLoad(), NULL outside of a bulk load
+    const Dictionary *m_bulkDic;
+
+    /// Rounds found by the last searches on the current board
+    /// (empty in a copy of the board)
+    mutable SearchCache m_searchCache;
+
+    /// Search using the cache if possible, and fill it otherwise
+    void searchCached(const Dictionary &iDic, const Rack &iRack,
+                      Results &oResults, bool iFirstTurn) const;
+    /**
+     * Search without using the cache, and put the rounds in oRounds,
+     * ignoring the ones filtered out by the rules of iResults (see
+     * Results::createFilter()). Return the minimum score used to ignore
+     * the rounds
+     */
+    int searchRounds(const Dictionary &iDic, const Rack &iRack,
+                     const Results &iResults, bool iFirstTurn,
+                     SearchCache::RoundLists &oRounds) const;
+
     /**
      * board_cross.c
      */
     void buildCross(const Dictionary &iDic);
 
-    int checkRoundAux(const Matrix<Tile> &iTilesMx,
-                      const Matrix<Cross> &iCrossMx,
-                      const Matrix<int> &iPointsMx,
-                      const Matrix<bool> &iJokerMx,
+    /**
+     * Update the cross checks impacted by the addition (or the removal)
+     * of the given round, which is faster than rebuilding all of them.
+     * The tiles must already be added to (or removed from) the board.
+     */
+    void updateCross(const Dictionary &iDic, const Round &iRound);
+
+    int checkRoundAux(const TileGrid &iTilesMx,
+                      const CrossGrid &iCrossMx,
+                      const IntGrid &iPointsMx,
+                      const BoolGrid &iJokerMx,
                       Round &iRound,
                       bool checkJunction) const;
+
+    /// Version of checkRound() used during a bulk load
+    int checkRoundBulk(const Dictionary &iDic, Round &iRound,
+                       bool checkJunction) const;
 #ifdef DEBUG
     void checkDouble();
+    /// Check that the cross checks are consistent with a full rebuild
+    void checkCross(const Dictionary &iDic) const;
 #endif
 
 };
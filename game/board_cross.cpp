@@ -19,17 +19,60 @@
  * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
  *****************************************************************************/
 
-#include <wctype.h>
+#include <algorithm>
 
 #include <dic.h>
+#include "dic_internals.h"
+#include "header.h"
 #include "tile.h"
 #include "board.h"
+#include "round.h"
 #include "debug.h"
 
 
+/**
+ * Return the child of iEdge with the given code, or NULL if there is none.
+ * The children of an edge are stored contiguously, the last one having
+ * its "last" flag set.
+ */
+static inline const DicEdge * Board_findChild(const Dictionary &iDic,
+                                              const DicEdge *iEdge,
+                                              unsigned int iCode)
+{
+    if (iEdge->ptr == 0)
+        return NULL;
+    const DicEdge *child = iDic.getEdgeAt(iEdge->ptr);
+    while (true)
+    {
+        if (child->chr == iCode)
+            return child;
+        if (child->last)
+            return NULL;
+        ++child;
+    }
+}
+
+
+/**
+ * Walk the dictionary from iEdge, following the codes of the tiles
+ * iTiles[iFirst], iTiles[iFirst + iStep], ..., up to iTiles[iLast]
+ * (included). An empty range (iFirst beyond iLast) returns iEdge.
+ * Return NULL if the path does not exist.
+ */
+static const DicEdge * Board_walk(const Dictionary &iDic,
+                                  const DicEdge *iEdge,
+                                  const Tile *iTiles,
+                                  int iFirst, int iLast, int iStep)
+{
+    for (int i = iFirst; iEdge != NULL && (i - iLast) * iStep <= 0; i += iStep)
+        iEdge = Board_findChild(iDic, iEdge, iTiles[i].toCode());
+    return iEdge;
+}
+
+
 static void Board_checkout_tile(const Dictionary &iDic,
-                                vector<Tile>& iTiles,
-                                vector<bool> & iJoker,
+                                const Tile *iTiles,
+                                const bool *iJoker,
                                 Cross &oCross,
                                 int& oPoints,
                                 int index)
@@ -45,82 +88,300 @@ static void Board_checkout_tile(const Dictionary &iDic,
             oPoints += iTiles[left].getPoints();
     }
 
-    // FIXME: create temporary strings until the dictionary uses Tile objects
-    wstring leftTiles;
-    wstring rightTiles;
-
-    for (int i = left; i < index; i++)
-        leftTiles.push_back(towupper(iTiles[i].toChar()));
-
-    for (int i = index + 1; !iTiles[i].isEmpty(); i++)
-        rightTiles.push_back(towupper(iTiles[i].toChar()));
-
-    /* Tiles that can be played */
-    unsigned int node, succ;
-    node = iDic.charLookup(iDic.getRoot(), leftTiles.c_str());
-    if (node == 0)
+    int right = index;
+    int rightPoints = 0;
+    while (!iTiles[right + 1].isEmpty())
     {
-        oCross.setNone();
-        return;
+        right++;
+        if (!iJoker[right])
+            rightPoints += iTiles[right].getPoints();
     }
 
-    for (succ = iDic.getSucc(node); succ; succ = iDic.getNext(succ))
+    // The codes of the tiles are used directly (they are the same for
+    // jokers and normal tiles), without going through the characters.
+    // We look for the letters X such that L.X.R is a word. With a GADDAG,
+    // the reversed word R'.X.L' is also stored (without separator), so
+    // we can start with the longest of L and R, to have the shortest
+    // walks for each candidate letter.
+    if (iDic.getHeader().getType() == Header::kGADDAG &&
+        right - index > index - left)
     {
-        if (iDic.isEndOfWord(iDic.charLookup(succ, rightTiles.c_str())))
-            oCross.insert(Tile(iDic.getChar(succ)));
-        if (iDic.isLast(succ))
-            break;
+        const DicEdge *node =
+            Board_walk(iDic, iDic.getEdgeAt(iDic.getGaddagRoot()),
+                       iTiles, right, index + 1, -1);
+        if (node != NULL && node->ptr != 0)
+        {
+            const DicEdge *succ = iDic.getEdgeAt(node->ptr);
+            while (true)
+            {
+                if (succ->chr != DIC_GADDAG_SEPARATOR)
+                {
+                    const DicEdge *end =
+                        Board_walk(iDic, succ, iTiles, index - 1, left, -1);
+                    if (end != NULL && end->term)
+                        oCross.insert(iDic.getTileFromCode(succ->chr));
+                }
+                if (succ->last)
+                    break;
+                ++succ;
+            }
+        }
+
+        // Keep the same points as with the DAWG: when the left part is not
+        // the beginning of a word, the right part is not counted
+        if (oCross.isNone() &&
+            Board_walk(iDic, iDic.getEdgeAt(iDic.getRoot()),
+                       iTiles, left, index - 1, 1) == NULL)
+        {
+            return;
+        }
+    }
+    else
+    {
+        /* Tiles that can be played */
+        const DicEdge *node =
+            Board_walk(iDic, iDic.getEdgeAt(iDic.getRoot()),
+                       iTiles, left, index - 1, 1);
+        if (node == NULL)
+        {
+            oCross.setNone();
+            return;
+        }
+
+        if (node->ptr != 0)
+        {
+            const DicEdge *succ = iDic.getEdgeAt(node->ptr);
+            while (true)
+            {
+                const DicEdge *end =
+                    Board_walk(iDic, succ, iTiles, index + 1, right, 1);
+                if (end != NULL && end->term)
+                    oCross.insert(iDic.getTileFromCode(succ->chr));
+                if (succ->last)
+                    break;
+                ++succ;
+            }
+        }
     }
 
     /* Points on the right part */
-    /* yes, it is REALLY [index + 1] */
-    while (!iTiles[index + 1].isEmpty())
+    oPoints += rightPoints;
+}
+
+
+static void Board_checkSquare(const Dictionary &iDic,
+                              const TileGrid &iTilesMx,
+                              const BoolGrid &iJokerMx,
+                              CrossGrid &iCrossMx,
+                              IntGrid &iPointMx,
+                              int i, int j)
+{
+    iPointMx[j][i] = -1;
+    if (!iTilesMx[i][j].isEmpty())
     {
-        index++;
-        if (!iJoker[index])
-            oPoints += iTiles[index].getPoints();
+        iCrossMx[j][i].setNone();
+    }
+    else if (!iTilesMx[i][j - 1].isEmpty() ||
+             !iTilesMx[i][j + 1].isEmpty())
+    {
+        iCrossMx[j][i].setNone();
+        Board_checkout_tile(iDic,
+                            iTilesMx[i],
+                            iJokerMx[i],
+                            iCrossMx[j][i],
+                            iPointMx[j][i],
+                            j);
+    }
+    else
+    {
+        iCrossMx[j][i].setAny();
     }
 }
 
 
 static void Board_check(const Dictionary &iDic,
-                        Matrix<Tile> &iTilesMx,
-                        Matrix<bool> &iJokerMx,
-                        Matrix<Cross> &iCrossMx,
-                        Matrix<int> &iPointMx)
+                        TileGrid &iTilesMx,
+                        BoolGrid &iJokerMx,
+                        CrossGrid &iCrossMx,
+                        IntGrid &iPointMx)
 {
     for (int i = 1; i <= BOARD_DIM; i++)
     {
         for (int j = 1; j <= BOARD_DIM; j++)
         {
-            iPointMx[j][i] = -1;
-            if (!iTilesMx[i][j].isEmpty())
-            {
-                iCrossMx[j][i].setNone();
-            }
-            else if (!iTilesMx[i][j - 1].isEmpty() ||
-                     !iTilesMx[i][j + 1].isEmpty())
+            Board_checkSquare(iDic, iTilesMx, iJokerMx,
+                              iCrossMx, iPointMx, i, j);
+        }
+    }
+}
+
+
+/**
+ * Update the cross checks of line iLine, after a modification of the tiles
+ * between the indices iFirst and iLast (included) of the line.
+ * Only the squares of the run of tiles containing the modified squares,
+ * and the squares at both ends of this run, can be impacted.
+ */
+static void Board_checkSpan(const Dictionary &iDic,
+                            TileGrid &iTilesMx,
+                            BoolGrid &iJokerMx,
+                            CrossGrid &iCrossMx,
+                            IntGrid &iPointMx,
+                            int iLine, int iFirst, int iLast)
+{
+    int first = iFirst;
+    while (!iTilesMx[iLine][first - 1].isEmpty())
+        first--;
+    int last = iLast;
+    while (!iTilesMx[iLine][last + 1].isEmpty())
+        last++;
+    // Include the squares at both ends of the run, but stay on the board
+    first = std::max(first - 1, 1);
+    last = std::min(last + 1, BOARD_DIM);
+    for (int j = first; j <= last; j++)
+    {
+        Board_checkSquare(iDic, iTilesMx, iJokerMx,
+                          iCrossMx, iPointMx, iLine, j);
+    }
+}
+
+
+void Board::buildCross(const Dictionary &iDic)
+{
+    Board_check(iDic, m_tilesRow, m_jokerRow, m_crossCol, m_pointCol);
+    Board_check(iDic, m_tilesCol, m_jokerCol, m_crossRow, m_pointRow);
+}
+
+
+void Board::updateCross(const Dictionary &iDic, const Round &iRound)
+{
+    const int row = iRound.getCoord().getRow();
+    const int col = iRound.getCoord().getCol();
+    const int len = iRound.getWordLen();
+    if (iRound.getCoord().getDir() == Coord::HORIZONTAL)
+    {
+        // Line of the round
+        Board_checkSpan(iDic, m_tilesRow, m_jokerRow, m_crossCol, m_pointCol,
+                        row, col, col + len - 1);
+        // Columns of the tiles played (or removed)
+        for (int i = 0; i < len; i++)
+        {
+            if (iRound.isPlayedFromRack(i))
             {
-                iCrossMx[j][i].setNone();
-                Board_checkout_tile(iDic,
-                                    iTilesMx[i],
-                                    iJokerMx[i],
-                                    iCrossMx[j][i],
-                                    iPointMx[j][i],
-                                    j);
+                Board_checkSpan(iDic, m_tilesCol, m_jokerCol,
+                                m_crossRow, m_pointRow, col + i, row, row);
             }
-            else
+        }
+    }
+    else
+    {
+        // Column of the round
+        Board_checkSpan(iDic, m_tilesCol, m_jokerCol, m_crossRow, m_pointRow,
+                        col, row, row + len - 1);
+        // Lines of the tiles played (or removed)
+        for (int i = 0; i < len; i++)
+        {
+            if (iRound.isPlayedFromRack(i))
             {
-                iCrossMx[j][i].setAny();
+                Board_checkSpan(iDic, m_tilesRow, m_jokerRow,
+                                m_crossCol, m_pointCol, row + i, col, col);
             }
         }
     }
+#ifdef DEBUG
+    checkCross(iDic);
+#endif
 }
 
 
-void Board::buildCross(const Dictionary &iDic)
+void Board::beginBulkLoad(const Dictionary &iDic)
 {
-    Board_check(iDic, m_tilesRow, m_jokerRow, m_crossCol, m_pointCol);
-    Board_check(iDic, m_tilesCol, m_jokerCol, m_crossRow, m_pointRow);
+    ASSERT(m_bulkDic == NULL, "Bulk load already started");
+    m_bulkDic = &iDic;
+}
+
+
+void Board::endBulkLoad()
+{
+    ASSERT(m_bulkDic != NULL, "No bulk load in progress");
+    buildCross(*m_bulkDic);
+    m_bulkDic = NULL;
+}
+
+
+int Board::checkRoundBulk(const Dictionary &iDic, Round &iRound,
+                          bool checkJunction) const
+{
+    // The cross checks of the board are not up to date, so compute them
+    // for the squares of the round (on copies of the matrices)
+    const int len = iRound.getWordLen();
+    if (iRound.getCoord().getDir() == Coord::HORIZONTAL)
+    {
+        const int row = iRound.getCoord().getRow();
+        const int col = iRound.getCoord().getCol();
+        CrossGrid crossRow = m_crossRow;
+        IntGrid pointRow = m_pointRow;
+        for (int j = col; j < col + len && j <= BOARD_DIM; j++)
+        {
+            Board_checkSquare(iDic, m_tilesCol, m_jokerCol,
+                              crossRow, pointRow, j, row);
+        }
+        return checkRoundAux(m_tilesRow, crossRow,
+                             pointRow, m_jokerRow, iRound, checkJunction);
+    }
+    else
+    {
+        // Exchange the coordinates temporarily
+        iRound.accessCoord().swap();
+
+        const int row = iRound.getCoord().getRow();
+        const int col = iRound.getCoord().getCol();
+        CrossGrid crossCol = m_crossCol;
+        IntGrid pointCol = m_pointCol;
+        for (int j = col; j < col + len && j <= BOARD_DIM; j++)
+        {
+            Board_checkSquare(iDic, m_tilesRow, m_jokerRow,
+                              crossCol, pointCol, j, row);
+        }
+        int res = checkRoundAux(m_tilesCol, crossCol,
+                                pointCol, m_jokerCol, iRound, checkJunction);
+
+        // Restore the coordinates
+        iRound.accessCoord().swap();
+
+        return res;
+    }
+}
+
+
+#ifdef DEBUG
+void Board::checkCross(const Dictionary &iDic) const
+{
+    // Rebuild all the cross checks on a copy, and compare
+    TileGrid tilesRow = m_tilesRow;
+    TileGrid tilesCol = m_tilesCol;
+    BoolGrid jokerRow = m_jokerRow;
+    BoolGrid jokerCol = m_jokerCol;
+    CrossGrid crossRow = m_crossRow;
+    CrossGrid crossCol = m_crossCol;
+    IntGrid pointRow = m_pointRow;
+    IntGrid pointCol = m_pointCol;
+    Board_check(iDic, tilesRow, jokerRow, crossCol, pointCol);
+    Board_check(iDic, tilesCol, jokerCol, crossRow, pointRow);
+    for (int row = 1; row <= BOARD_DIM; row++)
+    {
+        for (int col = 1; col <= BOARD_DIM; col++)
+        {
+            ASSERT(crossRow[row][col] == m_crossRow[row][col],
+                   "Cross check inconsistency at " << row << "x" << col);
+            ASSERT(crossCol[row][col] == m_crossCol[row][col],
+                   "Cross check inconsistency at " << col << "x" << row);
+            ASSERT(pointRow[row][col] == m_pointRow[row][col],
+                   "Points inconsistency at " << row << "x" << col);
+            ASSERT(pointCol[row][col] == m_pointCol[row][col],
+                   "Points inconsistency at " << col << "x" << row);
+        }
+    }
 }
+#endif
 
@@ -19,134 +19,506 @@
  * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
  *****************************************************************************/
 
-#include <cwctype> // For towupper
+#include <algorithm>
+#include <functional>
+#include <vector>
+#include <boost/foreach.hpp>
+#include <boost/scoped_ptr.hpp>
 
 #include "board_search.h"
 #include "dic.h"
+#include "header.h"
 #include "game_params.h"
 #include "board.h"
+#include "board_layout.h"
 #include "tile.h"
 #include "rack.h"
 #include "round.h"
 #include "results.h"
+#include "debug.h"
+
+
+/// Maximum number of tiles taken into account in the score bounds
+#define MAX_BOUND_TILES Round::kMAX_LENGTH
+
+/**
+ * Data used to compute an upper bound of the score of the words of a row.
+ * The arrays indexed by a column c describe the squares of the row
+ * from column c to the end of the row. Only the empty squares where
+ * a tile can be played are taken into account for the multipliers.
+ */
+struct BoardSearch::ScoreBounds
+{
+    /// Sum of the k highest values of the tiles of the rack
+    int rackPoints[MAX_BOUND_TILES + 1];
+    /// Points of the tiles already on the board
+    int boardPoints[BOARD_DIM + 2];
+    /// Highest letter multiplier (0 if there is no free square)
+    int maxLetterMul[BOARD_DIM + 2];
+    /// Highest word multiplier (0 if there is no free square)
+    int maxWordMul[BOARD_DIM + 2];
+    /// Product of the k highest word multipliers
+    int wordMul[BOARD_DIM + 2][MAX_BOUND_TILES + 1];
+    /// Sum of the k highest points of the words in the other direction
+    int crossPoints[BOARD_DIM + 2][MAX_BOUND_TILES + 1];
+};
+
+
+/// Free squares of a row, accumulated to compute the ScoreBounds
+struct BoardSearch::BoundsBuilder
+{
+    BoundsBuilder() : boardPoints(0), maxLetterMul(0), maxWordMul(0) {}
+
+    int boardPoints;
+    int maxLetterMul;
+    int maxWordMul;
+    /// Word multipliers and cross points of the squares, in decreasing order
+    vector<int> wordMuls;
+    vector<int> crossPoints;
+
+    /// Fill the bounds of column iCol with the squares accumulated so far
+    void store(ScoreBounds &oBounds, int iCol) const;
+};
+
+
+/// Word being built by the GADDAG-based search, in the current row
+struct BoardSearch::GaddagState
+{
+    GaddagState(const Rack &iRack, Results &oResults,
+                Coord::Direction iDir, int iRow, const ScoreBounds &iBounds)
+        : results(oResults), dir(iDir), row(iRow), anchor(0), leftLimit(1),
+        bounds(iBounds), leftBounds(iBounds), rackMask(0), nbJokers(0)
+    {
+        // The recursion works on the letter codes, so the rack is
+        // converted once for the whole row
+        std::fill(rackCounts, rackCounts + 64, 0);
+        vector<Tile> tiles;
+        iRack.getTiles(tiles);
+        BOOST_FOREACH(const Tile &tile, tiles)
+        {
+            if (tile.isPureJoker())
+                ++nbJokers;
+            else
+            {
+                ++rackCounts[tile.toCode()];
+                rackMask |= Cross::GetTileBit(tile);
+            }
+        }
+        nbTiles = tiles.size();
+    }
+
+    Results &results;
+    Coord::Direction dir;
+    int row;
+    int anchor;
+    /// Leftmost column of the words generated from the anchor
+    int leftLimit;
+    const ScoreBounds &bounds;
+    /**
+     * Bounds used while building the left part: for a column c, they take
+     * into account the squares from the left limit to c, and the squares
+     * after the anchor (see computeLeftBounds())
+     */
+    ScoreBounds leftBounds;
+    /// Number of tiles of the rack for each letter code (jokers excluded)
+    unsigned int rackCounts[64];
+    /// Letters present in rackCounts, as a mask for the Cross class
+    uint64_t rackMask;
+    unsigned int nbJokers;
+    unsigned int nbTiles;
+    /// Points of the tiles placed so far
+    PartialScore score;
+    /// Codes of the tiles placed from the rack, indexed by column
+    unsigned int codes[BOARD_DIM + 2];
+    /// True for the tiles coming from the rack
+    bool fromRack[BOARD_DIM + 2];
+    /// True for the jokers coming from the rack
+    bool joker[BOARD_DIM + 2];
+
+    /// Mask of the letters which can be played from the rack
+    uint64_t getPlayableMask() const { return nbJokers ? ~(uint64_t)0 : rackMask; }
+
+    void takeLetter(unsigned int iCode)
+    {
+        if (--rackCounts[iCode] == 0)
+            rackMask &= ~((uint64_t)1 << iCode);
+        --nbTiles;
+    }
+
+    void putBackLetter(unsigned int iCode)
+    {
+        ++rackCounts[iCode];
+        rackMask |= (uint64_t)1 << iCode;
+        ++nbTiles;
+    }
+};
 
 
 BoardSearch::BoardSearch(const Dictionary &iDic,
                          const GameParams &iParams,
-                         const Matrix<Tile> &iTilesMx,
-                         const Matrix<Cross> &iCrossMx,
-                         const Matrix<int> &iPointsMx,
-                         const Matrix<bool> &iJokerMx,
+                         const TileGrid &iTilesMx,
+                         const CrossGrid &iCrossMx,
+                         const IntGrid &iPointsMx,
+                         const BoolGrid &iJokerMx,
                          bool isFirstTurn)
     : m_dic(iDic), m_params(iParams), m_tilesMx(iTilesMx), m_crossMx(iCrossMx),
       m_pointsMx(iPointsMx), m_jokerMx(iJokerMx), m_firstTurn(isFirstTurn)
 {
+    computeAnchors();
+    computeTables();
+}
+
+
+void BoardSearch::computeTables()
+{
+    const Header &header = m_dic.getHeader();
+    std::fill(m_letterPoints, m_letterPoints + 64, 0);
+    const unsigned int nbLetters = header.getLetters().size();
+    for (unsigned int code = 1; code <= nbLetters && code < 64; ++code)
+    {
+        m_letterPoints[code] = header.getPoints(code);
+    }
+
+    const BoardLayout &layout = m_params.getBoardLayout();
+    m_letterMul.fill(0);
+    m_wordMul.fill(0);
+    m_crossBase.fill(0);
+    m_crossMul.fill(0);
+    m_boardPoints.fill(0);
+    for (int row = 1; row <= BOARD_DIM; row++)
+    {
+        for (int col = 1; col <= BOARD_DIM; col++)
+        {
+            const Tile &tile = m_tilesMx[row][col];
+            if (!tile.isEmpty())
+            {
+                if (!m_jokerMx[row][col])
+                    m_boardPoints[row][col] = m_letterPoints[tile.toCode()];
+                continue;
+            }
+            m_letterMul[row][col] = layout.getLetterMultiplier(row, col);
+            m_wordMul[row][col] = layout.getWordMultiplier(row, col);
+            const int points = m_pointsMx[row][col];
+            if (points >= 0)
+            {
+                m_crossBase[row][col] = points * m_wordMul[row][col];
+                m_crossMul[row][col] = m_wordMul[row][col];
+            }
+        }
+    }
+}
+
+
+void BoardSearch::computeAnchors()
+{
+    // Occupied squares of each row (bit i corresponds to column i)
+    uint32_t occupied[BOARD_DIM + 2];
+    for (int row = 0; row <= BOARD_DIM + 1; row++)
+    {
+        occupied[row] = 0;
+        if (row == 0 || row == BOARD_DIM + 1)
+            continue;
+        for (int col = 1; col <= BOARD_DIM; col++)
+        {
+            if (!m_tilesMx[row][col].isEmpty())
+                occupied[row] |= 1 << col;
+        }
+    }
+
+    // An anchor is an empty square with an occupied neighbour
+    const uint32_t boardMask = ((1 << BOARD_DIM) - 1) << 1;
+    m_anchors[0] = m_anchors[BOARD_DIM + 1] = 0;
+    for (int row = 1; row <= BOARD_DIM; row++)
+    {
+        const uint32_t neighbours = (occupied[row] << 1) | (occupied[row] >> 1) |
+            occupied[row - 1] | occupied[row + 1];
+        m_anchors[row] = neighbours & ~occupied[row] & boardMask;
+    }
 }
 
 
 void BoardSearch::search(Rack &iRack, Results &oResults, Coord::Direction iDir) const
 {
+    const bool useGaddag = m_dic.getHeader().getType() == Header::kGADDAG;
+
     // Handle the first turn specifically
     if (m_firstTurn)
     {
         const int row = 8, col = 8;
+        ScoreBounds bounds;
+        computeBounds(iRack, row, bounds);
+        if (useGaddag)
+        {
+            GaddagState state(iRack, oResults, Coord::HORIZONTAL, row, bounds);
+            state.anchor = col;
+            computeLeftBounds(row, col, state.leftLimit, state.leftBounds);
+            gaddagLeft(state, m_dic.getGaddagRoot(), col);
+            return;
+        }
         Round tmpRound;
         tmpRound.accessCoord().setRow(row);
         tmpRound.accessCoord().setCol(col);
         tmpRound.accessCoord().setDir(Coord::HORIZONTAL);
         leftPart(iRack, tmpRound, oResults, m_dic.getRoot(),
-                 row, col, std::min(iRack.getNbTiles(), (unsigned)col) - 1);
+                 row, col, std::min(iRack.getNbTiles(), (unsigned)col) - 1,
+                 bounds);
+        return;
+    }
+
+    for (int row = 1; row <= BOARD_DIM; row++)
+    {
+        searchRow(iRack, oResults, iDir, row);
+    }
+}
+
+
+void BoardSearch::searchRow(Rack &iRack, Results &oResults,
+                            Coord::Direction iDir, int iRow) const
+{
+    ASSERT(!m_firstTurn, "searchRow() cannot be used for the first turn");
+    const bool useGaddag = m_dic.getHeader().getType() == Header::kGADDAG;
+
+    const int row = iRow;
+    const uint32_t anchors = m_anchors[row];
+    if (anchors == 0)
         return;
+
+#ifndef DONT_USE_SEARCH_OPTIMIZATION
+    const uint64_t rackMask = iRack.getLetterMask();
+#endif
+
+    ScoreBounds bounds;
+    computeBounds(iRack, row, bounds);
+
+    // Only allocated when needed, since it converts the rack
+    boost::scoped_ptr<GaddagState> gaddagState;
+    if (useGaddag)
+        gaddagState.reset(new GaddagState(iRack, oResults, iDir, row, bounds));
+
+    Round partialWord;
+    partialWord.accessCoord().setDir(iDir);
+    partialWord.accessCoord().setRow(row);
+    int lastanchor = 0;
+    for (int col = 1; col <= BOARD_DIM; col++)
+    {
+        if (!(anchors & (1 << col)))
+            continue;
+
+#ifndef DONT_USE_SEARCH_OPTIMIZATION
+        // Optimization compared to the original Appel & Jacobson
+        // algorithm: skip the anchor if none of the tiles of the rack
+        // matches the cross mask for the current anchor
+        if (!m_crossMx[row][col].checkMask(rackMask))
+        {
+            lastanchor = col;
+            continue;
+        }
+#endif
+
+        // The words generated from this anchor start after the previous
+        // anchor. If they cannot reach the minimum score, the words of the
+        // next anchors cannot either, since they cover less squares
+        // (checked for each anchor, because the minimum score can change)
+        if (getMaxScore(bounds, PartialScore(), lastanchor + 1,
+                        iRack.getNbTiles()) < oResults.getMinScore())
+        {
+            return;
+        }
+
+        if (useGaddag)
+        {
+            gaddagState->anchor = col;
+            gaddagState->leftLimit = lastanchor + 1;
+            computeLeftBounds(row, col, lastanchor + 1, gaddagState->leftBounds);
+            gaddagLeft(*gaddagState, m_dic.getGaddagRoot(), col);
+        }
+        else if (!m_tilesMx[row][col - 1].isEmpty())
+        {
+            partialWord.accessCoord().setCol(lastanchor + 1);
+            extendRight(iRack, partialWord, oResults,
+                        m_dic.getRoot(), row, lastanchor + 1, col,
+                        bounds, PartialScore());
+        }
+        else
+        {
+            partialWord.accessCoord().setCol(col);
+            leftPart(iRack, partialWord, oResults,
+                     m_dic.getRoot(), row, col, col - lastanchor - 1, bounds);
+        }
+        lastanchor = col;
     }
+}
 
 
+void BoardSearch::computeBounds(const Rack &iRack, int iRow,
+                                ScoreBounds &oBounds) const
+{
+    // Values of the tiles of the rack, in decreasing order
     vector<Tile> rackTiles;
     iRack.getTiles(rackTiles);
-    vector<Tile>::const_iterator it;
+    vector<int> values;
+    BOOST_FOREACH(const Tile &tile, rackTiles)
+    {
+        values.push_back(tile.isJoker() ? 0 : m_letterPoints[tile.toCode()]);
+    }
+    std::sort(values.begin(), values.end(), std::greater<int>());
+    oBounds.rackPoints[0] = 0;
+    for (unsigned int k = 1; k <= MAX_BOUND_TILES; ++k)
+    {
+        oBounds.rackPoints[k] = oBounds.rackPoints[k - 1] +
+            (k <= values.size() ? values[k - 1] : 0);
+    }
 
-    for (int row = 1; row <= BOARD_DIM; row++)
+    // Go through the row from the end, accumulating the free squares
+    BoundsBuilder builder;
+    builder.store(oBounds, BOARD_DIM + 1);
+    for (int col = BOARD_DIM; col >= 1; --col)
     {
-        Round partialWord;
-        partialWord.accessCoord().setDir(iDir);
-        partialWord.accessCoord().setRow(row);
-        int lastanchor = 0;
-        for (int col = 1; col <= BOARD_DIM; col++)
+        addBoundSquare(builder, iRow, col);
+        builder.store(oBounds, col);
+    }
+}
+
+
+void BoardSearch::computeLeftBounds(int iRow, int iAnchor, int iLimit,
+                                    ScoreBounds &ioBounds) const
+{
+    // The squares after the anchor are always available
+    BoundsBuilder builder;
+    for (int col = iAnchor + 1; col <= BOARD_DIM; ++col)
+        addBoundSquare(builder, iRow, col);
+    // The squares between the limit and the current column too
+    for (int col = iLimit; col <= iAnchor; ++col)
+    {
+        addBoundSquare(builder, iRow, col);
+        builder.store(ioBounds, col);
+    }
+}
+
+
+void BoardSearch::addBoundSquare(BoundsBuilder &ioBuilder,
+                                 int iRow, int iCol) const
+{
+    if (!m_tilesMx[iRow][iCol].isEmpty())
+    {
+        ioBuilder.boardPoints += m_boardPoints[iRow][iCol];
+    }
+    else if (!m_crossMx[iRow][iCol].isNone())
+    {
+        const int lm = m_letterMul[iRow][iCol];
+        const int wm = m_wordMul[iRow][iCol];
+        ioBuilder.maxLetterMul = std::max(ioBuilder.maxLetterMul, lm);
+        ioBuilder.maxWordMul = std::max(ioBuilder.maxWordMul, wm);
+        vector<int> &wordMuls = ioBuilder.wordMuls;
+        wordMuls.insert(std::lower_bound(wordMuls.begin(), wordMuls.end(),
+                                         wm, std::greater<int>()), wm);
+        if (m_crossMul[iRow][iCol])
         {
-            if (m_tilesMx[row][col].isEmpty() &&
-                (!m_tilesMx[row][col - 1].isEmpty() ||
-                 !m_tilesMx[row][col + 1].isEmpty() ||
-                 !m_tilesMx[row - 1][col].isEmpty() ||
-                 !m_tilesMx[row + 1][col].isEmpty()))
-            {
-#ifdef DONT_USE_SEARCH_OPTIMIZATION
-                if (!m_tilesMx[row][col - 1].isEmpty())
-                {
-                    partialWord.accessCoord().setCol(lastanchor + 1);
-                    extendRight(iRack, partialWord, oResults,
-                                m_dic.getRoot(), row, lastanchor + 1, col);
-                }
-                else
-                {
-                    partialWord.accessCoord().setCol(col);
-                    leftPart(iRack, partialWord, oResults,
-                             m_dic.getRoot(), row, col, col - lastanchor - 1);
-                }
-                lastanchor = col;
-#else
-                // Optimization compared to the original Appel & Jacobson
-                // algorithm: skip leftPart if none of the tiles of the rack
-                // matches the cross mask for the current anchor
-                bool match = false;
-                for (it = rackTiles.begin(); it != rackTiles.end(); it++)
-                {
-                    if (m_crossMx[row][col].check(*it))
-                    {
-                        match = true;
-                        break;
-                    }
-                }
-                if (match)
-                {
-                    if (!m_tilesMx[row][col - 1].isEmpty())
-                    {
-                        partialWord.accessCoord().setCol(lastanchor + 1);
-                        extendRight(iRack, partialWord, oResults,
-                                    m_dic.getRoot(), row, lastanchor + 1, col);
-                    }
-                    else
-                    {
-                        partialWord.accessCoord().setCol(col);
-                        leftPart(iRack, partialWord, oResults,
-                                 m_dic.getRoot(), row, col, col - lastanchor - 1);
-                    }
-                }
-                lastanchor = col;
-#endif
-            }
+            const int points = m_crossBase[iRow][iCol];
+            vector<int> &crossPoints = ioBuilder.crossPoints;
+            crossPoints.insert(std::lower_bound(crossPoints.begin(),
+                                                crossPoints.end(),
+                                                points,
+                                                std::greater<int>()),
+                               points);
         }
     }
 }
 
 
+void BoardSearch::BoundsBuilder::store(ScoreBounds &oBounds, int iCol) const
+{
+    oBounds.boardPoints[iCol] = boardPoints;
+    oBounds.maxLetterMul[iCol] = maxLetterMul;
+    oBounds.maxWordMul[iCol] = maxWordMul;
+    oBounds.wordMul[iCol][0] = 1;
+    oBounds.crossPoints[iCol][0] = 0;
+    for (unsigned int k = 1; k <= MAX_BOUND_TILES; ++k)
+    {
+        oBounds.wordMul[iCol][k] = oBounds.wordMul[iCol][k - 1] *
+            (k <= wordMuls.size() ? wordMuls[k - 1] : 1);
+        oBounds.crossPoints[iCol][k] = oBounds.crossPoints[iCol][k - 1] +
+            (k <= crossPoints.size() ? crossPoints[k - 1] : 0);
+    }
+}
+
+
+int BoardSearch::getMaxScore(const ScoreBounds &iBounds,
+                             const PartialScore &iScore,
+                             int iCol, unsigned int iRackSize) const
+{
+    const int lettersToPlay = m_params.getLettersToPlay();
+    // Words using too many letters from the rack are ignored by evalMove()
+    if (iScore.fromRack > lettersToPlay)
+        return -1;
+
+    const int nbTiles = std::min(std::min((int)iRackSize,
+                                          lettersToPlay - iScore.fromRack),
+                                 (int)MAX_BOUND_TILES);
+    const int rackPoints = iBounds.rackPoints[nbTiles] * iBounds.maxLetterMul[iCol];
+    int score = (iScore.mainPoints + iBounds.boardPoints[iCol] + rackPoints) *
+        iScore.wordMul * iBounds.wordMul[iCol][nbTiles];
+    score += iScore.crossPoints + iBounds.crossPoints[iCol][nbTiles] +
+        rackPoints * iBounds.maxWordMul[iCol];
+    if (iScore.fromRack + (int)iRackSize >= lettersToPlay)
+        score += m_params.getBonusPoints();
+    return score;
+}
+
+
+void BoardSearch::addRackTile(PartialScore &ioScore, int iRow, int iCol,
+                              unsigned int iCode, bool iJoker) const
+{
+    const int l = iJoker ? 0 :
+        m_letterPoints[iCode] * m_letterMul[iRow][iCol];
+    ioScore.mainPoints += l;
+    ioScore.wordMul *= m_wordMul[iRow][iCol];
+    ioScore.crossPoints += m_crossBase[iRow][iCol] + l * m_crossMul[iRow][iCol];
+    ++ioScore.fromRack;
+}
+
+
+void BoardSearch::addBoardTile(PartialScore &ioScore, int iRow, int iCol) const
+{
+    ioScore.mainPoints += m_boardPoints[iRow][iCol];
+}
+
+
+bool BoardSearch::isAnchor(int iRow, int iCol) const
+{
+    return m_anchors[iRow] & (1 << iCol);
+}
+
+
 void BoardSearch::leftPart(Rack &iRack, Round &ioPartialWord,
                            Results &oResults, int n, int iRow,
-                           int iAnchor, int iLimit) const
+                           int iAnchor, int iLimit,
+                           const ScoreBounds &iBounds) const
 {
-    extendRight(iRack, ioPartialWord, oResults, n, iRow, iAnchor, iAnchor);
+    // The position of the left part is known now: compute its points
+    PartialScore score;
+    const int firstCol = ioPartialWord.getCoord().getCol();
+    for (unsigned int i = 0; i < ioPartialWord.getWordLen(); ++i)
+    {
+        addRackTile(score, iRow, firstCol + i,
+                    ioPartialWord.getTile(i).toCode(), ioPartialWord.isJoker(i));
+    }
+    extendRight(iRack, ioPartialWord, oResults, n, iRow, iAnchor, iAnchor,
+                iBounds, score);
 
     if (iLimit > 0)
     {
         bool hasJokerInRack = iRack.contains(Tile::Joker());
         for (unsigned int succ = m_dic.getSucc(n); succ; succ = m_dic.getNext(succ))
         {
-            const Tile &l = Tile(m_dic.getChar(succ));
+            const Tile &l = m_dic.getTileFromCode(m_dic.getCode(succ));
             if (iRack.contains(l))
             {
                 iRack.remove(l);
                 ioPartialWord.addRightFromRack(l, false);
                 ioPartialWord.accessCoord().setCol(ioPartialWord.getCoord().getCol() - 1);
                 leftPart(iRack, ioPartialWord, oResults,
-                         succ, iRow, iAnchor, iLimit - 1);
+                         succ, iRow, iAnchor, iLimit - 1, iBounds);
                 ioPartialWord.accessCoord().setCol(ioPartialWord.getCoord().getCol() + 1);
                 ioPartialWord.removeRight();
                 iRack.add(l);
@@ -157,7 +529,7 @@ void BoardSearch::leftPart(Rack &iRack, Round &ioPartialWord,
                 ioPartialWord.addRightFromRack(l, true);
                 ioPartialWord.accessCoord().setCol(ioPartialWord.getCoord().getCol() - 1);
                 leftPart(iRack, ioPartialWord, oResults,
-                         succ, iRow, iAnchor, iLimit - 1);
+                         succ, iRow, iAnchor, iLimit - 1, iBounds);
                 ioPartialWord.accessCoord().setCol(ioPartialWord.getCoord().getCol() + 1);
                 ioPartialWord.removeRight();
                 iRack.add(Tile::Joker());
@@ -169,40 +541,53 @@ void BoardSearch::leftPart(Rack &iRack, Round &ioPartialWord,
 
 void BoardSearch::extendRight(Rack &iRack, Round &ioPartialWord,
                               Results &oResults, unsigned int iNode,
-                              int iRow, int iCol, int iAnchor) const
+                              int iRow, int iCol, int iAnchor,
+                              const ScoreBounds &iBounds,
+                              const PartialScore &iScore) const
 {
     if (m_tilesMx[iRow][iCol].isEmpty())
     {
         if (m_dic.isEndOfWord(iNode) && iCol > iAnchor)
         {
-            evalMove(oResults, ioPartialWord);
+            evalMove(oResults, ioPartialWord, iScore);
         }
 
         // Optimization: avoid entering the for loop if no tile can match
         if (m_crossMx[iRow][iCol].isNone())
             return;
 
+        // Stop if the longer words cannot reach the minimum score
+        if (getMaxScore(iBounds, iScore, iCol, iRack.getNbTiles()) <
+            oResults.getMinScore())
+        {
+            return;
+        }
+
         bool hasJokerInRack = iRack.contains(Tile::Joker());
         for (unsigned int succ = m_dic.getSucc(iNode); succ; succ = m_dic.getNext(succ))
         {
-            const Tile &l = Tile(m_dic.getChar(succ));
+            const Tile &l = m_dic.getTileFromCode(m_dic.getCode(succ));
             if (m_crossMx[iRow][iCol].check(l))
             {
                 if (iRack.contains(l))
                 {
+                    PartialScore score = iScore;
+                    addRackTile(score, iRow, iCol, l.toCode(), false);
                     iRack.remove(l);
                     ioPartialWord.addRightFromRack(l, false);
                     extendRight(iRack, ioPartialWord, oResults,
-                                succ, iRow, iCol + 1, iAnchor);
+                                succ, iRow, iCol + 1, iAnchor, iBounds, score);
                     ioPartialWord.removeRight();
                     iRack.add(l);
                 }
                 if (hasJokerInRack)
                 {
+                    PartialScore score = iScore;
+                    addRackTile(score, iRow, iCol, l.toCode(), true);
                     iRack.remove(Tile::Joker());
                     ioPartialWord.addRightFromRack(l, true);
                     extendRight(iRack, ioPartialWord, oResults,
-                                succ, iRow, iCol + 1, iAnchor);
+                                succ, iRow, iCol + 1, iAnchor, iBounds, score);
                     ioPartialWord.removeRight();
                     iRack.add(Tile::Joker());
                 }
@@ -212,14 +597,17 @@ void BoardSearch::extendRight(Rack &iRack, Round &ioPartialWord,
     else
     {
         const Tile &l = m_tilesMx[iRow][iCol];
-        wint_t upperChar = towupper(l.toChar());
+        const unsigned int code = l.toCode();
         for (unsigned int succ = m_dic.getSucc(iNode); succ ; succ = m_dic.getNext(succ))
         {
-            if ((wint_t)m_dic.getChar(succ) == upperChar)
+            if (m_dic.getCode(succ) == code)
             {
+                PartialScore score = iScore;
+                addBoardTile(score, iRow, iCol);
                 ioPartialWord.addRightFromBoard(l);
                 extendRight(iRack, ioPartialWord,
-                            oResults, succ, iRow, iCol + 1, iAnchor);
+                            oResults, succ, iRow, iCol + 1, iAnchor,
+                            iBounds, score);
                 ioPartialWord.removeRight();
                 // The letter will be present only once in the dictionary,
                 // so we can stop looping
@@ -234,57 +622,41 @@ void BoardSearch::extendRight(Rack &iRack, Round &ioPartialWord,
  * Computes the score of a word, coordinates may be changed to reflect
  * the real direction of the word
  */
-void BoardSearch::evalMove(Results &oResults, Round &iWord) const
+void BoardSearch::evalMove(Results &oResults, Round &iWord,
+                           const PartialScore &iScore) const
 {
-    int fromrack = 0;
-    int pts      = 0;
-    int ptscross = 0;
-    int wordmul  = 1;
-
-    unsigned int len = iWord.getWordLen();
-
-    int row = iWord.getCoord().getRow();
-    int col = iWord.getCoord().getCol();
-
-    const BoardLayout & boardLayout = m_params.getBoardLayout();
-    for (unsigned int i = 0; i < len; i++)
-    {
-        if (!m_tilesMx[row][col+i].isEmpty())
-        {
-            if (!m_jokerMx[row][col+i])
-                pts += iWord.getTile(i).getPoints();
-        }
-        else
-        {
-            int l;
-            if (!iWord.isJoker(i))
-                l = iWord.getTile(i).getPoints() *
-                    boardLayout.getLetterMultiplier(row, col + i);
-            else
-                l = 0;
-            pts += l;
-            int wm = boardLayout.getWordMultiplier(row, col + i);
-            wordmul *= wm;
-
-            int t = m_pointsMx[row][col+i];
-            if (t >= 0)
-                ptscross += (t + l) * wm;
-            fromrack++;
-        }
-    }
-
     // Ignore words using too many letters from the rack
-    if (fromrack > m_params.getLettersToPlay())
+    if (iScore.fromRack > m_params.getLettersToPlay())
         return;
 
-    pts = ptscross + pts * wordmul;
-    if (fromrack == m_params.getLettersToPlay())
+    int pts = iScore.crossPoints + iScore.mainPoints * iScore.wordMul;
+    if (iScore.fromRack == m_params.getLettersToPlay())
     {
         pts += m_params.getBonusPoints();
         iWord.setBonus(true);
     }
     iWord.setPoints(pts);
 
+#ifdef DEBUG
+    // Check the incremental score against a score computed from scratch
+    {
+        PartialScore score;
+        const int row = iWord.getCoord().getRow();
+        const int col = iWord.getCoord().getCol();
+        for (unsigned int i = 0; i < iWord.getWordLen(); i++)
+        {
+            if (m_tilesMx[row][col + i].isEmpty())
+                addRackTile(score, row, col + i, iWord.getTile(i).toCode(),
+                            iWord.isJoker(i));
+            else
+                addBoardTile(score, row, col + i);
+        }
+        ASSERT(score.crossPoints + score.mainPoints * score.wordMul ==
+               iScore.crossPoints + iScore.mainPoints * iScore.wordMul,
+               "Inconsistent incremental score");
+    }
+#endif
+
     if (iWord.getCoord().getDir() == Coord::VERTICAL)
     {
         // Exchange the coordinates temporarily
@@ -298,3 +670,225 @@ void BoardSearch::evalMove(Results &oResults, Round &iWord) const
     }
 }
 
+
+
+void BoardSearch::gaddagLeft(GaddagState &ioState, unsigned int iNode,
+                             int iCol) const
+{
+    const int row = ioState.row;
+    const Tile &boardTile = m_tilesMx[row][iCol];
+    if (!boardTile.isEmpty())
+    {
+        const unsigned int code = boardTile.toCode();
+        for (unsigned int succ = m_dic.getSucc(iNode); succ; succ = m_dic.getNext(succ))
+        {
+            if (m_dic.getCode(succ) == code)
+            {
+                const PartialScore savedScore = ioState.score;
+                addBoardTile(ioState.score, row, iCol);
+                ioState.fromRack[iCol] = false;
+                gaddagLeftNext(ioState, succ, iCol);
+                ioState.score = savedScore;
+                // The letter will be present only once in the node,
+                // so we can stop looping
+                break;
+            }
+        }
+        return;
+    }
+
+    // Optimization: avoid entering the for loop if no tile can match
+    const Cross &cross = m_crossMx[row][iCol];
+    if (!cross.checkMask(ioState.getPlayableMask()))
+        return;
+
+    // Stop if the word cannot reach the minimum score. The remaining
+    // tiles can be placed on both sides of the part already built
+    if (getMaxScore(ioState.leftBounds, ioState.score, iCol, ioState.nbTiles) <
+        ioState.results.getMinScore())
+    {
+        return;
+    }
+
+    const PartialScore savedScore = ioState.score;
+    ioState.fromRack[iCol] = true;
+    for (unsigned int succ = m_dic.getSucc(iNode); succ; succ = m_dic.getNext(succ))
+    {
+        const unsigned int code = m_dic.getCode(succ);
+        if (code == DIC_GADDAG_SEPARATOR || !cross.checkCode(code))
+            continue;
+        ioState.codes[iCol] = code;
+        if (ioState.rackCounts[code])
+        {
+            ioState.takeLetter(code);
+            ioState.joker[iCol] = false;
+            addRackTile(ioState.score, row, iCol, code, false);
+            gaddagLeftNext(ioState, succ, iCol);
+            ioState.score = savedScore;
+            ioState.putBackLetter(code);
+        }
+        if (ioState.nbJokers)
+        {
+            --ioState.nbJokers;
+            --ioState.nbTiles;
+            ioState.joker[iCol] = true;
+            addRackTile(ioState.score, row, iCol, code, true);
+            gaddagLeftNext(ioState, succ, iCol);
+            ioState.score = savedScore;
+            ++ioState.nbTiles;
+            ++ioState.nbJokers;
+        }
+    }
+}
+
+
+void BoardSearch::gaddagLeftNext(GaddagState &ioState, unsigned int iEdge,
+                                 int iCol) const
+{
+    const int row = ioState.row;
+    const int anchor = ioState.anchor;
+
+    // A letter on the left is necessarily part of the word
+    if (!m_tilesMx[row][iCol - 1].isEmpty())
+    {
+        gaddagLeft(ioState, iEdge, iCol - 1);
+        return;
+    }
+
+    // The word can start at iCol, and end at the anchor
+    if (m_dic.isEndOfWord(iEdge) && m_tilesMx[row][anchor + 1].isEmpty())
+        gaddagRecord(ioState, iCol, anchor);
+
+    // The word can start at iCol, and go on after the anchor.
+    // The separator has the lowest character, so when it is present,
+    // it is always the first edge of the node
+    if (anchor < BOARD_DIM)
+    {
+        const unsigned int succ = m_dic.getSucc(iEdge);
+        if (succ && m_dic.getCode(succ) == DIC_GADDAG_SEPARATOR)
+            gaddagRight(ioState, succ, iCol, anchor + 1);
+    }
+
+    // Go on to the left, without reaching the previous anchor
+    // (the words covering it are generated from that anchor)
+    if (iCol > ioState.leftLimit && ioState.nbTiles)
+        gaddagLeft(ioState, iEdge, iCol - 1);
+}
+
+
+void BoardSearch::gaddagRight(GaddagState &ioState, unsigned int iNode,
+                              int iStart, int iCol) const
+{
+    const int row = ioState.row;
+    const Tile &boardTile = m_tilesMx[row][iCol];
+    if (!boardTile.isEmpty())
+    {
+        const unsigned int code = boardTile.toCode();
+        for (unsigned int succ = m_dic.getSucc(iNode); succ; succ = m_dic.getNext(succ))
+        {
+            if (m_dic.getCode(succ) == code)
+            {
+                const PartialScore savedScore = ioState.score;
+                addBoardTile(ioState.score, row, iCol);
+                ioState.fromRack[iCol] = false;
+                gaddagRightNext(ioState, succ, iStart, iCol);
+                ioState.score = savedScore;
+                // The letter will be present only once in the node,
+                // so we can stop looping
+                break;
+            }
+        }
+        return;
+    }
+
+    // Optimization: avoid entering the for loop if no tile can match
+    const Cross &cross = m_crossMx[row][iCol];
+    if (!cross.checkMask(ioState.getPlayableMask()))
+        return;
+
+    // Stop if the word cannot reach the minimum score
+    if (getMaxScore(ioState.bounds, ioState.score, iCol, ioState.nbTiles) <
+        ioState.results.getMinScore())
+    {
+        return;
+    }
+
+    const PartialScore savedScore = ioState.score;
+    ioState.fromRack[iCol] = true;
+    for (unsigned int succ = m_dic.getSucc(iNode); succ; succ = m_dic.getNext(succ))
+    {
+        const unsigned int code = m_dic.getCode(succ);
+        if (!cross.checkCode(code))
+            continue;
+        ioState.codes[iCol] = code;
+        if (ioState.rackCounts[code])
+        {
+            ioState.takeLetter(code);
+            ioState.joker[iCol] = false;
+            addRackTile(ioState.score, row, iCol, code, false);
+            gaddagRightNext(ioState, succ, iStart, iCol);
+            ioState.score = savedScore;
+            ioState.putBackLetter(code);
+        }
+        if (ioState.nbJokers)
+        {
+            --ioState.nbJokers;
+            --ioState.nbTiles;
+            ioState.joker[iCol] = true;
+            addRackTile(ioState.score, row, iCol, code, true);
+            gaddagRightNext(ioState, succ, iStart, iCol);
+            ioState.score = savedScore;
+            ++ioState.nbTiles;
+            ++ioState.nbJokers;
+        }
+    }
+}
+
+
+void BoardSearch::gaddagRightNext(GaddagState &ioState, unsigned int iEdge,
+                                  int iStart, int iCol) const
+{
+    // A letter on the right is necessarily part of the word
+    if (!m_tilesMx[ioState.row][iCol + 1].isEmpty())
+    {
+        gaddagRight(ioState, iEdge, iStart, iCol + 1);
+        return;
+    }
+
+    if (m_dic.isEndOfWord(iEdge))
+        gaddagRecord(ioState, iStart, iCol);
+
+    if (iCol < BOARD_DIM && ioState.nbTiles)
+        gaddagRight(ioState, iEdge, iStart, iCol + 1);
+}
+
+
+void BoardSearch::gaddagRecord(GaddagState &ioState, int iStart, int iEnd) const
+{
+    // Words which cannot be kept by the results are not even built
+    const PartialScore &score = ioState.score;
+    const int lettersToPlay = m_params.getLettersToPlay();
+    if (score.fromRack > lettersToPlay)
+        return;
+    int points = score.crossPoints + score.mainPoints * score.wordMul;
+    if (score.fromRack == lettersToPlay)
+        points += m_params.getBonusPoints();
+    if (points < ioState.results.getMinScore())
+        return;
+
+    Round word;
+    word.accessCoord().setDir(ioState.dir);
+    word.accessCoord().setRow(ioState.row);
+    word.accessCoord().setCol(iStart);
+    for (int col = iStart; col <= iEnd; ++col)
+    {
+        if (ioState.fromRack[col])
+        {
+            word.addRightFromRack(m_dic.getTileFromCode(ioState.codes[col]),
+                                  ioState.joker[col]);
+        }
+        else
+            word.addRightFromBoard(m_tilesMx[ioState.row][col]);
+    }
+    evalMove(ioState.results, word, score);
+}
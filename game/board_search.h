@@ -21,8 +21,9 @@
 #ifndef BOARD_SEARCH_H_
 #define BOARD_SEARCH_H_
 
+#include <stdint.h>
 #include "coord.h"
-#include "matrix.h"
+#include "board.h"
 
 class Dictionary;
 class GameParams;
@@ -38,32 +39,169 @@ class BoardSearch
 public:
     BoardSearch(const Dictionary &iDic,
                 const GameParams &iParams,
-                const Matrix<Tile> &iTilesMx,
-                const Matrix<Cross> &iCrossMx,
-                const Matrix<int> &iPointsMx,
-                const Matrix<bool> &iJokerMx,
+                const TileGrid &iTilesMx,
+                const CrossGrid &iCrossMx,
+                const IntGrid &iPointsMx,
+                const BoolGrid &iJokerMx,
                 bool isFirstTurn = false);
 
     void search(Rack &iRack, Results &oResults, Coord::Direction iDir) const;
 
+    /**
+     * Search the moves of the given row (or column, depending on iDir).
+     * The searches of different rows are independent, so they can be
+     * performed in parallel (with a different rack and different results
+     * for each thread). Not usable for the first turn.
+     */
+    void searchRow(Rack &iRack, Results &oResults,
+                   Coord::Direction iDir, int iRow) const;
+
 private:
     const Dictionary &m_dic;
     const GameParams &m_params;
-    const Matrix<Tile> &m_tilesMx;
-    const Matrix<Cross> &m_crossMx;
-    const Matrix<int> &m_pointsMx;
-    const Matrix<bool> &m_jokerMx;
+    const TileGrid &m_tilesMx;
+    const CrossGrid &m_crossMx;
+    const IntGrid &m_pointsMx;
+    const BoolGrid &m_jokerMx;
     const bool m_firstTurn;
 
+    /**
+     * Anchors of each row, as a mask of bits indexed by the column.
+     * They are computed for all the rows at once in the constructor,
+     * using masks of the occupied squares of each row.
+     */
+    uint32_t m_anchors[BOARD_DIM + 2];
+
+    void computeAnchors();
+
+    /**
+     * Score tables, computed once in the constructor so that the scores
+     * can be built incrementally during the search without going through
+     * the dictionary header and the board layout.
+     * Like the other grids, they are indexed in the search orientation.
+     */
+    //@{
+    /// Points of the letters, indexed by their code (stored on 6 bits)
+    int m_letterPoints[64];
+    /// Letter and word multipliers of the squares
+    IntGrid m_letterMul;
+    IntGrid m_wordMul;
+    /**
+     * Points of a tile placed from the rack on a square, for the word
+     * in the other direction, are m_crossBase + letter points * m_crossMul
+     * (both are 0 when the tile does not form such a word)
+     */
+    IntGrid m_crossBase;
+    IntGrid m_crossMul;
+    /// Points of the tiles on the board (0 for empty squares and jokers)
+    IntGrid m_boardPoints;
+    //@}
+
+    void computeTables();
+
+    /**
+     * Score pruning.
+     * During the search, the points of the tiles already placed are
+     * accumulated in a PartialScore, and an upper bound of the score
+     * reachable by completing the word is computed with the ScoreBounds
+     * of the row. When this bound is lower than Results::getMinScore(),
+     * the moves would be ignored anyway, so they are not generated.
+     */
+    //@{
+    struct ScoreBounds;
+
+    /// Points of the tiles already placed in a partial word
+    struct PartialScore
+    {
+        PartialScore()
+            : mainPoints(0), wordMul(1), crossPoints(0), fromRack(0) {}
+
+        /// Points of the main word, without the word multiplier
+        int mainPoints;
+        /// Word multiplier of the main word
+        int wordMul;
+        /// Points of the words formed in the other direction
+        int crossPoints;
+        /// Number of tiles played from the rack
+        int fromRack;
+    };
+
+    struct BoundsBuilder;
+
+    /// Compute the bounds for the given row and rack
+    void computeBounds(const Rack &iRack, int iRow,
+                       ScoreBounds &oBounds) const;
+
+    /**
+     * Compute the bounds of the columns iLimit to iAnchor for the left
+     * part of a GADDAG word: for a column c, only the squares from iLimit
+     * to c and the squares after iAnchor are taken into account.
+     * The rack part of ioBounds must already be filled.
+     */
+    void computeLeftBounds(int iRow, int iAnchor, int iLimit,
+                           ScoreBounds &ioBounds) const;
+
+    /// Add the square to the ones accumulated in ioBuilder
+    void addBoundSquare(BoundsBuilder &ioBuilder, int iRow, int iCol) const;
+
+    /**
+     * Return an upper bound of the score of any word completing the
+     * partial word, with at most iRackSize tiles from the rack placed
+     * on the squares of the row starting at column iCol
+     */
+    int getMaxScore(const ScoreBounds &iBounds, const PartialScore &iScore,
+                    int iCol, unsigned int iRackSize) const;
+
+    /// Add to ioScore the points of a tile (given by its code) placed
+    /// from the rack
+    void addRackTile(PartialScore &ioScore, int iRow, int iCol,
+                     unsigned int iCode, bool iJoker) const;
+
+    /// Add to ioScore the points of the tile on the board
+    void addBoardTile(PartialScore &ioScore, int iRow, int iCol) const;
+    //@}
+
     void leftPart(Rack &iRack, Round &ioPartialWord,
                   Results &oResults, int n, int iRow,
-                  int iAnchor, int iLimit) const;
+                  int iAnchor, int iLimit,
+                  const ScoreBounds &iBounds) const;
 
     void extendRight(Rack &iRack, Round &ioPartialWord,
                      Results &oResults, unsigned int iNode,
-                     int iRow, int iCol, int iAnchor) const;
+                     int iRow, int iCol, int iAnchor,
+                     const ScoreBounds &iBounds,
+                     const PartialScore &iScore) const;
+
+    /**
+     * Add the given word to the results, if it does not use too many
+     * letters from the rack. iScore must contain the points of all
+     * the tiles of the word
+     */
+    void evalMove(Results &oResults, Round &iWord,
+                  const PartialScore &iScore) const;
+
+    /// Return true if the given square is an anchor
+    bool isAnchor(int iRow, int iCol) const;
 
-    void evalMove(Results &oResults, Round &iWord) const;
+    /**
+     * GADDAG-based search (used when the dictionary has a GADDAG part).
+     * The moves are built from the anchor, first to the left (reading the
+     * reversed prefix in the GADDAG), then to the right after the separator.
+     * The left part never goes past the previous anchor of the row, so each
+     * move is generated only once, from the leftmost anchor it covers.
+     * The recursion works on the letter codes and on masks of letters
+     * (see Cross), without converting them into tiles.
+     */
+    //@{
+    struct GaddagState;
+    void gaddagLeft(GaddagState &ioState, unsigned int iNode, int iCol) const;
+    void gaddagLeftNext(GaddagState &ioState, unsigned int iEdge, int iCol) const;
+    void gaddagRight(GaddagState &ioState, unsigned int iNode,
+                     int iStart, int iCol) const;
+    void gaddagRightNext(GaddagState &ioState, unsigned int iEdge,
+                         int iStart, int iCol) const;
+    void gaddagRecord(GaddagState &ioState, int iStart, int iEnd) const;
+    //@}
 };
 
 #endif
@@ -23,7 +23,7 @@
 #include <cstdio>
 #include "cross.h"
 
-#define CROSS_MASK 0xFFFFFFFF
+#define CROSS_MASK ((uint64_t)-1)
 
 
 INIT_LOGGER(game, Cross);
@@ -50,8 +50,13 @@ bool Cross::isAny() const
 
 string Cross::getHexContent() const
 {
-    char buff[10];
-    sprintf(buff,"%08x",m_mask);
+    char buff[20];
+    // Keep the historical 32 bits format when possible (it is used in
+    // the regression tests)
+    if (isAny() || (m_mask >> 32) == 0)
+        sprintf(buff, "%08x", (unsigned int)m_mask);
+    else
+        sprintf(buff, "%016llx", (unsigned long long)m_mask);
     string s(buff);
     return s;
 }
@@ -59,13 +64,13 @@ string Cross::getHexContent() const
 
 bool Cross::check(const Tile& iTile) const
 {
-    return m_mask & (1 << iTile.toCode()) || (iTile.isPureJoker() && m_mask);
+    return (m_mask & GetTileBit(iTile)) || (iTile.isPureJoker() && m_mask);
 }
 
 
 void Cross::insert(const Tile& iTile)
 {
-    m_mask |= (1 << iTile.toCode());
+    m_mask |= GetTileBit(iTile);
 }
 
 
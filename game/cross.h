@@ -23,6 +23,7 @@
 #define CROSS_H_
 
 #include <set>
+#include <stdint.h>
 #include "tile.h"
 #include "logging.h"
 
@@ -33,7 +34,11 @@ using namespace std;
  *
  *************************/
 
-// TODO: implement using the bitset class
+/**
+ * Set of tiles accepted on a square, represented as a mask of bits
+ * indexed by the tile codes (there are at most 63 different letters in
+ * a dictionary, so 64 bits are enough).
+ */
 class Cross
 {
     DEFINE_LOGGER();
@@ -48,6 +53,18 @@ public:
 
     bool check(const Tile& iTile) const;
 
+    /**
+     * Return true if at least one of the letters of the given mask is
+     * accepted. The mask is typically built with Rack::getLetterMask().
+     */
+    bool checkMask(uint64_t iLetterMask) const { return m_mask & iLetterMask; }
+
+    /// Same as check(), for the letter with the given code (not a joker)
+    bool checkCode(unsigned int iCode) const { return m_mask & ((uint64_t)1 << iCode); }
+
+    /// Return the bit corresponding to the given tile in the masks
+    static uint64_t GetTileBit(const Tile &iTile) { return (uint64_t)1 << iTile.toCode(); }
+
     bool operator==(const Cross &iOther) const;
     bool operator!=(const Cross &iOther) const { return !(*this == iOther); }
 
@@ -57,7 +74,7 @@ public:
     string getHexContent() const;
 private:
     /// Mask indicating which tiles are accepted for the cross check
-    unsigned int m_mask;
+    uint64_t m_mask;
 };
 
 #endif
@@ -45,6 +45,7 @@
 #include "cmd/game_move_cmd.h"
 #include "cmd/master_move_cmd.h"
 #include "ai_player.h"
+#include "ai_percent.h"
 #include "navigation.h"
 #include "turn.h"
 #include "turn_data.h"
@@ -91,7 +92,7 @@ int Duplicate::play(const wstring &iCoord, const wstring &iWord)
 }
 
 
-void Duplicate::playAI(unsigned int p)
+void Duplicate::playAI(unsigned int p, const Results *iAllResults)
 {
     ASSERT(p < getNPlayers(), "Wrong player number");
     ASSERT(!hasPlayed(p), "AI player has already played");
@@ -99,7 +100,10 @@ void Duplicate::playAI(unsigned int p)
     AIPlayer *player = dynamic_cast<AIPlayer*>(m_players[p]);
     ASSERT(player != NULL, "AI requested for a human player");
 
-    player->compute(getDic(), getBoard(), getHistory().beforeFirstRound());
+    if (iAllResults != NULL)
+        player->compute(*iAllResults);
+    else
+        player->compute(getDic(), getBoard(), getHistory().beforeFirstRound());
     const Move &move = player->getMove();
     if (move.isChangeLetters() || move.isPass())
     {
@@ -183,11 +187,42 @@ void Duplicate::tryEndTurn()
     // make AI players play their turn
     // Some may have already played, in arbitration mode, if the future turns
     // were removed (because of the isHumanIndependent() behaviour)
+    vector<unsigned int> aiPlayers;
     for (unsigned int i = 0; i < getNPlayers(); i++)
     {
         if (!m_players[i]->isHuman() && !hasPlayed(i))
+            aiPlayers.push_back(i);
+    }
+    if (aiPlayers.size() == 1)
+        playAI(aiPlayers[0]);
+    else if (aiPlayers.size() > 1)
+    {
+        // All the players have the same rack, so a single search is shared
+        // between the AI players, each of them choosing its move according
+        // to its level. The search keeps the rounds kept by the lowest level,
+        // which include the ones kept by the higher levels, so it can still
+        // skip the moves with a too low score.
+        const AIPercent *lowestAI = NULL;
+        bool allPercent = true;
+        BOOST_FOREACH(unsigned int i, aiPlayers)
+        {
+            const AIPercent *ai = dynamic_cast<const AIPercent*>(m_players[i]);
+            if (ai == NULL)
+                allPercent = false;
+            else if (lowestAI == NULL || ai->getPercent() < lowestAI->getPercent())
+                lowestAI = ai;
+        }
+        // Without knowing the rules of all the players, keep all the rounds
+        FilterResults allResults(allPercent ? lowestAI->createFilter() : NULL);
+
+        const Rack &rack = m_players[aiPlayers[0]]->getCurrentRack().getRack();
+        allResults.search(getDic(), getBoard(), rack,
+                          getHistory().beforeFirstRound());
+        BOOST_FOREACH(unsigned int i, aiPlayers)
         {
-            playAI(i);
+            ASSERT(m_players[i]->getCurrentRack().getRack() == rack,
+                   "AI players with different racks");
+            playAI(i, &allResults);
         }
     }
 
@@ -277,7 +312,7 @@ void Duplicate::endTurn()
         {
             // If nobody played a valid round, we are forced to play a valid move.
             // So let's take the best one...
-            MasterResults results(getBag());
+            MasterResults results(getBag(), getLeaveTable());
             // Take the first player's rack
             const Rack &rack =
                 m_players[REF_PLAYER_ID]->getLastRack().getRack();
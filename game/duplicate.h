@@ -28,6 +28,7 @@
 class Player;
 class Move;
 class PlayerEventCmd;
+class Results;
 
 using std::string;
 using std::wstring;
@@ -152,8 +153,13 @@ private: // Used by friend classes
     bool isArbitrationGame() const;
 
 private:
-    /// Make the AI player whose ID is p play its turn
-    void playAI(unsigned int p);
+    /**
+     * Make the AI player whose ID is p play its turn.
+     * If iAllResults is given, it must contain all the rounds playable
+     * with the rack of the player, and the move is chosen among them
+     * instead of performing a new search
+     */
+    void playAI(unsigned int p, const Results *iAllResults = NULL);
 
     /**
      * Find the player who scored the most  (with a valid move) at this turn.
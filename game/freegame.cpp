@@ -82,6 +82,8 @@ void FreeGame::playAI(unsigned int p)
 
     AIPlayer *player = static_cast<AIPlayer*>(m_players[p]);
 
+    // The tiles kept on the rack are important in this mode
+    player->setLeaveTable(getLeaveTable());
     player->compute(getDic(), getBoard(), getHistory().beforeFirstRound());
     const Move &move = player->getMove();
     if (move.isChangeLetters() || move.isPass())
@@ -269,7 +271,7 @@ int FreeGame::checkPass(const Player &iPlayer,
     // It is forbidden to change letters when the bag does not contain at
     // least 7 letters (this is explicitly stated in the ODS). But it is
     // still allowed to pass
-    Bag bag(getDic());
+    Bag bag(m_bag);
     realBag(bag);
     if (bag.getNbTiles() < 7 && !iToChange.empty())
     {
@@ -37,6 +37,7 @@
 #include "round.h"
 #include "pldrack.h"
 #include "results.h"
+#include "leave_table.h"
 #include "player.h"
 #include "game.h"
 #include "turn_data.h"
@@ -54,7 +55,8 @@ INIT_LOGGER(game, Game);
 
 Game::Game(const GameParams &iParams, const Game *iMasterGame):
     m_params(iParams), m_masterGame(iMasterGame),
-    m_board(m_params), m_bag(iParams.getDic())
+    m_board(m_params), m_bag(iParams.getDic()),
+    m_leaveTable(LeaveTable::GetTable(iParams.getDic()))
 {
     m_points = 0;
     m_currPlayer = 0;
@@ -89,7 +91,7 @@ void Game::shuffleRack()
 {
     LOG_DEBUG("Shuffling rack for player " << currPlayer());
     PlayedRack pld = getCurrentPlayer().getCurrentRack();
-    pld.shuffle();
+    pld.shuffle(m_random);
     m_players[currPlayer()]->setCurrentRack(pld);
 }
 
@@ -163,7 +165,7 @@ bool Game::canDrawRack(const PlayedRack &iPld, bool iCheck, int *reason) const
     // Create a copy of the bag in which we can do everything we want,
     // and take from it the tiles of the players rack so that "bag"
     // contains the right number of tiles.
-    Bag bag(getDic());
+    Bag bag(m_bag);
     realBag(bag);
     // Replace all the tiles of the given rack into the bag
     vector<Tile> tiles;
@@ -285,7 +287,7 @@ PlayedRack Game::helperSetRackRandom(const PlayedRack &iPld,
     // Create a copy of the bag in which we can do everything we want,
     // and take from it the tiles of the players rack so that "bag"
     // contains the right number of tiles.
-    Bag bag(getDic());
+    Bag bag(m_bag);
     realBag(bag);
     if (mode == RACK_NEW && nold != 0)
     {
@@ -370,7 +372,7 @@ PlayedRack Game::helperSetRackRandom(const PlayedRack &iPld,
     // requirements will be met.
     while (bag.getNbTiles() != 0 && pld.getNbTiles() < RACK_SIZE)
     {
-        const Tile &l = bag.selectRandom();
+        const Tile &l = bag.selectRandom(m_random);
         bag.takeTile(l);
         pld.addNew(l);
     }
@@ -417,7 +419,7 @@ PlayedRack Game::helperSetRackRandom(const PlayedRack &iPld,
         // Get the required vowels and consonants first
         for (unsigned int i = 0; i < neededVowels; ++i)
         {
-            const Tile &l = bag.selectRandomVowel();
+            const Tile &l = bag.selectRandomVowel(m_random);
             bag.takeTile(l);
             pld.addNew(l);
             // Handle the case where the vowel can also be considered
@@ -427,7 +429,7 @@ PlayedRack Game::helperSetRackRandom(const PlayedRack &iPld,
         }
         for (unsigned int i = 0; i < neededConsonants; ++i)
         {
-            const Tile &l = bag.selectRandomConsonant();
+            const Tile &l = bag.selectRandomConsonant(m_random);
             bag.takeTile(l);
             pld.addNew(l);
         }
@@ -438,7 +440,7 @@ PlayedRack Game::helperSetRackRandom(const PlayedRack &iPld,
         // Now complete the rack with truly random letters
         while (bag.getNbTiles() != 0 && pld.getNbTiles() < RACK_SIZE)
         {
-            const Tile &l = bag.selectRandom();
+            const Tile &l = bag.selectRandom(m_random);
             bag.takeTile(l);
             pld.addNew(l);
         }
@@ -451,7 +453,7 @@ PlayedRack Game::helperSetRackRandom(const PlayedRack &iPld,
     {
         const Rack &rack = pld.getRack();
 
-        MasterResults res(getBag());
+        MasterResults res(getBag(), getLeaveTable());
         res.search(getDic(), getBoard(), rack,  getHistory().beforeFirstRound());
         if (!res.isEmpty())
         {
@@ -481,7 +483,7 @@ PlayedRack Game::helperSetRackRandom(const PlayedRack &iPld,
                 // The joker was not needed for the top. Replace it with a
                 // randomly selected tile
                 LOG_DEBUG("helperSetRackRandom(): joker not needed for the top");
-                replacingTile = bag.selectRandom();
+                replacingTile = bag.selectRandom(m_random);
             }
 
             LOG_DEBUG("helperSetRackRandom(): replacing Joker with "
@@ -510,7 +512,7 @@ PlayedRack Game::helperSetRackRandom(const PlayedRack &iPld,
     // Shuffle the new tiles, to hide the order we imposed (joker first in a
     // joker game, then needed vowels, then needed consonants, and rest of the
     // rack)
-    pld.shuffleNew();
+    pld.shuffleNew(m_random);
 
     // Post-condition check. This should never fail, of course :)
     ASSERT(pld.checkRack(min, min), "helperSetRackRandom() is buggy!");
@@ -632,6 +634,11 @@ int Game::checkPlayedWord(const wstring &iCoord,
         return 3;
     }
 
+    // The word cannot be longer than the board (this also guarantees
+    // that it fits in the Round)
+    if (iWord.size() > BOARD_DIM)
+        return 12;
+
     // Set the word
     // TODO: make this a Round_ function (Round_setwordfromchar for example)
     // or a Tiles_ function (to transform a char* into a vector<Tile>)
@@ -24,9 +24,11 @@
 
 #include <string>
 #include <vector>
+#include <boost/shared_ptr.hpp>
 #include "game_params.h"
 #include "logging.h"
 #include "bag.h"
+#include "random.h"
 #include "board.h"
 #include "history.h"
 #include "navigation.h"
@@ -38,6 +40,7 @@ class PlayedRack;
 class Round;
 class Rack;
 class TurnData;
+class LeaveTable;
 
 using namespace std;
 
@@ -81,6 +84,18 @@ public:
     /// Get the bag
     const Bag& getBag() const { return m_bag; }
     Bag & accessBag() { return m_bag; }
+    /**
+     * Get the random generator, used to draw the racks.
+     * It is in legacy mode (i.e. it uses rand()) unless it is seeded
+     */
+    const Random & getRandom() const { return m_random; }
+    Random & accessRandom() { return m_random; }
+    /**
+     * Get the leave table (see LeaveTable), or an empty pointer if there
+     * is none. It is given by the settings when the game is created, and
+     * it is kept for the whole game.
+     */
+    const boost::shared_ptr<const LeaveTable> & getLeaveTable() const { return m_leaveTable; }
     /**
      * The realBag is the current bag minus all the racks
      * present in the game. It represents the actual
@@ -183,6 +198,7 @@ public:
     enum set_rack_mode {RACK_ALL, RACK_NEW};
 
     void addPoints(int iPoints) { m_points += iPoints; }
+    int getPoints() const { return m_points; }
 
     const Navigation & getNavigation() const { return m_navigation; }
     Navigation & accessNavigation() { return m_navigation; }
@@ -253,6 +269,12 @@ protected:
     /// Bag
     Bag m_bag;
 
+    /// Random generator (mutable, because drawing a rack is const)
+    mutable Random m_random;
+
+    /// Leave table (see getLeaveTable())
+    boost::shared_ptr<const LeaveTable> m_leaveTable;
+
     /**
      * Protected constructor.
      * The iMasterGame parameter is optional (i.e. it can be NULL).
@@ -0,0 +1,223 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2013 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#include <boost/format.hpp>
+
+#include "config.h"
+#if ENABLE_NLS
+#   include <libintl.h>
+#   define _(String) gettext(String)
+#else
+#   define _(String) String
+#endif
+
+#include "game_archive.h"
+#include "binary_format.h"
+#include "binary_writer.h"
+#include "binary_reader.h"
+#include "game_exception.h"
+
+#define FMT1(s, a1) (boost::format(s) % (a1)).str()
+
+
+using namespace std;
+using namespace BinaryFormat;
+
+INIT_LOGGER(game, GameArchiveWriter);
+INIT_LOGGER(game, GameArchive);
+
+// Size of the archive header
+static const unsigned kHEADER_SIZE = kMAGIC_SIZE + 2 + 2 + 4 + 8;
+// Size of an entry of the game table
+static const unsigned kENTRY_SIZE = 8 + 4;
+
+
+static string buildHeader(unsigned iNbGames, uint64_t iTableOffset)
+{
+    string header(kARCHIVE_MAGIC, kMAGIC_SIZE);
+    putU16(header, kCURRENT_VERSION);
+    putU16(header, 0);
+    putU32(header, iNbGames);
+    putU64(header, iTableOffset);
+    return header;
+}
+
+
+GameArchiveWriter::GameArchiveWriter(const string &iFileName)
+    : m_fileName(iFileName), m_pos(0)
+{
+    LOG_INFO("Creating game archive '" << iFileName << "'");
+    m_out.open(iFileName.c_str(), ios::out | ios::binary | ios::trunc);
+    if (!m_out.is_open())
+        throw SaveGameException(FMT1(_("Cannot open file for writing: '%1%'"), iFileName));
+
+    // The header is written again when closing the archive
+    const string &header = buildHeader(0, 0);
+    m_out.write(header.data(), header.size());
+    m_pos = header.size();
+}
+
+
+GameArchiveWriter::~GameArchiveWriter()
+{
+    if (m_out.is_open())
+    {
+        try
+        {
+            close();
+        }
+        catch (const std::exception &e)
+        {
+            LOG_ERROR("Error closing game archive: " << e.what());
+        }
+    }
+}
+
+
+void GameArchiveWriter::add(const Game &iGame)
+{
+    if (!m_out.is_open())
+        throw SaveGameException(_("The game archive is already closed"));
+
+    const string &record = BinaryWriter::encode(iGame);
+    m_out.write(record.data(), record.size());
+    if (!m_out.good())
+        throw SaveGameException(FMT1(_("Error while writing file '%1%'"), m_fileName));
+    m_offsets.push_back(m_pos);
+    m_sizes.push_back(record.size());
+    m_pos += record.size();
+}
+
+
+void GameArchiveWriter::close()
+{
+    if (!m_out.is_open())
+        return;
+
+    string table;
+    for (unsigned i = 0; i < m_offsets.size(); ++i)
+    {
+        putU64(table, m_offsets[i]);
+        putU32(table, m_sizes[i]);
+    }
+    m_out.write(table.data(), table.size());
+
+    const string &header = buildHeader(m_offsets.size(), m_pos);
+    m_out.seekp(0);
+    m_out.write(header.data(), header.size());
+
+    bool ok = m_out.good();
+    m_out.close();
+    if (!ok)
+        throw SaveGameException(FMT1(_("Error while writing file '%1%'"), m_fileName));
+    LOG_INFO("Game archive closed (" << m_offsets.size() << " games)");
+}
+
+
+GameArchive::GameArchive(const string &iFileName)
+    : m_fileName(iFileName)
+{
+    m_in.open(iFileName.c_str(), ios::in | ios::binary);
+    if (!m_in.is_open())
+        throw LoadGameException(FMT1(_("Cannot open file '%1%'"), iFileName));
+
+    string header(kHEADER_SIZE, '\0');
+    if (!m_in.read(&header[0], kHEADER_SIZE))
+        throw LoadGameException(_("Not a game archive"));
+    Input in(header);
+    if (in.getBytes(kMAGIC_SIZE) != string(kARCHIVE_MAGIC, kMAGIC_SIZE))
+        throw LoadGameException(_("Not a game archive"));
+    unsigned version = in.getU16();
+    if (version != kCURRENT_VERSION)
+    {
+        LOG_ERROR("Incompatible game archive format: current="
+                  << kCURRENT_VERSION << " archive=" << version);
+        throw LoadGameException(_("This game archive is not compatible with the current version of Eliot."));
+    }
+    in.getU16();
+    uint64_t nbGames = in.getU32();
+    uint64_t tableOffset = in.getU64();
+
+    // Check the values of the header before using them, to detect
+    // a truncated or corrupted file
+    m_in.seekg(0, ios::end);
+    uint64_t fileSize = m_in.tellg();
+    if (tableOffset < kHEADER_SIZE || tableOffset > fileSize ||
+        nbGames * kENTRY_SIZE > fileSize - tableOffset)
+    {
+        throw LoadGameException(_("Truncated game archive"));
+    }
+
+    // Read the game table
+    string table(nbGames * kENTRY_SIZE, '\0');
+    m_in.seekg(tableOffset);
+    if (nbGames > 0 && !m_in.read(&table[0], table.size()))
+        throw LoadGameException(_("Truncated game archive"));
+    Input tableIn(table);
+    m_offsets.reserve(nbGames);
+    m_sizes.reserve(nbGames);
+    for (unsigned i = 0; i < nbGames; ++i)
+    {
+        uint64_t offset = tableIn.getU64();
+        uint32_t size = tableIn.getU32();
+        if (offset < kHEADER_SIZE || offset > tableOffset ||
+            size > tableOffset - offset)
+        {
+            throw LoadGameException(_("Invalid game table in game archive"));
+        }
+        m_offsets.push_back(offset);
+        m_sizes.push_back(size);
+    }
+    LOG_DEBUG("Game archive '" << iFileName << "' opened ("
+              << nbGames << " games)");
+}
+
+
+void GameArchive::getRecord(unsigned iGame, string &oData)
+{
+    if (iGame >= getNbGames())
+        throw LoadGameException(FMT1(_("Invalid game number: %1%"), iGame));
+
+    oData.assign(m_sizes[iGame], '\0');
+    m_in.clear();
+    m_in.seekg(m_offsets[iGame]);
+    if (!oData.empty() && !m_in.read(&oData[0], oData.size()))
+        throw LoadGameException(_("Truncated game archive"));
+}
+
+
+Game * GameArchive::loadGame(unsigned iGame, const Dictionary &iDic)
+{
+    string data;
+    getRecord(iGame, data);
+    BinaryReader reader(data, iDic);
+    return reader.buildGame();
+}
+
+
+bool GameArchive::IsArchiveFile(const string &iFileName)
+{
+    ifstream is(iFileName.c_str(), ios::in | ios::binary);
+    char magic[kMAGIC_SIZE];
+    if (!is.read(magic, kMAGIC_SIZE))
+        return false;
+    return string(magic, kMAGIC_SIZE) == string(kARCHIVE_MAGIC, kMAGIC_SIZE);
+}
+
@@ -0,0 +1,105 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2013 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#ifndef GAME_ARCHIVE_H_
+#define GAME_ARCHIVE_H_
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <stdint.h>
+
+#include "logging.h"
+
+class Dictionary;
+class Game;
+
+using std::string;
+using std::vector;
+
+
+/**
+ * A game archive is a file containing several games, in the binary
+ * format of BinaryWriter.
+ *
+ * Layout of the file:
+ *  - header: magic (4 bytes), format version (16 bits), unused (16 bits),
+ *    number of games (32 bits), offset of the game table (64 bits)
+ *  - the game records, one after the other
+ *  - the game table: for each game, the offset (64 bits) and the size
+ *    (32 bits) of its record
+ *
+ * Thanks to the game table, and to the turn index of each record, any game
+ * or turn can be accessed directly, without reading the previous ones.
+ */
+class GameArchiveWriter
+{
+    DEFINE_LOGGER();
+public:
+    /// Create the archive (an existing file is overwritten)
+    GameArchiveWriter(const string &iFileName);
+    /// Close the archive, if needed
+    ~GameArchiveWriter();
+
+    /// Add a game at the end of the archive
+    void add(const Game &iGame);
+
+    /// Write the game table. No game can be added afterwards
+    void close();
+
+private:
+    string m_fileName;
+    std::ofstream m_out;
+    uint64_t m_pos;
+    vector<uint64_t> m_offsets;
+    vector<uint32_t> m_sizes;
+};
+
+
+class GameArchive
+{
+    DEFINE_LOGGER();
+public:
+    /// Open an existing archive, and read its game table
+    GameArchive(const string &iFileName);
+
+    unsigned getNbGames() const { return m_offsets.size(); }
+
+    /**
+     * Read the record of the given game (starting from 0).
+     * It can be given to a BinaryReader, to access the turns of the game
+     */
+    void getRecord(unsigned iGame, string &oData);
+
+    /// Load the given game (starting from 0)
+    Game * loadGame(unsigned iGame, const Dictionary &iDic);
+
+    /// Return true if the given file looks like a game archive
+    static bool IsArchiveFile(const string &iFileName);
+
+private:
+    string m_fileName;
+    std::ifstream m_in;
+    vector<uint64_t> m_offsets;
+    vector<uint32_t> m_sizes;
+};
+
+#endif
+
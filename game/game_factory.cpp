@@ -47,6 +47,7 @@
 #include "dic.h"
 #include "encoding.h"
 #include "xml_reader.h"
+#include "binary_reader.h"
 
 
 INIT_LOGGER(game, GameFactory);
@@ -243,6 +244,8 @@ Game *GameFactory::createFromCmdLine(int argc, char **argv)
 
 Game* GameFactory::load(const string &iFileName, const Dictionary &iDic)
 {
+    if (BinaryReader::IsBinaryFile(iFileName))
+        return BinaryReader::read(iFileName, iDic);
     return XmlReader::read(iFileName, iDic);
 }
 
@@ -51,7 +51,10 @@ public:
     /// Create a game
     Game *createGame(const GameParams &iParams, const Game *iMasterGame = NULL);
 
-    /// Return the loaded game, or NULL if there was a problem
+    /**
+     * Return the loaded game, or NULL if there was a problem.
+     * The file can be in the XML format or in the binary one
+     */
     Game *load(const string &iFileName, const Dictionary &iDic);
 
     Game *createFromCmdLine(int argc, char **argv);
@@ -0,0 +1,68 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2013 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#ifndef GRID_H_
+#define GRID_H_
+
+#include <algorithm>
+
+
+/**
+ * Square grid of fixed size, stored contiguously (row by row) inside
+ * the object itself: there is no dynamic allocation, and copying a grid
+ * of simple types is a plain memory copy.
+ *
+ * The elements are accessed with the usual grid[row][col] syntax,
+ * where grid[row] gives a pointer to the first element of the row.
+ * Unlike Matrix, the size cannot change after the creation.
+ */
+template <class T, int N>
+class Grid
+{
+public:
+    /// Construct a grid with default-constructed elements
+    Grid()
+    {
+    }
+
+    /// Construct a grid with an initial value
+    explicit Grid(const T &iValue)
+    {
+        fill(iValue);
+    }
+
+    /// Number of rows (and of columns)
+    static int size() { return N; }
+
+    /// Set all the elements to the given value
+    void fill(const T &iValue)
+    {
+        std::fill(&m_cells[0][0], &m_cells[0][0] + N * N, iValue);
+    }
+
+    T * operator[](int iRow) { return m_cells[iRow]; }
+    const T * operator[](int iRow) const { return m_cells[iRow]; }
+
+private:
+    T m_cells[N][N];
+};
+
+#endif
+
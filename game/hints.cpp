@@ -160,7 +160,8 @@ string WordLettersHint::giveHint(const Move &iMove) const
 {
     LOG_DEBUG("Getting hint for move: " << lfw(iMove.toString()));
     ASSERT(iMove.isValid(), "Hints only make sense for valid moves");
-    vector<Tile> tiles = iMove.getRound().getTiles();
+    const Round &round = iMove.getRound();
+    vector<Tile> tiles(round.getTiles(), round.getTiles() + round.getWordLen());
     // Sort the letters (we cannot sort directly the wstring from
     // Round::getWord(), because it would break digraph characters)
     std::sort(tiles.begin(), tiles.end());
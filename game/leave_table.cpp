@@ -0,0 +1,314 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2013 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#include <algorithm>
+#include <fstream>
+#include <boost/format.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/lock_guard.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "config.h"
+#if ENABLE_NLS
+#   include <libintl.h>
+#   define _(String) gettext(String)
+#else
+#   define _(String) String
+#endif
+
+#include "leave_table.h"
+#include "binary_format.h"
+#include "dic.h"
+#include "header.h"
+#include "encoding.h"
+#include "rack.h"
+#include "round.h"
+#include "settings.h"
+#include "game_exception.h"
+#include "debug.h"
+
+#define FMT1(s, a1) (boost::format(s) % (a1)).str()
+
+
+using namespace std;
+using namespace BinaryFormat;
+
+INIT_LOGGER(game, LeaveTable);
+
+/// Magic string at the beginning of a leave table
+static const char kLEAVE_MAGIC[] = "ELLT";
+/// Current version of the format of the leave tables
+static const uint16_t kLEAVE_VERSION = 2;
+/// The header is always smaller than this size
+static const size_t kMAX_HEADER_SIZE = 1024;
+
+
+LeaveHash::LeaveHash(const Dictionary &iDic)
+    : m_nbCodes(iDic.getTileNumber()), m_tiles(iDic.getAllTiles())
+{
+    if (m_nbCodes > kMAX_CODE)
+        throw GameException("Too many letters for a leave table");
+
+    m_bounds[0] = 0;
+    for (unsigned code = 1; code <= m_nbCodes; ++code)
+    {
+        m_bounds[code] = std::min<unsigned>(iDic.getHeader().getFrequency(code),
+                                            kMAX_LEAVE);
+    }
+
+    // Count the leaves of each size, starting from the last code
+    for (unsigned size = 0; size <= kMAX_LEAVE; ++size)
+        m_nbLeaves[m_nbCodes + 1][size] = (size == 0);
+    for (unsigned code = m_nbCodes; code >= 1; --code)
+    {
+        for (unsigned size = 0; size <= kMAX_LEAVE; ++size)
+        {
+            unsigned nb = 0;
+            for (unsigned count = 0; count <= std::min(m_bounds[code], size); ++count)
+                nb += m_nbLeaves[code + 1][size - count];
+            m_nbLeaves[code][size] = nb;
+        }
+    }
+
+    m_offsets[0] = 0;
+    for (unsigned size = 0; size <= kMAX_LEAVE; ++size)
+        m_offsets[size + 1] = m_offsets[size] + m_nbLeaves[1][size];
+}
+
+
+unsigned LeaveHash::getIndex(const unsigned *iCounts) const
+{
+    unsigned size = 0;
+    for (unsigned code = 1; code <= m_nbCodes; ++code)
+    {
+        if (iCounts[code] > m_bounds[code])
+            return kINVALID;
+        size += iCounts[code];
+    }
+    if (size > kMAX_LEAVE)
+        return kINVALID;
+
+    unsigned index = m_offsets[size];
+    unsigned remaining = size;
+    for (unsigned code = 1; remaining > 0; ++code)
+    {
+        // Skip the leaves with the same counts for the previous codes,
+        // and less tiles of this code
+        for (unsigned count = 0; count < iCounts[code]; ++count)
+            index += m_nbLeaves[code + 1][remaining - count];
+        remaining -= iCounts[code];
+    }
+    return index;
+}
+
+
+unsigned LeaveHash::getIndex(const Rack &iLeave) const
+{
+    unsigned counts[kMAX_CODE + 1];
+    for (unsigned code = 1; code <= m_nbCodes; ++code)
+        counts[code] = iLeave.count(m_tiles[code - 1]);
+    return getIndex(counts);
+}
+
+
+unsigned LeaveHash::getIndex(const Rack &iRack, const Round &iRound) const
+{
+    unsigned counts[kMAX_CODE + 1];
+    for (unsigned code = 1; code <= m_nbCodes; ++code)
+        counts[code] = iRack.count(m_tiles[code - 1]);
+
+    // Remove the tiles played by the round
+    for (unsigned i = 0; i < iRound.getWordLen(); ++i)
+    {
+        if (iRound.isPlayedFromRack(i))
+        {
+            const unsigned code = iRound.isJoker(i) ?
+                Tile::Joker().toCode() : iRound.getTile(i).toCode();
+            ASSERT(counts[code] > 0, "The round does not match the rack");
+            --counts[code];
+        }
+    }
+    return getIndex(counts);
+}
+
+
+void LeaveHash::getCounts(unsigned iIndex, unsigned *oCounts) const
+{
+    ASSERT(iIndex < getNbLeaves(), "Invalid leave index");
+
+    unsigned size = 0;
+    while (iIndex >= m_offsets[size + 1])
+        ++size;
+
+    unsigned rank = iIndex - m_offsets[size];
+    unsigned remaining = size;
+    for (unsigned code = 1; code <= m_nbCodes; ++code)
+    {
+        unsigned count = 0;
+        while (rank >= m_nbLeaves[code + 1][remaining - count])
+        {
+            rank -= m_nbLeaves[code + 1][remaining - count];
+            ++count;
+        }
+        ASSERT(count <= m_bounds[code], "Bug in LeaveHash");
+        oCounts[code] = count;
+        remaining -= count;
+    }
+}
+
+
+
+LeaveTable::LeaveTable(const string &iFileName, const Dictionary &iDic)
+    : m_hash(iDic), m_region(NULL), m_values(NULL), m_maxValue(0)
+{
+    using namespace boost::interprocess;
+    try
+    {
+        // The file mapping can be destroyed once the region is mapped
+        file_mapping mapping(iFileName.c_str(), read_only);
+        m_region = new mapped_region(mapping, read_only);
+    }
+    catch (const interprocess_exception &e)
+    {
+        LOG_ERROR("Cannot map the leave table in memory: " << e.what());
+        throw GameException(FMT1(_("Cannot open file '%1%'"), iFileName));
+    }
+
+    try
+    {
+        const char *data = static_cast<const char*>(m_region->get_address());
+        const size_t size = m_region->get_size();
+
+        // Check the header
+        const string header(data, std::min(size, kMAX_HEADER_SIZE));
+        Input in(header);
+        if (in.getBytes(kMAGIC_SIZE) != string(kLEAVE_MAGIC, kMAGIC_SIZE))
+            throw GameException(FMT1(_("Not a leave table: '%1%'"), iFileName));
+        if (in.getU16() != kLEAVE_VERSION || in.getU16() != LeaveHash::kMAX_LEAVE)
+            throw GameException(FMT1(_("Incompatible leave table: '%1%'"), iFileName));
+
+        bool compatible =
+            in.getString() == writeInUTF8(iDic.getHeader().getLetters(), "LeaveTable") &&
+            in.getU8() == m_hash.getNbCodes();
+        for (unsigned code = 1; compatible && code <= m_hash.getNbCodes(); ++code)
+            compatible = in.getU8() == m_hash.getBound(code);
+        if (!compatible || in.getU32() != m_hash.getNbLeaves())
+        {
+            throw GameException(FMT1(_("The leave table '%1%' was not generated "
+                                       "for this dictionary"), iFileName));
+        }
+        m_maxValue = (int16_t)in.getU16();
+        if (size < in.getPos() + 2 * m_hash.getNbLeaves())
+            throw GameException(FMT1(_("Truncated leave table: '%1%'"), iFileName));
+
+        m_values = reinterpret_cast<const unsigned char*>(data + in.getPos());
+    }
+    catch (...)
+    {
+        delete m_region;
+        throw;
+    }
+
+    LOG_INFO("Leave table " << iFileName << " mapped in memory ("
+             << m_hash.getNbLeaves() << " leaves)");
+}
+
+
+LeaveTable::~LeaveTable()
+{
+    delete m_region;
+}
+
+
+/// Table returned by GetTable(), and the key used to load it
+static boost::mutex s_tableMutex;
+static string s_tableKey;
+static boost::shared_ptr<const LeaveTable> s_table;
+
+boost::shared_ptr<const LeaveTable> LeaveTable::GetTable(const Dictionary &iDic)
+{
+    const string &fileName = Settings::Instance().getString("general.leave-table");
+    if (fileName.empty())
+        return boost::shared_ptr<const LeaveTable>();
+
+    // The table is loaded again if the setting or the letters change
+    const Header &header = iDic.getHeader();
+    string key = fileName + '\n' + writeInUTF8(header.getLetters(), "LeaveTable");
+    for (unsigned code = 1; code <= iDic.getTileNumber(); ++code)
+        putU8(key, header.getFrequency(code));
+
+    boost::lock_guard<boost::mutex> lock(s_tableMutex);
+    if (key != s_tableKey)
+    {
+        // In case of error, the table is not loaded again for this key
+        s_tableKey = key;
+        s_table.reset();
+        try
+        {
+            s_table.reset(new LeaveTable(fileName, iDic));
+        }
+        catch (const GameException &e)
+        {
+            LOG_ERROR("Cannot load the leave table: " << e.what());
+        }
+    }
+    return s_table;
+}
+
+
+void LeaveTable::Write(const string &iFileName, const Dictionary &iDic,
+                       const vector<int> &iValues)
+{
+    const LeaveHash hash(iDic);
+    ASSERT(iValues.size() == hash.getNbLeaves(), "Invalid number of leave values");
+
+    string header(kLEAVE_MAGIC, kMAGIC_SIZE);
+    putU16(header, kLEAVE_VERSION);
+    putU16(header, LeaveHash::kMAX_LEAVE);
+    putString(header, writeInUTF8(iDic.getHeader().getLetters(), "LeaveTable::Write"));
+    putU8(header, hash.getNbCodes());
+    for (unsigned code = 1; code <= hash.getNbCodes(); ++code)
+        putU8(header, hash.getBound(code));
+    putU32(header, hash.getNbLeaves());
+
+    string values;
+    values.reserve(2 * iValues.size());
+    int maxValue = -32768;
+    for (unsigned i = 0; i < iValues.size(); ++i)
+    {
+        const int value = std::max(-32768, std::min(32767, iValues[i]));
+        putU16(values, (uint16_t)value);
+        maxValue = std::max(maxValue, value);
+    }
+    // The maximum is stored in the header, to avoid reading all the
+    // values when the table is mapped
+    putU16(header, (uint16_t)maxValue);
+
+    ofstream out(iFileName.c_str(), ios::out | ios::binary | ios::trunc);
+    if (!out.is_open())
+        throw SaveGameException(FMT1(_("Cannot open file for writing: '%1%'"), iFileName));
+    out.write(header.data(), header.size());
+    out.write(values.data(), values.size());
+    if (!out.good())
+        throw SaveGameException(FMT1(_("Error while writing file '%1%'"), iFileName));
+    LOG_INFO("Leave table written in " << iFileName);
+}
+
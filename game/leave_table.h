@@ -0,0 +1,197 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2013 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#ifndef LEAVE_TABLE_H_
+#define LEAVE_TABLE_H_
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <boost/shared_ptr.hpp>
+
+#include "tile.h"
+#include "logging.h"
+
+class Dictionary;
+class Rack;
+class Round;
+namespace boost
+{
+    namespace interprocess
+    {
+        class mapped_region;
+    }
+}
+
+using std::string;
+using std::vector;
+
+
+/**
+ * Minimal perfect hash of the rack leaves (i.e. the tiles kept on the rack
+ * after playing a move).
+ *
+ * Each multiset of at most kMAX_LEAVE tiles, with at most the number of
+ * tiles of each letter in the bag, gets its own index between 0 and
+ * getNbLeaves() - 1. The index is the rank of the leave when the leaves are
+ * sorted by size, then by number of tiles of each code (combinatorial
+ * number system), so it is computed with a few additions, without any
+ * collision.
+ *
+ * The leaves are given as arrays of counts, indexed by tile codes.
+ */
+class LeaveHash
+{
+public:
+    /// Maximum number of tiles in a leave (a move uses at least one tile)
+    static const unsigned kMAX_LEAVE = 6;
+    /// Maximum tile code (see Bag)
+    static const unsigned kMAX_CODE = 63;
+    /// Index returned for leaves which are not in the table
+    static const unsigned kINVALID = ~0u;
+
+    /// A GameException is thrown if the dictionary has too many letters
+    explicit LeaveHash(const Dictionary &iDic);
+
+    /// Number of tile codes (the codes go from 1 to getNbCodes())
+    unsigned getNbCodes() const { return m_nbCodes; }
+
+    /// Maximum number of tiles of the given code in a leave
+    unsigned getBound(unsigned iCode) const { return m_bounds[iCode]; }
+
+    /// Number of different leaves
+    unsigned getNbLeaves() const { return m_offsets[kMAX_LEAVE + 1]; }
+
+    /**
+     * Return the index of the leave, given the number of tiles of each code
+     * (array of kMAX_CODE + 1 values, the first one being ignored),
+     * or kINVALID if the leave has too many tiles.
+     */
+    unsigned getIndex(const unsigned *iCounts) const;
+
+    /// Return the index of the given leave
+    unsigned getIndex(const Rack &iLeave) const;
+
+    /// Return the index of the leave of iRack after playing iRound
+    unsigned getIndex(const Rack &iRack, const Round &iRound) const;
+
+    /// Inverse of getIndex(): fill the counts of the leave with the given index
+    void getCounts(unsigned iIndex, unsigned *oCounts) const;
+
+private:
+    unsigned m_nbCodes;
+    /// One tile of each code, to count them in the racks
+    vector<Tile> m_tiles;
+    unsigned m_bounds[kMAX_CODE + 2];
+    /// Number of leaves of each size using only the codes >= the first index
+    unsigned m_nbLeaves[kMAX_CODE + 2][kMAX_LEAVE + 1];
+    /// Index of the first leave of each size
+    unsigned m_offsets[kMAX_LEAVE + 2];
+};
+
+
+/**
+ * Table giving the value of each rack leave (see LeaveHash), in tenths of
+ * points. The value of a leave estimates how many points it will bring in
+ * the next turn, compared to an average leave, so the equity of a move is
+ * its score plus the value of its leave.
+ *
+ * The tables are generated offline by the leavegen tool, from self-play
+ * games (see LeaveTableBuilder), and they depend on the letters of the
+ * dictionary and on their frequencies. They are used to choose the master
+ * moves in duplicate mode (see MoveSelector), and by the best AI players
+ * in free game mode (see EquityResults).
+ *
+ * The file is memory-mapped, so loading it is immediate, and the pages are
+ * shared between the processes using it. It contains, with all the integers
+ * in little-endian order:
+ *  - header: magic (4 bytes), version (16 bits), maximum size of the
+ *    leaves (16 bits), letters of the dictionary (UTF-8, preceded by their
+ *    size on 16 bits), number of codes (8 bits) then the maximum number of
+ *    tiles of each code in a leave (8 bits each), number of leaves (32 bits),
+ *    highest value of the table (signed, 16 bits)
+ *  - values: one signed value (16 bits) for each leave, in the order of
+ *    their index
+ */
+class LeaveTable
+{
+    DEFINE_LOGGER();
+public:
+    /**
+     * Map the given table in memory.
+     * A GameException is thrown if the file is not a valid leave table,
+     * or if it was generated for other letters than the ones of iDic.
+     */
+    LeaveTable(const string &iFileName, const Dictionary &iDic);
+    ~LeaveTable();
+
+    /// Value of the given leave (0 for leaves with too many tiles)
+    int getValue(const Rack &iLeave) const
+    {
+        return getValueAt(m_hash.getIndex(iLeave));
+    }
+
+    /// Value of the leave of iRack after playing iRound
+    int getValue(const Rack &iRack, const Round &iRound) const
+    {
+        return getValueAt(m_hash.getIndex(iRack, iRound));
+    }
+
+    /// Highest value of the table
+    int getMaxValue() const { return m_maxValue; }
+
+    /**
+     * Return the leave table to use with the given dictionary, according
+     * to the "general.leave-table" setting, or an empty pointer if there is
+     * no table (or if it cannot be loaded, the error being logged).
+     * The table is loaded once, and shared by all the callers.
+     */
+    static boost::shared_ptr<const LeaveTable> GetTable(const Dictionary &iDic);
+
+    /**
+     * Write a table for the given dictionary, with the values of the leaves
+     * in the order of their index (they are clamped to 16 bits).
+     * A SaveGameException is thrown if the file cannot be written.
+     */
+    static void Write(const string &iFileName, const Dictionary &iDic,
+                      const vector<int> &iValues);
+
+private:
+    const LeaveHash m_hash;
+    boost::interprocess::mapped_region *m_region;
+    /// Values of the leaves, in the mapped region
+    const unsigned char *m_values;
+    int m_maxValue;
+
+    int getValueAt(unsigned iIndex) const
+    {
+        if (iIndex == LeaveHash::kINVALID)
+            return 0;
+        const unsigned char *value = m_values + 2 * iIndex;
+        return (int16_t)(value[0] | (value[1] << 8));
+    }
+
+    // Prevent from copying
+    LeaveTable(const LeaveTable&);
+    LeaveTable & operator=(const LeaveTable&);
+};
+
+#endif
+
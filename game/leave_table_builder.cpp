@@ -0,0 +1,154 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2013 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#include <cmath>
+
+#include "leave_table_builder.h"
+#include "game.h"
+#include "game_params.h"
+#include "player.h"
+#include "history.h"
+#include "turn_data.h"
+#include "pldrack.h"
+#include "move.h"
+#include "rack.h"
+#include "game_exception.h"
+#include "debug.h"
+
+
+INIT_LOGGER(game, LeaveTableBuilder);
+
+/// Number of tiles in a full rack
+static const unsigned kRACK_SIZE = 7;
+/// Weight of the estimation of a leave from its tiles, in number of
+/// observations of the leave
+static const double kPRIOR_WEIGHT = 10;
+
+
+LeaveTableBuilder::LeaveTableBuilder(const Dictionary &iDic)
+    : m_dic(iDic), m_hash(iDic),
+    m_sums(m_hash.getNbLeaves(), 0), m_counts(m_hash.getNbLeaves(), 0),
+    m_totalSum(0), m_nbSamples(0)
+{
+    for (unsigned code = 0; code <= LeaveHash::kMAX_CODE; ++code)
+    {
+        for (unsigned count = 0; count <= LeaveHash::kMAX_LEAVE; ++count)
+        {
+            m_tileSums[code][count] = 0;
+            m_tileCounts[code][count] = 0;
+        }
+    }
+}
+
+
+void LeaveTableBuilder::gameFinished(const Simulation::GameSummary &,
+                                     const Game &iGame)
+{
+    if (iGame.getParams().getMode() != GameParams::kFREEGAME)
+        throw GameException("Leave tables can only be built from free games");
+
+    unsigned counts[LeaveHash::kMAX_CODE + 1];
+    for (unsigned p = 0; p < iGame.getNPlayers(); ++p)
+    {
+        const History &history = iGame.getPlayer(p).getHistory();
+        for (unsigned t = 0; t < history.getSize(); ++t)
+        {
+            if (!history.getTurn(t).getMove().isValid())
+                continue;
+
+            // The history contains all the turns of the game, with a null
+            // move for the turns of the other players
+            unsigned nextTurn = t + 1;
+            while (nextTurn < history.getSize() &&
+                   history.getTurn(nextTurn).getMove().isNull())
+            {
+                ++nextTurn;
+            }
+            if (nextTurn == history.getSize())
+                continue;
+
+            // The tiles kept by the player are the old tiles of the next
+            // rack. The end of the game, where the rack cannot be refilled,
+            // is not representative.
+            const TurnData &next = history.getTurn(nextTurn);
+            const PlayedRack &nextRack = next.getPlayedRack();
+            if (nextRack.getNbTiles() < kRACK_SIZE)
+                continue;
+
+            const unsigned index = m_hash.getIndex(nextRack.getOld());
+            if (index == LeaveHash::kINVALID)
+                continue;
+            const int score = next.getMove().getScore();
+
+            m_sums[index] += score;
+            ++m_counts[index];
+            m_hash.getCounts(index, counts);
+            for (unsigned code = 1; code <= m_hash.getNbCodes(); ++code)
+            {
+                if (counts[code] == 0)
+                    continue;
+                m_tileSums[code][counts[code]] += score;
+                ++m_tileCounts[code][counts[code]];
+            }
+            m_totalSum += score;
+            ++m_nbSamples;
+        }
+    }
+}
+
+
+void LeaveTableBuilder::write(const string &iFileName) const
+{
+    const double average = m_nbSamples ? m_totalSum / m_nbSamples : 0;
+    LOG_INFO("Building a leave table from " << m_nbSamples
+             << " samples (average score: " << average << ")");
+
+    // Value of each tile, for each number of tiles of this code
+    double tileValues[LeaveHash::kMAX_CODE + 1][LeaveHash::kMAX_LEAVE + 1];
+    for (unsigned code = 1; code <= m_hash.getNbCodes(); ++code)
+    {
+        for (unsigned count = 1; count <= m_hash.getBound(code); ++count)
+        {
+            const unsigned nb = m_tileCounts[code][count];
+            tileValues[code][count] =
+                (m_tileSums[code][count] - nb * average) / (nb + kPRIOR_WEIGHT);
+        }
+    }
+
+    vector<int> values(m_hash.getNbLeaves());
+    unsigned counts[LeaveHash::kMAX_CODE + 1];
+    for (unsigned i = 0; i < values.size(); ++i)
+    {
+        m_hash.getCounts(i, counts);
+        double estimate = 0;
+        for (unsigned code = 1; code <= m_hash.getNbCodes(); ++code)
+        {
+            if (counts[code] != 0)
+                estimate += tileValues[code][counts[code]];
+        }
+        const double value = (m_sums[i] - m_counts[i] * average +
+                              kPRIOR_WEIGHT * estimate) / (m_counts[i] + kPRIOR_WEIGHT);
+        // The values are stored in tenths of points
+        values[i] = lrint(10 * value);
+    }
+
+    LeaveTable::Write(iFileName, m_dic, values);
+}
+
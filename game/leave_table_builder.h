@@ -0,0 +1,88 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2013 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#ifndef LEAVE_TABLE_BUILDER_H_
+#define LEAVE_TABLE_BUILDER_H_
+
+#include <string>
+#include <vector>
+
+#include "simulation.h"
+#include "leave_table.h"
+#include "logging.h"
+
+class Dictionary;
+class Game;
+
+using std::string;
+using std::vector;
+
+
+/**
+ * Generate a leave table (see LeaveTable) from self-play games.
+ *
+ * The builder receives free games played by AI players (see Simulation),
+ * and for each turn of each player, it records the leave of the move and
+ * the score of the next move of the player. When the table is written,
+ * the value of each leave is the average difference between this score
+ * and the average score of all the moves.
+ *
+ * Most leaves are never (or rarely) seen, so their value is estimated
+ * by summing the values of their tiles (with their multiplicity), and the
+ * average of the observations of the leave is only used when there are
+ * enough of them (the more observations, the more weight they get).
+ */
+class LeaveTableBuilder: public Simulation::Listener
+{
+    DEFINE_LOGGER();
+public:
+    explicit LeaveTableBuilder(const Dictionary &iDic);
+
+    /// Record the leaves of the game, which must be a free game
+    virtual void gameFinished(const Simulation::GameSummary &iSummary,
+                              const Game &iGame);
+
+    /// Number of leaves recorded so far
+    unsigned getNbSamples() const { return m_nbSamples; }
+
+    /**
+     * Compute the values of all the leaves, and write the table.
+     * A SaveGameException is thrown if the file cannot be written.
+     */
+    void write(const string &iFileName) const;
+
+private:
+    const Dictionary &m_dic;
+    const LeaveHash m_hash;
+
+    /// Sum of the next scores and number of samples, for each leave
+    vector<double> m_sums;
+    vector<unsigned> m_counts;
+
+    /// Same thing for each tile code, and each number of tiles of this code
+    double m_tileSums[LeaveHash::kMAX_CODE + 1][LeaveHash::kMAX_LEAVE + 1];
+    unsigned m_tileCounts[LeaveHash::kMAX_CODE + 1][LeaveHash::kMAX_LEAVE + 1];
+
+    double m_totalSum;
+    unsigned m_nbSamples;
+};
+
+#endif
+
@@ -27,6 +27,7 @@
 #include "board_layout.h"
 #include "bag.h"
 #include "rack.h"
+#include "leave_table.h"
 
 #include "dic.h"
 #include "debug.h"
@@ -44,8 +45,10 @@ INIT_LOGGER(game, MoveSelector);
 
 
 MoveSelector::MoveSelector(const Bag &iBag, const Dictionary &iDic,
-                           const Board &iBoard, const Rack &iRack)
-    : m_bag(iBag), m_dic(iDic), m_board(iBoard), m_rack(iRack)
+                           const Board &iBoard, const Rack &iRack,
+                           const boost::shared_ptr<const LeaveTable> &iLeaveTable)
+    : m_bag(iBag), m_dic(iDic), m_board(iBoard), m_rack(iRack),
+    m_leaveTable(iLeaveTable)
 {
 }
 
@@ -100,6 +103,11 @@ int MoveSelector::evalForJokersInRack(const Round &iRound) const
 
 int MoveSelector::evalForRemainingLetters(const Round &iRound) const
 {
+    // The leave table gives the value of the remaining letters directly
+    // (in tenths of points)
+    if (m_leaveTable)
+        return m_leaveTable->getValue(m_rack, iRound);
+
     // Compute the rack remaining after playing the round
     Rack remaining = m_rack;
     for (unsigned i = 0; i < iRound.getWordLen(); ++i)
@@ -21,6 +21,8 @@
 #ifndef MOVE_SELECTOR_H_
 #define MOVE_SELECTOR_H_
 
+#include <boost/shared_ptr.hpp>
+
 #include "logging.h"
 
 class Round;
@@ -29,6 +31,7 @@ class Bag;
 class Dictionary;
 class Board;
 class Rack;
+class LeaveTable;
 
 
 /**
@@ -42,8 +45,10 @@ class MoveSelector
     DEFINE_LOGGER();
 public:
 
+    /// iLeaveTable may be empty, if no leave table is configured
     MoveSelector(const Bag &iBag, const Dictionary &iDic,
-                 const Board &iBoard, const Rack &iRack);
+                 const Board &iBoard, const Rack &iRack,
+                 const boost::shared_ptr<const LeaveTable> &iLeaveTable);
 
     /**
      * Return a move to be used as "master move" in a duplicate game.
@@ -63,6 +68,8 @@ private:
     const Dictionary &m_dic;
     const Board &m_board;
     const Rack &m_rack;
+    /// Leave table (see LeaveTable), possibly empty
+    boost::shared_ptr<const LeaveTable> m_leaveTable;
 
     int evalScore(const Round &iRound) const;
     int evalForJokersInRack(const Round &iRound) const;
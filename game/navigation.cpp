@@ -33,7 +33,7 @@ INIT_LOGGER(game, Navigation);
 
 
 Navigation::Navigation()
-    : m_currTurn(0)
+    : m_currTurn(0), m_keepHistory(true), m_nbDroppedTurns(0)
 {
     // Start with an empty turn
     m_allTurns.push_back(new Turn);
@@ -53,8 +53,27 @@ void Navigation::newTurn()
 {
     LOG_INFO("New turn");
     lastTurn();
+    if (!m_keepHistory)
+    {
+        // The previous turns are fully executed, so they can be
+        // deleted without any effect on the game
+        BOOST_FOREACH(Turn *turn, m_allTurns)
+        {
+            delete turn;
+        }
+        m_nbDroppedTurns += m_allTurns.size();
+        m_allTurns.clear();
+        m_currTurn = 0;
+    }
+    else
+        ++m_currTurn;
     m_allTurns.push_back(new Turn);
-    ++m_currTurn;
+}
+
+
+void Navigation::setKeepHistory(bool iKeep)
+{
+    m_keepHistory = iKeep;
 }
 
 
@@ -68,19 +87,19 @@ void Navigation::addAndExecute(Command *iCmd)
 
 unsigned int Navigation::getCurrTurn() const
 {
-    return m_currTurn;
+    return m_nbDroppedTurns + m_currTurn;
 }
 
 
 unsigned int Navigation::getNbTurns() const
 {
-    return m_allTurns.size();
+    return m_nbDroppedTurns + m_allTurns.size();
 }
 
 
 bool Navigation::isFirstTurn() const
 {
-    return m_currTurn == 0 &&
+    return getCurrTurn() == 0 &&
         m_allTurns[m_currTurn]->isPartiallyExecuted() &&
         (!m_allTurns[m_currTurn]->hasNonAutoExecCmd() ||
          !m_allTurns[m_currTurn]->isFullyExecuted());
@@ -96,7 +115,9 @@ bool Navigation::isLastTurn() const
 
 void Navigation::prevTurn()
 {
-    if (isFirstTurn())
+    // Without history, the previous turns do not exist anymore
+    ASSERT(m_keepHistory, "Navigating in a game without history");
+    if (!m_keepHistory || isFirstTurn())
         return;
 
     LOG_DEBUG("Navigating to the previous turn");
@@ -145,6 +166,9 @@ void Navigation::nextTurn()
 void Navigation::firstTurn()
 {
     LOG_DEBUG("Navigating to the first turn");
+    ASSERT(m_keepHistory, "Navigating in a game without history");
+    if (!m_keepHistory)
+        return;
     while (!isFirstTurn())
     {
         prevTurn();
@@ -53,6 +53,19 @@ class Navigation
         void newTurn();
         void addAndExecute(Command *iCmd);
 
+        /**
+         * When iKeep is false, the turns are deleted as soon as they are
+         * finished (i.e. when a new turn is started), so only the current
+         * turn is kept in memory. This is meant for games played without
+         * any interaction (simulations): it is not possible to navigate
+         * to the deleted turns, and they are not saved.
+         * The numbering of the turns is not affected, and prevTurn()
+         * and firstTurn() do nothing in this mode.
+         * By default, the whole history is kept.
+         */
+        void setKeepHistory(bool iKeep);
+        bool getKeepHistory() const { return m_keepHistory; }
+
         unsigned int getCurrTurn() const;
         unsigned int getNbTurns() const;
         bool isFirstTurn() const;
@@ -103,6 +116,11 @@ class Navigation
     private:
         vector<Turn *> m_allTurns;
         unsigned int m_currTurn;
+
+        /// False if the finished turns are deleted
+        bool m_keepHistory;
+        /// Number of turns deleted before the first one of m_allTurns
+        unsigned int m_nbDroppedTurns;
 };
 
 #endif
@@ -24,6 +24,7 @@
 #include <algorithm>
 #include "pldrack.h"
 #include "rack.h"
+#include "random.h"
 
 
 INIT_LOGGER(game, PlayedRack);
@@ -183,18 +184,18 @@ bool PlayedRack::checkRack(unsigned int cMin, unsigned int vMin) const
 }
 
 
-void PlayedRack::shuffleNew()
+void PlayedRack::shuffleNew(Random &ioRandom)
 {
-    std::random_shuffle(m_newTiles.begin(), m_newTiles.end());
+    ioRandom.shuffle(m_newTiles.begin(), m_newTiles.end());
 }
 
 
-void PlayedRack::shuffle()
+void PlayedRack::shuffle(Random &ioRandom)
 {
     m_newTiles.insert(m_newTiles.end(),
                       m_oldTiles.begin(), m_oldTiles.end());
     m_oldTiles.clear();
-    shuffleNew();
+    shuffleNew(ioRandom);
 }
 
 
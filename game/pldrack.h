@@ -28,6 +28,7 @@
 #include "logging.h"
 
 class Rack;
+class Random;
 
 using namespace std;
 
@@ -55,6 +56,7 @@ public:
     void setNew(const Rack &iRack);
     void setManual(const wstring& iLetters);
     void setReject(bool iReject = true) { m_reject = iReject; }
+    bool isReject() const { return m_reject; }
 
     unsigned int getNbTiles() const  { return getNbNew() + getNbOld(); }
     unsigned int getNbNew() const    { return m_newTiles.size(); }
@@ -69,9 +71,9 @@ public:
     bool checkRack(unsigned int cMin, unsigned int vMin) const;
 
     /// Randomly change the order of the "new" tiles
-    void shuffleNew();
+    void shuffleNew(Random &ioRandom);
     /// Randomly change the order of all the tiles (they all become "new")
-    void shuffle();
+    void shuffle(Random &ioRandom);
 
     enum display_mode
     {
@@ -29,6 +29,7 @@
 #include "game_factory.h"
 #include "game_exception.h"
 #include "xml_writer.h"
+#include "binary_writer.h"
 #include "player.h"
 #include "pldrack.h"
 
@@ -90,6 +91,12 @@ const Bag& PublicGame::getBag() const
 }
 
 
+const boost::shared_ptr<const LeaveTable> & PublicGame::getLeaveTable() const
+{
+    return m_game.getLeaveTable();
+}
+
+
 const PlayedRack& PublicGame::getCurrentRack() const
 {
     return m_game.getHistory().getCurrentRack();
@@ -404,9 +411,12 @@ PublicGame *PublicGame::load(const string &iFileName, const Dictionary &iDic)
 }
 
 
-void PublicGame::save(const string &iFileName) const
+void PublicGame::save(const string &iFileName, SaveFormat iFormat) const
 {
-    XmlWriter::write(m_game, iFileName);
+    if (iFormat == kSAVE_BINARY)
+        BinaryWriter::write(m_game, iFileName);
+    else
+        XmlWriter::write(m_game, iFileName);
 }
 
 /***************************/
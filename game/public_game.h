@@ -23,6 +23,7 @@
 
 #include <vector>
 #include <string>
+#include <boost/shared_ptr.hpp>
 
 class GameParams;
 class Game;
@@ -37,6 +38,7 @@ class Results;
 class LimitResults;
 class Move;
 class PlayedRack;
+class LeaveTable;
 
 using namespace std;
 
@@ -96,6 +98,8 @@ public:
     const Board& getBoard() const;
     /// Get the bag
     const Bag& getBag() const;
+    /// Get the leave table, possibly empty (see Game::getLeaveTable())
+    const boost::shared_ptr<const LeaveTable> & getLeaveTable() const;
     /// Get the rack
     const PlayedRack & getCurrentRack() const;
 
@@ -316,16 +320,23 @@ public:
      * Saved games handling
      ***************/
 
+    /// Formats of the saved games
+    enum SaveFormat
+    {
+        kSAVE_XML,
+        kSAVE_BINARY,
+    };
+
     /**
-     * Return the loaded game, from an XML file.
+     * Return the loaded game, from an XML or binary file.
      * An exception is thrown in case of problem.
      */
     static PublicGame * load(const string &iFileName, const Dictionary &iDic);
 
     /**
-     * Save a game to a XML file
+     * Save a game to a file, in the given format
      */
-    void save(const string &iFileName) const;
+    void save(const string &iFileName, SaveFormat iFormat = kSAVE_XML) const;
 
     /***************
      * Navigation in the game history
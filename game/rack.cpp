@@ -20,6 +20,7 @@
  *****************************************************************************/
 
 #include "rack.h"
+#include "cross.h"
 #include "dic.h"
 #include "encoding.h"
 #include "debug.h"
@@ -64,6 +65,22 @@ void Rack::getTiles(vector<Tile> &oTiles) const
 }
 
 
+uint64_t Rack::getLetterMask() const
+{
+    uint64_t mask = 0;
+    for (unsigned i = 1; i < m_tiles.size(); i++)
+    {
+        if (m_tiles[i] == 0)
+            continue;
+        const Tile &tile = Dictionary::GetDic().getTileFromCode(i);
+        if (tile.isPureJoker())
+            return (uint64_t)-1;
+        mask |= Cross::GetTileBit(tile);
+    }
+    return mask;
+}
+
+
 wstring Rack::toString() const
 {
     wstring rs;
@@ -24,6 +24,7 @@
 
 #include <vector>
 #include <string>
+#include <stdint.h>
 
 #include "tile.h"
 #include "logging.h"
@@ -52,6 +53,14 @@ public:
     void clear();
     void getTiles(vector<Tile> &oTiles) const;
 
+    /**
+     * Return a mask of the letters of the rack, suitable for
+     * Cross::checkMask(): the bit of each letter present in the rack is set.
+     * If the rack contains a joker, all the bits are set, since the joker
+     * can replace any letter.
+     */
+    uint64_t getLetterMask() const;
+
     wstring toString() const;
 
     bool operator==(const Rack &iOther) const;
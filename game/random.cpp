@@ -0,0 +1,124 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2013 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#include <cstdlib> // For rand()
+
+#include "random.h"
+#include "game_exception.h"
+#include "debug.h"
+
+
+/// Step of the SplitMix64 generator, used to initialize the states
+static uint64_t splitMix64(uint64_t &ioState)
+{
+    uint64_t z = (ioState += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+
+static inline uint64_t rotl(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+
+Random::Random()
+    : m_legacy(true), m_seed(0)
+{
+    for (unsigned i = 0; i < kSTATE_SIZE; ++i)
+        m_state[i] = 0;
+}
+
+
+Random::Random(uint64_t iSeed)
+{
+    setSeed(iSeed);
+}
+
+
+void Random::setSeed(uint64_t iSeed)
+{
+    m_legacy = false;
+    m_seed = iSeed;
+    // SplitMix64 never gives 4 null values in a row,
+    // so the state is valid
+    uint64_t sm = iSeed;
+    for (unsigned i = 0; i < kSTATE_SIZE; ++i)
+        m_state[i] = splitMix64(sm);
+}
+
+
+void Random::setState(uint64_t iSeed, const uint64_t iState[kSTATE_SIZE])
+{
+    bool valid = false;
+    for (unsigned i = 0; i < kSTATE_SIZE; ++i)
+        valid = valid || iState[i] != 0;
+    if (!valid)
+        throw GameException("Invalid state for the random generator");
+
+    m_legacy = false;
+    m_seed = iSeed;
+    for (unsigned i = 0; i < kSTATE_SIZE; ++i)
+        m_state[i] = iState[i];
+}
+
+
+uint64_t Random::next()
+{
+    // xoshiro256** (see http://prng.di.unimi.it/)
+    const uint64_t result = rotl(m_state[1] * 5, 7) * 9;
+    const uint64_t t = m_state[1] << 17;
+    m_state[2] ^= m_state[0];
+    m_state[3] ^= m_state[1];
+    m_state[1] ^= m_state[2];
+    m_state[0] ^= m_state[3];
+    m_state[2] ^= t;
+    m_state[3] = rotl(m_state[3], 45);
+    return result;
+}
+
+
+unsigned Random::getInt(unsigned iMax)
+{
+    ASSERT(iMax > 0, "Invalid range for a random number");
+
+    if (m_legacy)
+        return (unsigned)((double)iMax * rand() / (RAND_MAX + 1.0));
+
+    // Reject the highest values, to avoid any bias
+    const uint64_t maxValue = ~(uint64_t)0;
+    const uint64_t limit = maxValue - maxValue % iMax;
+    uint64_t value;
+    do
+    {
+        value = next();
+    } while (value >= limit);
+    return value % iMax;
+}
+
+
+uint64_t Random::DeriveSeed(uint64_t iSeed, uint64_t iStream)
+{
+    uint64_t sm = iSeed ^ splitMix64(iStream);
+    return splitMix64(sm);
+}
+
@@ -0,0 +1,108 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2013 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#ifndef RANDOM_H_
+#define RANDOM_H_
+
+#include <algorithm>
+#include <stdint.h>
+
+
+/**
+ * Random number generator of a game.
+ *
+ * A generator is either:
+ *  - in "legacy" mode (the default): the numbers come from the global
+ *    rand() function, as in the previous versions of Eliot. This keeps the
+ *    games reproducible with a given srand() seed, but it is shared by all
+ *    the games (and all the threads) of the process.
+ *  - seeded: the numbers come from a xoshiro256** generator, owned by the
+ *    game. The whole state of the generator (4 x 64 bits) can be saved
+ *    and restored, so that a saved game continues with the same draws.
+ *
+ * Independent streams (for example one per game of a simulation) are
+ * obtained by seeding the generators with DeriveSeed(): the draws of a
+ * stream only depend on the initial seed and on the stream number.
+ */
+class Random
+{
+public:
+    /// Create a generator in legacy mode
+    Random();
+
+    /// Create a seeded generator
+    explicit Random(uint64_t iSeed);
+
+    /// Seed the generator (it leaves the legacy mode)
+    void setSeed(uint64_t iSeed);
+
+    bool isLegacy() const { return m_legacy; }
+
+    /// Seed given to setSeed() (0 in legacy mode)
+    uint64_t getSeed() const { return m_seed; }
+
+    /// Number of values in the state of a seeded generator
+    static const unsigned kSTATE_SIZE = 4;
+
+    /// Current state of a seeded generator
+    uint64_t getState(unsigned iIndex) const { return m_state[iIndex]; }
+
+    /**
+     * Restore a state returned by getState() (the seed is only kept for
+     * information). The state must not be all zeros.
+     */
+    void setState(uint64_t iSeed, const uint64_t iState[kSTATE_SIZE]);
+
+    /// Return a random integer in the range [0, iMax), iMax being > 0
+    unsigned getInt(unsigned iMax);
+
+    /// Shuffle the given range
+    template <typename RandomIt>
+    void shuffle(RandomIt iFirst, RandomIt iLast);
+
+    /// Return the seed of the given stream, derived from iSeed
+    static uint64_t DeriveSeed(uint64_t iSeed, uint64_t iStream);
+
+private:
+    bool m_legacy;
+    uint64_t m_seed;
+    uint64_t m_state[kSTATE_SIZE];
+
+    /// Return the next 64 bits value of a seeded generator
+    uint64_t next();
+};
+
+
+template <typename RandomIt>
+void Random::shuffle(RandomIt iFirst, RandomIt iLast)
+{
+    if (m_legacy)
+    {
+        std::random_shuffle(iFirst, iLast);
+        return;
+    }
+
+    // Fisher-Yates shuffle
+    for (unsigned i = iLast - iFirst; i > 1; --i)
+        std::iter_swap(iFirst + (i - 1), iFirst + getInt(i));
+}
+
+#endif
+
@@ -30,6 +30,7 @@
 #include "round.h"
 #include "board.h"
 #include "move_selector.h"
+#include "leave_table.h"
 #include "debug.h"
 
 
@@ -56,18 +57,18 @@ struct less_points : public binary_function<const Round&, const Round&, bool>
             // order of the letters in the dictionary), ignoring the case
             const wstring &s1 = r1.getWord();
             const wstring &s2 = r2.getWord();
-            if (std::lexicographical_compare(r1.getTiles().begin(),
-                                             r1.getTiles().end(),
-                                             r2.getTiles().begin(),
-                                             r2.getTiles().end(),
+            if (std::lexicographical_compare(r1.getTiles(),
+                                             r1.getTiles() + r1.getWordLen(),
+                                             r2.getTiles(),
+                                             r2.getTiles() + r2.getWordLen(),
                                              tileCompare))
             {
                 return true;;
             }
-            else if (std::lexicographical_compare(r2.getTiles().begin(),
-                                                  r2.getTiles().end(),
-                                                  r1.getTiles().begin(),
-                                                  r1.getTiles().end(),
+            else if (std::lexicographical_compare(r2.getTiles(),
+                                                  r2.getTiles() + r2.getWordLen(),
+                                                  r1.getTiles(),
+                                                  r1.getTiles() + r1.getWordLen(),
                                                   tileCompare))
             {
                 return false;
@@ -111,6 +112,17 @@ void Results::sort()
 }
 
 
+void Results::select(const Results &iAllResults)
+{
+    clear();
+    BOOST_FOREACH(const Round &round, iAllResults.m_rounds)
+    {
+        add(round);
+    }
+    finalize();
+}
+
+
 BestResults::BestResults()
     : m_bestScore(0)
 {
@@ -127,7 +139,7 @@ void BestResults::search(const Dictionary &iDic, const Board &iBoard,
     else
         iBoard.search(iDic, iRack, *this);
 
-    sort();
+    finalize();
 }
 
 
@@ -184,6 +196,12 @@ void PercentResults::search(const Dictionary &iDic, const Board &iBoard,
     else
         iBoard.search(iDic, iRack, *this);
 
+    finalize();
+}
+
+
+void PercentResults::finalize()
+{
     if (m_rounds.empty())
         return;
 
@@ -251,6 +269,12 @@ void LimitResults::search(const Dictionary &iDic, const Board &iBoard,
     else
         iBoard.search(iDic, iRack, *this);
 
+    finalize();
+}
+
+
+void LimitResults::finalize()
+{
     if (m_rounds.empty())
         return;
 
@@ -299,6 +323,23 @@ void LimitResults::add(const Round &iRound)
 }
 
 
+int LimitResults::getMinScore() const
+{
+    // add() ignores the rounds whose score is not strictly greater
+    // than m_minScore
+    return m_limit == 0 ? 0 : m_minScore + 1;
+}
+
+
+Results * LimitResults::createFilter() const
+{
+    // Without limit, all the rounds are kept
+    if (m_limit == 0)
+        return NULL;
+    return new LimitResults(m_limit);
+}
+
+
 void LimitResults::clear()
 {
     m_rounds.clear();
@@ -309,8 +350,9 @@ void LimitResults::clear()
 
 
 
-MasterResults::MasterResults(const Bag &iBag)
-    : m_bag(iBag)
+MasterResults::MasterResults(const Bag &iBag,
+                             const boost::shared_ptr<const LeaveTable> &iLeaveTable)
+    : m_bag(iBag), m_leaveTable(iLeaveTable)
 {
 }
 
@@ -326,12 +368,18 @@ void MasterResults::search(const Dictionary &iDic, const Board &iBoard,
         return;
 
     // Find the best round, according to the heuristics in MoveSelector
-    MoveSelector selector(m_bag, iDic, iBoard, iRack);
+    MoveSelector selector(m_bag, iDic, iBoard, iRack, m_leaveTable);
     const Round &round = selector.selectMaster(m_bestResults);
     m_rounds.push_back(round);
 }
 
 
+void MasterResults::select(const Results &)
+{
+    ASSERT(false, "MasterResults::select() is not supported");
+}
+
+
 void MasterResults::add(const Round &iRound)
 {
     m_bestResults.add(iRound);
@@ -345,3 +393,121 @@ void MasterResults::clear()
 }
 
 
+EquityResults::EquityResults(const boost::shared_ptr<const LeaveTable> &iTable)
+    : m_table(iTable), m_bestEquity(0)
+{
+    ASSERT(iTable, "A leave table is needed");
+}
+
+
+void EquityResults::search(const Dictionary &iDic, const Board &iBoard,
+                           const Rack &iRack, bool iFirstWord)
+{
+    clear();
+    m_rack = iRack;
+
+    if (iFirstWord)
+        iBoard.searchFirst(iDic, iRack, *this);
+    else
+        iBoard.search(iDic, iRack, *this);
+
+    finalize();
+}
+
+
+void EquityResults::add(const Round &iRound)
+{
+    const int equity = 10 * iRound.getPoints() + m_table->getValue(m_rack, iRound);
+
+    // Ignore lower equities
+    if (!m_rounds.empty() && m_bestEquity > equity)
+        return;
+
+    if (m_rounds.empty() || m_bestEquity < equity)
+    {
+        // New best equity: clear the stored results
+        m_bestEquity = equity;
+        m_rounds.clear();
+    }
+    m_rounds.push_back(iRound);
+}
+
+
+int EquityResults::getMinScore() const
+{
+    if (m_rounds.empty())
+        return 0;
+    // Even with the best leave, a round with a lower score
+    // cannot reach the best equity
+    return std::max(0L, lrint(ceil((m_bestEquity - m_table->getMaxValue()) / 10.)));
+}
+
+
+Results * EquityResults::createFilter() const
+{
+    EquityResults *filter = new EquityResults(m_table);
+    filter->setRack(m_rack);
+    return filter;
+}
+
+
+void EquityResults::clear()
+{
+    m_rounds.clear();
+    m_bestEquity = 0;
+}
+
+
+
+FilterResults::FilterResults(Results *iFilter)
+    : m_filter(iFilter)
+{
+}
+
+
+void FilterResults::search(const Dictionary &iDic, const Board &iBoard,
+                           const Rack &iRack, bool iFirstWord)
+{
+    clear();
+
+    if (iFirstWord)
+        iBoard.searchFirst(iDic, iRack, *this);
+    else
+        iBoard.search(iDic, iRack, *this);
+
+    finalize();
+}
+
+
+void FilterResults::add(const Round &iRound)
+{
+    if (m_filter)
+    {
+        // Ignore the rounds ignored by the filter
+        if (iRound.getPoints() < m_filter->getMinScore())
+            return;
+        m_filter->add(iRound);
+    }
+    m_rounds.push_back(iRound);
+}
+
+
+int FilterResults::getMinScore() const
+{
+    return m_filter ? m_filter->getMinScore() : 0;
+}
+
+
+Results * FilterResults::createFilter() const
+{
+    return m_filter ? m_filter->createFilter() : NULL;
+}
+
+
+void FilterResults::clear()
+{
+    m_rounds.clear();
+    if (m_filter)
+        m_filter->clear();
+}
+
@@ -24,15 +24,18 @@
 
 #include <vector>
 #include <map>
+#include <boost/shared_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
 #include "round.h"
+#include "rack.h"
 #include "logging.h"
 
 using namespace std;
 
 class Dictionary;
 class Board;
-class Rack;
 class Bag;
+class LeaveTable;
 
 
 /**
@@ -63,15 +66,48 @@ public:
     virtual void search(const Dictionary &iDic, const Board &iBoard,
                         const Rack &iRack, bool iFirstWord) = 0;
 
+    /**
+     * Keep the rounds of iAllResults which search() would have kept.
+     * iAllResults must contain all the rounds found by a search on the
+     * board with the rack of interest, except maybe some rounds that this
+     * object would ignore anyway (for example a FilterResults whose filter
+     * is less strict). This allows sharing a single search between several
+     * objects, with different selection rules.
+     */
+    virtual void select(const Results &iAllResults);
+
     /** Add a round */
     virtual void add(const Round &iRound) = 0;
 
     /** Clear the stored rounds, and get ready for a new search */
     virtual void clear() = 0;
 
+    /**
+     * Return the minimum score a round must have to be possibly kept
+     * by add(): rounds with a lower score are simply ignored, so the search
+     * can skip the moves which cannot reach this score.
+     * The value can only increase when rounds are added.
+     */
+    virtual int getMinScore() const { return 0; }
+
+    /**
+     * Return a new empty object, applying the same filtering rules as this
+     * one in add() (same getMinScore() after the same calls to add()),
+     * or NULL if there is no such rule.
+     * This is used by the parallel search, to filter the rounds found by
+     * each thread. The caller takes ownership of the returned object.
+     */
+    virtual Results * createFilter() const { return NULL; }
+
 protected:
     vector<Round> m_rounds;
     void sort();
+
+    /**
+     * Process the rounds once they have all been added, at the end of
+     * search() and select(). The default implementation simply sorts them
+     */
+    virtual void finalize() { sort(); }
 };
 
 /**
@@ -87,6 +123,8 @@ public:
                         const Rack &iRack, bool iFirstWord);
     virtual void clear();
     virtual void add(const Round &iRound);
+    virtual int getMinScore() const { return m_bestScore; }
+    virtual Results * createFilter() const { return new BestResults; }
 
 private:
     int m_bestScore;
@@ -108,6 +146,11 @@ public:
                         const Rack &iRack, bool iFirstWord);
     virtual void clear();
     virtual void add(const Round &iRound);
+    virtual int getMinScore() const { return m_minScore; }
+    virtual Results * createFilter() const { return new PercentResults(m_percent); }
+
+protected:
+    virtual void finalize();
 
 private:
     const float m_percent;
@@ -129,9 +172,14 @@ public:
                         const Rack &iRack, bool iFirstWord);
     virtual void clear();
     virtual void add(const Round &iRound);
+    virtual int getMinScore() const;
+    virtual Results * createFilter() const;
 
     void setLimit(int iNewLimit) { m_limit = iNewLimit; }
 
+protected:
+    virtual void finalize();
+
 private:
     int m_limit;
     map<int, int> m_scoresCount;
@@ -150,16 +198,74 @@ private:
 class MasterResults: public Results
 {
 public:
-    MasterResults(const Bag &iBag);
+    /// The leave table (see Game::getLeaveTable()) may be empty
+    MasterResults(const Bag &iBag,
+                  const boost::shared_ptr<const LeaveTable> &iLeaveTable);
     virtual void search(const Dictionary &iDic, const Board &iBoard,
                         const Rack &iRack, bool iFirstWord);
+    /// Not supported: the selection of the master move needs the board
+    virtual void select(const Results &iAllResults);
     virtual void clear();
     virtual void add(const Round &iRound);
+    virtual int getMinScore() const { return m_bestResults.getMinScore(); }
+    virtual Results * createFilter() const { return m_bestResults.createFilter(); }
 
 private:
     const Bag &m_bag;
+    boost::shared_ptr<const LeaveTable> m_leaveTable;
     BestResults m_bestResults;
 };
 
+/**
+ * This implementation evaluates the rounds with a leave table: the equity
+ * of a round is its score plus the value of the tiles left on the rack
+ * after playing it (see LeaveTable). Only the rounds with the best equity
+ * are kept, like BestResults does with the score.
+ * The select() method uses the rack given to setRack().
+ */
+class EquityResults: public Results
+{
+public:
+    EquityResults(const boost::shared_ptr<const LeaveTable> &iTable);
+    virtual void search(const Dictionary &iDic, const Board &iBoard,
+                        const Rack &iRack, bool iFirstWord);
+    virtual void clear();
+    virtual void add(const Round &iRound);
+    virtual int getMinScore() const;
+    virtual Results * createFilter() const;
+
+    /// Set the rack used to compute the leaves (search() sets it too)
+    void setRack(const Rack &iRack) { m_rack = iRack; }
+
+private:
+    boost::shared_ptr<const LeaveTable> m_table;
+    Rack m_rack;
+    /// Best equity of the stored rounds, in tenths of points
+    int m_bestEquity;
+};
+
+/**
+ * This implementation keeps all the rounds which are not ignored by the
+ * given filter (see createFilter()), so that the search can skip the moves
+ * with a too low score. This is useful to share a single search between
+ * several objects with stricter rules than the filter (see select()).
+ * Without filter, all the rounds are kept.
+ */
+class FilterResults: public Results
+{
+public:
+    /// The object takes ownership of the filter, which can be NULL
+    FilterResults(Results *iFilter);
+    virtual void search(const Dictionary &iDic, const Board &iBoard,
+                        const Rack &iRack, bool iFirstWord);
+    virtual void clear();
+    virtual void add(const Round &iRound);
+    virtual int getMinScore() const;
+    virtual Results * createFilter() const;
+
+private:
+    boost::scoped_ptr<Results> m_filter;
+};
+
 #endif
 
@@ -21,9 +21,13 @@
 
 #include <string>
 #include <sstream>
+#include <algorithm>
 #include <wctype.h>
+#include <boost/static_assert.hpp>
 #include "tile.h"
 #include "round.h"
+#include "board.h"
+#include "dic.h"
 #include "encoding.h"
 #include "debug.h"
 
@@ -31,87 +35,99 @@
 INIT_LOGGER(game, Round);
 
 
+// Make sure the words of the dictionary and of the board fit in a Round
+BOOST_STATIC_ASSERT(Round::kMAX_LENGTH >= BOARD_DIM);
+BOOST_STATIC_ASSERT(Round::kMAX_LENGTH >= DIC_WORD_MAX);
+BOOST_STATIC_ASSERT(Round::kMAX_LENGTH <= 32);
+
+
 Round::Round()
-    : m_coord(1, 1, Coord::HORIZONTAL), m_points(0), m_bonus(false)
+    : m_rackOrigin(0), m_wordLen(0),
+    m_coord(1, 1, Coord::HORIZONTAL), m_points(0), m_bonus(false)
 {
 }
 
 
 void Round::setWord(const vector<Tile> &iTiles)
 {
-    m_word = iTiles;
+    ASSERT(iTiles.size() <= kMAX_LENGTH, "Word too long");
+    std::copy(iTiles.begin(), iTiles.end(), m_word);
+    m_wordLen = iTiles.size();
     // XXX: always from rack?
-    m_rackOrigin = vector<bool>(iTiles.size(), true);
+    m_rackOrigin = (m_wordLen == 32) ? 0xFFFFFFFF : (1u << m_wordLen) - 1;
 }
 
 
 void Round::setTile(unsigned int iIndex, const Tile &iTile)
 {
-    ASSERT(iIndex < m_word.size(), "Invalid index");
+    ASSERT(iIndex < m_wordLen, "Invalid index");
     m_word[iIndex] = iTile;
 }
 
 
 void Round::setFromRack(unsigned int iIndex)
 {
-    ASSERT(iIndex < m_word.size(), "Invalid index");
-    m_rackOrigin[iIndex] = true;
+    ASSERT(iIndex < m_wordLen, "Invalid index");
+    m_rackOrigin |= 1u << iIndex;
 }
 
 
 void Round::setFromBoard(unsigned int iIndex)
 {
-    ASSERT(iIndex < m_word.size(), "Invalid index");
-    m_rackOrigin[iIndex] = false;
+    ASSERT(iIndex < m_wordLen, "Invalid index");
+    m_rackOrigin &= ~(1u << iIndex);
 }
 
 
 bool Round::isJoker(unsigned int iIndex) const
 {
-    ASSERT(iIndex < m_word.size(), "Invalid index");
+    ASSERT(iIndex < m_wordLen, "Invalid index");
      return m_word[iIndex].isJoker();
 }
 
 
 const Tile& Round::getTile(unsigned int iIndex) const
 {
-    ASSERT(iIndex < m_word.size(), "Invalid index");
+    ASSERT(iIndex < m_wordLen, "Invalid index");
      return m_word[iIndex];
 }
 
 
 bool Round::isPlayedFromRack(unsigned int iIndex) const
 {
-    ASSERT(iIndex < m_word.size(), "Invalid index");
-     return m_rackOrigin[iIndex];
+    ASSERT(iIndex < m_wordLen, "Invalid index");
+     return m_rackOrigin & (1u << iIndex);
 }
 
 
 void Round::addRightFromBoard(const Tile &iTile)
 {
+    ASSERT(m_wordLen < kMAX_LENGTH, "Word too long");
     // The call to toUpper() is necessary to avoid that a joker
     // on the board appears as a joker in the Round
-    m_word.push_back(iTile.toUpper());
-    m_rackOrigin.push_back(false);
+    m_word[m_wordLen] = iTile.toUpper();
+    m_rackOrigin &= ~(1u << m_wordLen);
+    ++m_wordLen;
 }
 
 
 void Round::addRightFromRack(const Tile &iTile, bool iJoker)
 {
+    ASSERT(m_wordLen < kMAX_LENGTH, "Word too long");
     if (iJoker)
-        m_word.push_back(iTile.toLower());
+        m_word[m_wordLen] = iTile.toLower();
     else
-        m_word.push_back(iTile);
-    m_rackOrigin.push_back(true);
+        m_word[m_wordLen] = iTile;
+    m_rackOrigin |= 1u << m_wordLen;
+    ++m_wordLen;
 }
 
 
 void Round::removeRight()
 {
-    ASSERT(!m_word.empty() && !m_rackOrigin.empty(),
-           "Trying to remove tiles that were never added");
-    m_word.pop_back();
-    m_rackOrigin.pop_back();
+    ASSERT(m_wordLen > 0, "Trying to remove tiles that were never added");
+    --m_wordLen;
+    m_rackOrigin &= ~(1u << m_wordLen);
 }
 
 
@@ -156,7 +172,8 @@ wstring Round::toString() const
 
 bool Round::operator==(const Round &iOther) const
 {
-    return m_word == iOther.m_word
+    return m_wordLen == iOther.m_wordLen
+        && std::equal(m_word, m_word + m_wordLen, iOther.m_word)
         && m_rackOrigin == iOther.m_rackOrigin
         && m_coord == iOther.m_coord
         && m_points == iOther.m_points
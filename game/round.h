@@ -23,6 +23,7 @@
 #define ROUND_H_
 
 #include <vector>
+#include <stdint.h>
 #include "tile.h"
 #include "coord.h"
 #include "logging.h"
@@ -35,12 +36,22 @@ using namespace std;
  * It contains the word itself, of course, but also information of position
  * on the board, origin of letters (board for a letter already placed, rack
  * for a letter just being played), points, etc...
+ *
+ * The tiles are stored in a fixed-size array inside the object, so that
+ * building a Round during the search, or copying it into the results,
+ * never needs a dynamic allocation.
  */
 class Round
 {
     DEFINE_LOGGER();
 public:
 
+    /**
+     * Maximum number of tiles in a word.
+     * It must be at least BOARD_DIM and DIC_WORD_MAX (checked in round.cpp)
+     */
+    static const unsigned int kMAX_LENGTH = 16;
+
     Round();
 
     /*************************
@@ -68,10 +79,11 @@ public:
     const Tile& getTile  (unsigned int iIndex) const;
 
     wstring getWord() const;
-    unsigned int getWordLen() const { return m_word.size(); }
+    unsigned int getWordLen() const { return m_wordLen; }
     int getPoints() const           { return m_points; }
     bool getBonus() const           { return m_bonus; }
-    const vector<Tile> &getTiles() const { return m_word; }
+    /// Return the tiles of the word (there are getWordLen() of them)
+    const Tile * getTiles() const   { return m_word; }
 
     unsigned countJokersFromRack() const;
 
@@ -88,8 +100,10 @@ public:
     bool operator==(const Round &iOther) const;
 
 private:
-    vector<Tile> m_word;
-    vector<bool> m_rackOrigin;
+    Tile m_word[kMAX_LENGTH];
+    /// Bit i is set if the tile i is played from the rack
+    uint32_t m_rackOrigin;
+    unsigned int m_wordLen;
     Coord m_coord;
     int m_points;
     bool m_bonus;
@@ -0,0 +1,161 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2013 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#include <boost/foreach.hpp>
+#include <boost/scoped_ptr.hpp>
+
+#include "search_cache.h"
+#include "results.h"
+#include "debug.h"
+
+
+INIT_LOGGER(game, SearchCache);
+
+
+SearchCache::SearchCache(unsigned int iMaxRounds)
+    : m_nbRounds(0), m_maxRounds(iMaxRounds)
+{
+}
+
+
+SearchCache::SearchCache(const SearchCache &iOther)
+    : m_nbRounds(0), m_maxRounds(iOther.m_maxRounds)
+{
+}
+
+
+SearchCache & SearchCache::operator=(const SearchCache &)
+{
+    // The entries are not copied, and the capacity is kept
+    clear();
+    return *this;
+}
+
+
+void SearchCache::Replay(const RoundLists &iRounds, Results &oResults)
+{
+    BOOST_FOREACH(const vector<Round> &rounds, iRounds)
+    {
+        BOOST_FOREACH(const Round &round, rounds)
+        {
+            oResults.add(round);
+        }
+    }
+}
+
+
+list<SearchCache::Entry>::iterator
+SearchCache::find(uint64_t iBoardHash, const Dictionary &iDic,
+                  const Rack &iRack, bool iFirstTurn)
+{
+    list<Entry>::iterator it;
+    for (it = m_entries.begin(); it != m_entries.end(); ++it)
+    {
+        if (it->boardHash == iBoardHash && it->dic == &iDic &&
+            it->firstTurn == iFirstTurn && it->rack == iRack)
+        {
+            break;
+        }
+    }
+    return it;
+}
+
+
+bool SearchCache::replay(uint64_t iBoardHash, const Dictionary &iDic,
+                         const Rack &iRack, bool iFirstTurn,
+                         Results &oResults)
+{
+    list<Entry>::iterator it = find(iBoardHash, iDic, iRack, iFirstTurn);
+    if (it == m_entries.end())
+        return false;
+
+    // Check that the rounds ignored by the search would also have been
+    // ignored by oResults, using a filter with the same rules
+    if (it->minScore > 0)
+    {
+        boost::scoped_ptr<Results> filter(oResults.createFilter());
+        if (filter.get() == NULL)
+            return false;
+        Replay(it->rounds, *filter);
+        if (filter->getMinScore() < it->minScore)
+        {
+            LOG_DEBUG("Cache entry found, but with too few rounds");
+            return false;
+        }
+    }
+
+    // Move the entry to the front of the list
+    m_entries.splice(m_entries.begin(), m_entries, it);
+
+    Replay(it->rounds, oResults);
+    return true;
+}
+
+
+void SearchCache::store(uint64_t iBoardHash, const Dictionary &iDic,
+                        const Rack &iRack, bool iFirstTurn,
+                        RoundLists &ioRounds, int iMinScore)
+{
+    // Remove the previous entry for the same search, if any
+    list<Entry>::iterator it = find(iBoardHash, iDic, iRack, iFirstTurn);
+    if (it != m_entries.end())
+    {
+        m_nbRounds -= it->nbRounds;
+        m_entries.erase(it);
+    }
+
+    unsigned int nbRounds = 0;
+    BOOST_FOREACH(const vector<Round> &rounds, ioRounds)
+    {
+        nbRounds += rounds.size();
+    }
+    if (nbRounds > m_maxRounds)
+    {
+        LOG_DEBUG("Too many rounds to cache: " << nbRounds);
+        ioRounds.clear();
+        return;
+    }
+
+    // Make room for the new entry
+    while (!m_entries.empty() && m_nbRounds + nbRounds > m_maxRounds)
+    {
+        m_nbRounds -= m_entries.back().nbRounds;
+        m_entries.pop_back();
+    }
+
+    m_entries.push_front(Entry());
+    Entry &entry = m_entries.front();
+    entry.boardHash = iBoardHash;
+    entry.dic = &iDic;
+    entry.rack = iRack;
+    entry.firstTurn = iFirstTurn;
+    entry.minScore = iMinScore;
+    entry.rounds.swap(ioRounds);
+    entry.nbRounds = nbRounds;
+    m_nbRounds += nbRounds;
+}
+
+
+void SearchCache::clear()
+{
+    m_entries.clear();
+    m_nbRounds = 0;
+}
+
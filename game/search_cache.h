@@ -0,0 +1,128 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2013 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#ifndef SEARCH_CACHE_H_
+#define SEARCH_CACHE_H_
+
+#include <list>
+#include <vector>
+#include <stdint.h>
+
+#include "rack.h"
+#include "round.h"
+#include "logging.h"
+
+class Dictionary;
+class Results;
+
+using namespace std;
+
+
+/**
+ * Cache of the rounds found by the searches on a board, to avoid
+ * searching again and again with the same rack (for example when
+ * the arbitrator looks for the best score of the turn several times).
+ *
+ * An entry is identified by the hash of the board (see Board::getHash()),
+ * the dictionary, the rack and the first turn flag. It contains the rounds
+ * given to Results::add() by the search, in the same order, so that they
+ * can be replayed into any Results implementation.
+ * The search may have ignored the rounds with a score lower than the
+ * minimum score of its filter (see Results::createFilter()): an entry can
+ * then only be used for results whose own minimum score, after the replay,
+ * is at least the one of the filter. Otherwise the rounds ignored by the
+ * search could have been kept.
+ *
+ * The total number of rounds of the entries is limited, the least recently
+ * used entries are dropped first. This class is not thread-safe.
+ *
+ * The entries are not copied with the cache: a copy (or the target of an
+ * assignment) starts empty, so that copying the owner of the cache (see
+ * Board) does not copy the rounds.
+ */
+class SearchCache
+{
+    DEFINE_LOGGER();
+public:
+    SearchCache(unsigned int iMaxRounds = 20000);
+    /// Create an empty cache, with the capacity of iOther
+    SearchCache(const SearchCache &iOther);
+    /// Remove all the entries (the capacity is not changed)
+    SearchCache & operator=(const SearchCache &iOther);
+
+    /**
+     * Rounds of a search, in the order of the calls to Results::add().
+     * They may be split in several lists (for example one per row in
+     * a parallel search), to avoid copying them into a single one.
+     */
+    typedef vector<vector<Round> > RoundLists;
+
+    /// Add all the given rounds to oResults, in the same order
+    static void Replay(const RoundLists &iRounds, Results &oResults);
+
+    /**
+     * Look for an entry and replay its rounds into oResults.
+     * Return false if there is no valid entry, in which case oResults
+     * is left untouched
+     */
+    bool replay(uint64_t iBoardHash, const Dictionary &iDic,
+                const Rack &iRack, bool iFirstTurn,
+                Results &oResults);
+
+    /**
+     * Store the rounds of a search. iMinScore is the minimum score used
+     * by the search to ignore rounds (0 if all the rounds were kept).
+     * The rounds are moved into the cache (without copy), so ioRounds
+     * is empty on return
+     */
+    void store(uint64_t iBoardHash, const Dictionary &iDic,
+               const Rack &iRack, bool iFirstTurn,
+               RoundLists &ioRounds, int iMinScore);
+
+    /// Remove all the entries
+    void clear();
+
+private:
+    struct Entry
+    {
+        uint64_t boardHash;
+        const Dictionary *dic;
+        Rack rack;
+        bool firstTurn;
+        int minScore;
+        RoundLists rounds;
+        unsigned int nbRounds;
+    };
+
+    /// Entries, the most recently used first
+    list<Entry> m_entries;
+
+    /// Total number of rounds in the entries
+    unsigned int m_nbRounds;
+
+    const unsigned int m_maxRounds;
+
+    /// Find the entry of a search, or return m_entries.end()
+    list<Entry>::iterator find(uint64_t iBoardHash, const Dictionary &iDic,
+                               const Rack &iRack, bool iFirstTurn);
+};
+
+#endif
+
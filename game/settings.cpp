@@ -196,6 +196,16 @@ Settings::Settings()
     m_conf = new Config;
 
     // ============== General options ==============
+    Setting &general = m_conf->getRoot().add("general", Setting::TypeGroup);
+
+    // Number of threads used to search the moves on the board.
+    // 1 means a sequential search, 0 means one thread per core
+    general.add("search-threads", Setting::TypeInt) = 1;
+
+    // Path of the leave table (see the leavegen tool) used to choose the
+    // master moves and the moves of the best AI players.
+    // An empty path means that no leave table is used
+    general.add("leave-table", Setting::TypeString) = "";
 
     // ============== Training mode options ==============
     Setting &training = m_conf->getRoot().add("training", Setting::TypeGroup);
@@ -270,6 +280,8 @@ Settings::Settings()
         // one by one...
         Config tmpConf;
         tmpConf.readFile(m_fileName.c_str());
+        copySetting<int>(tmpConf, *m_conf, "general.search-threads");
+        copySetting<string>(tmpConf, *m_conf, "general.leave-table");
         copySetting<int>(tmpConf, *m_conf, "training.search-limit");
         copySetting<int>(tmpConf, *m_conf, "duplicate.solo-players");
         copySetting<int>(tmpConf, *m_conf, "duplicate.solo-value");
@@ -361,7 +373,9 @@ int Settings::getInt(const string &iName) const
     }
 #else
     // Dummy implementation
-    if (iName == "training.search-limit")
+    if (iName == "general.search-threads")
+        return 1;
+    else if (iName == "training.search-limit")
         return 100;
     else if (iName == "duplicate.solo-players")
         return 16;
@@ -384,6 +398,38 @@ int Settings::getInt(const string &iName) const
 }
 
 
+#ifdef HAVE_LIBCONFIG
+void Settings::setString(const string &iName, const string &iValue)
+{
+    setValue<string>(iName, iValue);
+}
+
+
+string Settings::getString(const string &iName) const
+{
+    try
+    {
+        return (const char*)m_conf->lookup(iName);
+    }
+    catch (SettingNotFoundException &e)
+    {
+        throw GameException("No such option: " + iName);
+    }
+}
+#else
+// Dummy implementation: no string setting is set
+void Settings::setString(const string &, const string &)
+{
+}
+
+
+string Settings::getString(const string &) const
+{
+    return "";
+}
+#endif
+
+
 template<class T>
 void Settings::setValue(const string &iName, T iValue)
 {
@@ -67,6 +67,9 @@ public:
     void setInt(const string &iName, int iValue);
     int getInt(const string &iName) const;
 
+    void setString(const string &iName, const string &iValue);
+    string getString(const string &iName) const;
+
 private:
 
     /// Singleton instance
@@ -0,0 +1,158 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2013 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#include <algorithm>
+#include <boost/foreach.hpp>
+#include <boost/bind.hpp>
+#include <boost/scoped_ptr.hpp>
+
+#include "simulation.h"
+#include "game_factory.h"
+#include "game.h"
+#include "player.h"
+#include "ai_percent.h"
+#include "history.h"
+#include "random.h"
+#include "settings.h"
+#include "thread_pool.h"
+#include "game_exception.h"
+#include "debug.h"
+
+
+INIT_LOGGER(game, Simulation);
+
+
+Simulation::Simulation(const GameParams &iParams)
+    : m_params(iParams), m_keepHistory(false), m_seed(0), m_factory(NULL),
+    m_listener(NULL), m_nbGames(0), m_nextGame(0), m_stopping(false)
+{
+    if (iParams.getMode() != GameParams::kDUPLICATE &&
+        iParams.getMode() != GameParams::kFREEGAME)
+    {
+        throw GameException("Simulations are only possible in duplicate and free game modes");
+    }
+}
+
+
+void Simulation::addPlayer(float iLevel)
+{
+    m_levels.push_back(iLevel);
+}
+
+
+void Simulation::run(unsigned iNbGames, Listener &ioListener, unsigned iNbThreads)
+{
+    if (m_levels.empty())
+        throw GameException("Cannot start a simulation without any player");
+
+    // Make sure the singletons are created before starting the threads
+    Settings::Instance();
+    m_factory = GameFactory::Instance();
+
+    m_listener = &ioListener;
+    m_nbGames = iNbGames;
+    m_nextGame = 0;
+    m_stopping = false;
+
+    if (iNbThreads == 0)
+        iNbThreads = ThreadPool::GetNbCores();
+    iNbThreads = std::max(1u, std::min(iNbThreads, iNbGames));
+    LOG_INFO("Starting a simulation of " << iNbGames << " games with "
+             << iNbThreads << " threads");
+
+    // One task per thread, each one playing games until the end.
+    // The searches of the AI players are done sequentially inside
+    // the tasks (see ThreadPool::run()), which is more efficient than
+    // searching in parallel when the games themselves are parallel.
+    vector<ThreadPool::Task> tasks(iNbThreads,
+                                   boost::bind(&Simulation::playGames, this));
+    ThreadPool::Instance().run(tasks, iNbThreads);
+
+    m_listener = NULL;
+    LOG_INFO("End of the simulation");
+}
+
+
+void Simulation::runGame(uint64_t iGameSeed, Listener &ioListener)
+{
+    if (m_levels.empty())
+        throw GameException("Cannot start a simulation without any player");
+
+    m_factory = GameFactory::Instance();
+    m_listener = &ioListener;
+    LOG_INFO("Replaying the game with seed " << iGameSeed);
+    playGame(0, iGameSeed);
+    m_listener = NULL;
+}
+
+
+void Simulation::playGames()
+{
+    while (true)
+    {
+        unsigned gameNb;
+        {
+            boost::lock_guard<boost::mutex> lock(m_mutex);
+            if (m_stopping || m_nextGame >= m_nbGames)
+                return;
+            gameNb = m_nextGame;
+            ++m_nextGame;
+        }
+
+        try
+        {
+            playGame(gameNb, Random::DeriveSeed(m_seed, gameNb));
+        }
+        catch (...)
+        {
+            boost::lock_guard<boost::mutex> lock(m_mutex);
+            m_stopping = true;
+            throw;
+        }
+    }
+}
+
+
+void Simulation::playGame(unsigned iGameNb, uint64_t iSeed)
+{
+    boost::scoped_ptr<Game> game(m_factory->createGame(m_params));
+    game->accessRandom().setSeed(iSeed);
+    game->accessNavigation().setKeepHistory(m_keepHistory);
+    BOOST_FOREACH(float level, m_levels)
+    {
+        game->addPlayer(new AIPercent(level));
+    }
+
+    // With AI players only, the whole game is played here
+    game->start();
+    ASSERT(game->isFinished(), "The simulated game is not finished");
+
+    GameSummary summary;
+    summary.gameNb = iGameNb;
+    summary.seed = iSeed;
+    summary.nbTurns = game->getHistory().getSize();
+    summary.points = game->getPoints();
+    for (unsigned int i = 0; i < game->getNPlayers(); ++i)
+        summary.scores.push_back(game->getPlayer(i).getTotalScore());
+
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    m_listener->gameFinished(summary, *game);
+}
+
@@ -0,0 +1,154 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2013 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#ifndef SIMULATION_H_
+#define SIMULATION_H_
+
+#include <vector>
+#include <stdint.h>
+#include <boost/thread/mutex.hpp>
+
+#include "game_params.h"
+#include "logging.h"
+
+class Game;
+class GameFactory;
+
+using std::vector;
+
+
+/**
+ * Play many complete games between AI players, without any interaction,
+ * to gather statistics (for example to calibrate the AI levels).
+ *
+ * The games are played in parallel on the ThreadPool: each thread takes
+ * the next game to play as soon as it has finished the previous one.
+ * Each game has its own board, bag and players, and the dictionary is
+ * shared (it is only read).
+ *
+ * Each game has its own random generator, seeded with a seed derived from
+ * the seed of the simulation and the number of the game (see
+ * Random::DeriveSeed()). So the games only depend on the seed of the
+ * simulation, and not on the number of threads, and any game can be
+ * replayed alone by seeding a new game with the seed of its summary.
+ *
+ * By default, the history of the turns is not kept (see
+ * Navigation::setKeepHistory()), so the played games cannot be saved,
+ * but they use less memory and time.
+ *
+ * Only the duplicate and free game modes are supported.
+ */
+class Simulation
+{
+    DEFINE_LOGGER();
+public:
+    /// Summary of a finished game
+    struct GameSummary
+    {
+        /// Number of the game, starting from 0
+        unsigned gameNb;
+        /// Seed of the random generator of the game
+        uint64_t seed;
+        /// Number of turns of the game
+        unsigned nbTurns;
+        /// Total score of each player
+        vector<int> scores;
+        /// Number of points of the game (i.e. the sum of the master moves,
+        /// only meaningful in duplicate mode)
+        int points;
+    };
+
+    /**
+     * Interface used to receive the games, as soon as they are finished.
+     * The games are not necessarily received in order, but the calls are
+     * serialized, so the implementations don't need to be thread-safe.
+     */
+    class Listener
+    {
+    public:
+        virtual ~Listener() {}
+
+        /**
+         * Called for each finished game. The game is destroyed
+         * just after the call, so it must not be kept.
+         */
+        virtual void gameFinished(const GameSummary &iSummary,
+                                  const Game &iGame) = 0;
+    };
+
+    /**
+     * The parameters define the mode of the games (which must be
+     * kDUPLICATE or kFREEGAME), the dictionary and the variants.
+     * A GameException is thrown for an unsupported mode.
+     */
+    Simulation(const GameParams &iParams);
+
+    /// Add an AI player (0.0 <= iLevel <= 1.0) to all the games
+    void addPlayer(float iLevel);
+
+    /// Set the seed of the simulation (0 by default)
+    void setSeed(uint64_t iSeed) { m_seed = iSeed; }
+
+    /// Keep the turns history of the games (false by default)
+    void setKeepHistory(bool iKeep) { m_keepHistory = iKeep; }
+
+    /**
+     * Play iNbGames games, using at most iNbThreads threads (0 means
+     * one thread per core), and give them to the listener.
+     * If a game throws an exception, the remaining games are not started,
+     * and the exception is rethrown once the games in progress are finished.
+     */
+    void run(unsigned iNbGames, Listener &ioListener, unsigned iNbThreads = 0);
+
+    /**
+     * Play a single game, with the given seed instead of a seed derived
+     * from the seed of the simulation, and give it to the listener (with
+     * the number 0). With the seed of a GameSummary, this replays the game
+     * alone.
+     */
+    void runGame(uint64_t iGameSeed, Listener &ioListener);
+
+private:
+    const GameParams m_params;
+    vector<float> m_levels;
+    bool m_keepHistory;
+    uint64_t m_seed;
+
+    /// Used by the current run
+    GameFactory *m_factory;
+    Listener *m_listener;
+    unsigned m_nbGames;
+
+    /// Mutex protecting the fields below, and the calls to the listener
+    boost::mutex m_mutex;
+    /// Number of the next game to play
+    unsigned m_nextGame;
+    /// True when the remaining games must not be started
+    bool m_stopping;
+
+    /// Loop executed by each thread: play games until there is no more
+    void playGames();
+
+    /// Play the given game with the given seed, and give it to the listener
+    void playGame(unsigned iGameNb, uint64_t iSeed);
+};
+
+#endif
+
@@ -0,0 +1,207 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2013 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#include <algorithm>
+#include <boost/foreach.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/tss.hpp>
+
+#include "thread_pool.h"
+#include "debug.h"
+
+
+INIT_LOGGER(game, ThreadPool);
+
+
+ThreadPool *ThreadPool::m_instance = NULL;
+
+/// Mutex protecting the creation and destruction of the singleton
+static boost::mutex s_instanceMutex;
+
+/// Set (to a non-NULL value) while the thread executes a task of the pool
+static boost::thread_specific_ptr<bool> s_inTask;
+
+
+/// Mark the calling thread as executing a task, during its lifetime
+class TaskMarker
+{
+public:
+    TaskMarker() { s_inTask.reset(new bool(true)); }
+    ~TaskMarker() { s_inTask.reset(); }
+};
+
+
+ThreadPool & ThreadPool::Instance()
+{
+    boost::lock_guard<boost::mutex> lock(s_instanceMutex);
+    if (m_instance == NULL)
+        m_instance = new ThreadPool;
+    return *m_instance;
+}
+
+
+void ThreadPool::Destroy()
+{
+    boost::lock_guard<boost::mutex> lock(s_instanceMutex);
+    delete m_instance;
+    m_instance = NULL;
+}
+
+
+bool ThreadPool::IsInTask()
+{
+    return s_inTask.get() != NULL;
+}
+
+
+unsigned ThreadPool::GetNbCores()
+{
+    return std::max(boost::thread::hardware_concurrency(), 1u);
+}
+
+
+ThreadPool::ThreadPool()
+    : m_nbWorkers(0), m_tasks(NULL), m_nextTask(0), m_nbPending(0),
+    m_nbActive(0), m_stopping(false)
+{
+}
+
+
+ThreadPool::~ThreadPool()
+{
+    {
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_taskCond.notify_all();
+    m_threads.join_all();
+}
+
+
+void ThreadPool::run(const vector<Task> &iTasks, unsigned iNbThreads)
+{
+    if (IsInTask())
+    {
+        // Nested call: waiting for the other threads could deadlock,
+        // so execute the tasks here, with the same exception semantics
+        boost::exception_ptr exception;
+        BOOST_FOREACH(const Task &task, iTasks)
+        {
+            try
+            {
+                task();
+            }
+            catch (...)
+            {
+                if (!exception)
+                    exception = boost::current_exception();
+            }
+        }
+        if (exception)
+            boost::rethrow_exception(exception);
+        return;
+    }
+
+    boost::lock_guard<boost::mutex> runLock(m_runMutex);
+
+    if (iTasks.empty())
+        return;
+
+    // The calling thread counts as one of the threads
+    const unsigned nbThreads =
+        std::max(1u, std::min(iNbThreads, (unsigned)iTasks.size()));
+    while (m_nbWorkers + 1 < nbThreads)
+    {
+        LOG_DEBUG("Creating worker thread " << m_nbWorkers);
+        m_threads.create_thread(boost::bind(&ThreadPool::workerLoop,
+                                            this, m_nbWorkers));
+        ++m_nbWorkers;
+    }
+
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+    m_tasks = &iTasks;
+    m_nextTask = 0;
+    m_nbPending = iTasks.size();
+    m_nbActive = nbThreads - 1;
+    m_exception = boost::exception_ptr();
+    m_taskCond.notify_all();
+
+    // Take part in the work
+    executeTasks(lock);
+
+    // Wait for the tasks executed by the workers
+    while (m_nbPending > 0)
+        m_doneCond.wait(lock);
+    m_tasks = NULL;
+
+    const boost::exception_ptr exception = m_exception;
+    m_exception = boost::exception_ptr();
+    lock.unlock();
+    if (exception)
+        boost::rethrow_exception(exception);
+}
+
+
+void ThreadPool::workerLoop(unsigned iIndex)
+{
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+    while (true)
+    {
+        while (!m_stopping &&
+               (m_tasks == NULL || iIndex >= m_nbActive ||
+                m_nextTask >= m_tasks->size()))
+        {
+            m_taskCond.wait(lock);
+        }
+        if (m_stopping)
+            return;
+        executeTasks(lock);
+    }
+}
+
+
+void ThreadPool::executeTasks(boost::unique_lock<boost::mutex> &ioLock)
+{
+    while (m_tasks != NULL && m_nextTask < m_tasks->size())
+    {
+        const Task &task = (*m_tasks)[m_nextTask];
+        ++m_nextTask;
+
+        ioLock.unlock();
+        boost::exception_ptr exception;
+        try
+        {
+            TaskMarker marker;
+            task();
+        }
+        catch (...)
+        {
+            exception = boost::current_exception();
+        }
+        ioLock.lock();
+
+        if (exception && !m_exception)
+            m_exception = exception;
+        --m_nbPending;
+        if (m_nbPending == 0)
+            m_doneCond.notify_all();
+    }
+}
+
@@ -0,0 +1,119 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2013 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+#include <vector>
+#include <boost/function.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/exception_ptr.hpp>
+
+#include "logging.h"
+
+using std::vector;
+
+
+/**
+ * Pool of worker threads, used to execute independent tasks in parallel.
+ * It implements the Singleton pattern: the threads are created lazily,
+ * the first time they are needed, and reused afterwards.
+ *
+ * The tasks can call run() themselves, but in this case the nested tasks
+ * are simply executed sequentially by the calling thread (all the threads
+ * of the pool may already be busy with the outer tasks).
+ */
+class ThreadPool
+{
+    DEFINE_LOGGER();
+public:
+    typedef boost::function<void ()> Task;
+
+    /// Access to the singleton
+    static ThreadPool & Instance();
+    /// Destroy the singleton cleanly (waiting for the threads to end)
+    static void Destroy();
+
+    /// Return the number of hardware threads (at least 1)
+    static unsigned GetNbCores();
+
+    ~ThreadPool();
+
+    /**
+     * Execute the given tasks, using at most iNbThreads threads (including
+     * the calling thread, which also executes tasks), and return when all
+     * of them are finished.
+     * The tasks are started in order, each time a thread is available.
+     * Calls to run() from different threads are serialized.
+     * If some tasks throw an exception, the first one is rethrown
+     * by run() once all the tasks are finished.
+     */
+    void run(const vector<Task> &iTasks, unsigned iNbThreads);
+
+    /// Return true if the calling thread is executing a task of the pool
+    static bool IsInTask();
+
+private:
+    /// Singleton instance
+    static ThreadPool *m_instance;
+    ThreadPool();
+
+    /// Worker threads
+    boost::thread_group m_threads;
+    unsigned m_nbWorkers;
+
+    /// Mutex used to serialize the calls to run()
+    boost::mutex m_runMutex;
+
+    /// Mutex protecting all the fields below
+    boost::mutex m_mutex;
+    /// Signaled when there are new tasks to execute, or when stopping
+    boost::condition_variable m_taskCond;
+    /// Signaled when all the tasks are finished
+    boost::condition_variable m_doneCond;
+
+    /// Tasks being executed (NULL when there is nothing to do)
+    const vector<Task> *m_tasks;
+    /// Index of the next task to start
+    unsigned m_nextTask;
+    /// Number of tasks not finished yet
+    unsigned m_nbPending;
+    /// Number of workers allowed to take part in the current run
+    unsigned m_nbActive;
+    /// First exception thrown by a task during the current run
+    boost::exception_ptr m_exception;
+    /// True when the threads must stop
+    bool m_stopping;
+
+    /// Main loop of the worker threads
+    void workerLoop(unsigned iIndex);
+
+    /**
+     * Execute the tasks of the current run, until there is no more task
+     * to start. The lock must be held when calling this method, and it is
+     * held again when it returns.
+     */
+    void executeTasks(boost::unique_lock<boost::mutex> &ioLock);
+};
+
+#endif
+
@@ -19,6 +19,7 @@
  *****************************************************************************/
 
 #include <fstream>
+#include <sstream>
 #include <algorithm>
 #include <boost/format.hpp>
 #include <SAX/XMLReader.hpp>
@@ -52,6 +53,7 @@
 #include "freegame.h"
 #include "player.h"
 #include "ai_percent.h"
+#include "random.h"
 #include "encoding.h"
 #include "cmd/game_rack_cmd.h"
 #include "cmd/game_move_cmd.h"
@@ -98,6 +100,9 @@ Game * XmlReader::read(const string &iFileName, const Dictionary &iDic)
     if (game == NULL)
         throw LoadGameException(handler.errorMessage);
 
+    // Build the cross checks for the final position
+    game->accessBoard().endBulkLoad();
+
     LOG_INFO("Savegame parsed successfully");
     return game;
 }
@@ -117,6 +122,16 @@ static int toInt(const string &str)
 }
 
 
+static uint64_t toU64(const string &str)
+{
+    istringstream iss(str);
+    uint64_t value;
+    if (!(iss >> value))
+        throw LoadGameException(FMT1(_("Invalid string to integer conversion: '%1%'"), str));
+    return value;
+}
+
+
 static Player & getPlayer(map<string, Player*> &players,
                           const string &id, const string &iTag)
 {
@@ -210,6 +225,14 @@ void XmlReader::startElement(const string& namespaceURI,
             m_attributes[atts.getLocalName(i)] = atts.getValue(i);
         }
     }
+    else if (tag == "Random")
+    {
+        m_attributes.clear();
+        for (int i = 0; i < atts.getLength(); ++i)
+        {
+            m_attributes[atts.getLocalName(i)] = atts.getValue(i);
+        }
+    }
     else if (tag == "GameRack" || tag == "PlayerRack" ||
              tag == "PlayerMove" || tag == "GameMove" || tag == "MasterMove" ||
              tag == "Warning" || tag == "Penalty" || tag == "Solo" || tag == "EndGame")
@@ -310,6 +333,9 @@ void XmlReader::endElement(const string& namespaceURI,
     if (m_game == NULL)
     {
         m_game = GameFactory::Instance()->createGame(m_params);
+        // The moves are replayed without updating the cross checks
+        // after each of them
+        m_game->accessBoard().beginBulkLoad(m_dic);
     }
 
     if (m_context == "Player")
@@ -351,6 +377,18 @@ void XmlReader::endElement(const string& namespaceURI,
         }
     }
 
+    else if (tag == "Random")
+    {
+        istringstream iss(m_data);
+        uint64_t state[Random::kSTATE_SIZE];
+        for (unsigned i = 0; i < Random::kSTATE_SIZE; ++i)
+        {
+            if (!(iss >> state[i]))
+                throw LoadGameException(FMT1(_("Invalid state for the random generator: %1%"), m_data));
+        }
+        m_game->accessRandom().setState(toU64(m_attributes["seed"]), state);
+    }
+
     else if (tag == "GameRack")
     {
         // Build a rack for the correct player
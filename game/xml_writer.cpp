@@ -38,6 +38,7 @@
 #include "turn_data.h"
 #include "game_params.h"
 #include "game.h"
+#include "random.h"
 #include "player.h"
 #include "ai_percent.h"
 #include "game_exception.h"
@@ -178,6 +179,17 @@ void XmlWriter::write(const Game &iGame, const string &iFileName)
     if (iGame.getParams().hasVariant(GameParams::k7AMONG8))
         out << indent << "<Variant>7among8</Variant>" << endl;
 
+    // State of the random generator (nothing is written in legacy mode,
+    // since the state of rand() cannot be retrieved)
+    const Random &random = iGame.getRandom();
+    if (!random.isLegacy())
+    {
+        out << indent << "<Random seed=\"" << random.getSeed() << "\">";
+        for (unsigned i = 0; i < Random::kSTATE_SIZE; ++i)
+            out << (i > 0 ? " " : "") << random.getState(i);
+        out << "</Random>" << endl;
+    }
+
     // Players
     for (unsigned int i = 0; i < iGame.getNPlayers(); ++i)
     {
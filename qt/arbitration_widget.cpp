@@ -711,7 +711,8 @@ void ArbitrationWidget::showPreview(const QItemSelection &iSelected)
 
 int ArbitrationWidget::getBestScore() const
 {
-    // Note: we could cache the result of this method
+    // Note: the board caches the results of the searches, so calling this
+    // method several times for the same rack is cheap
     BestResults results;
     results.search(m_game->getDic(), m_game->getBoard(),
                    m_game->getCurrentRack().getRack(),
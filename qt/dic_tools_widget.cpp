@@ -30,6 +30,7 @@
 #include <QMessageBox>
 #include <QMenu>
 #include <QString>
+#include <QScrollBar>
 
 #include "dic_tools_widget.h"
 #include "custom_popup.h"
@@ -40,6 +41,7 @@
 #include "listdic.h"
 #include "encoding.h"
 #include "dic_exception.h"
+#include "regexp_search.h"
 
 using namespace std;
 
@@ -48,7 +50,7 @@ INIT_LOGGER(qt, DicToolsWidget);
 
 
 DicToolsWidget::DicToolsWidget(QWidget *parent)
-    : QWidget(parent), m_dic(NULL)
+    : QWidget(parent), m_dic(NULL), m_regexpSearch(NULL)
 {
     setupUi(this);
 
@@ -78,6 +80,8 @@ DicToolsWidget::DicToolsWidget(QWidget *parent)
                      this, SLOT(refreshRegexp()));
     QObject::connect(buttonSaveRegexp, SIGNAL(clicked()),
                      this, SLOT(saveRegexpResults()));
+    QObject::connect(treeViewRegexp->verticalScrollBar(), SIGNAL(valueChanged(int)),
+                     this, SLOT(regexpScrolled(int)));
     QObject::connect(buttonSaveWords, SIGNAL(clicked()),
                      this, SLOT(exportWordsList()));
 
@@ -117,11 +121,18 @@ DicToolsWidget::DicToolsWidget(QWidget *parent)
 }
 
 
+DicToolsWidget::~DicToolsWidget()
+{
+    delete m_regexpSearch;
+}
+
+
 void DicToolsWidget::setDic(const Dictionary *iDic)
 {
     if (m_dic != iDic)
     {
         m_dic = iDic;
+        m_regexpCache.clear();
         // Reset the letters
         lineEditCheck->clear();
         lineEditPlus1->clear();
@@ -258,6 +269,12 @@ void DicToolsWidget::refreshRegexp()
     QStandardItemModel *model = m_regexpModel;
     QLineEdit *rack = lineEditRegexp;
 
+    // Forget the previous search
+    delete m_regexpSearch;
+    m_regexpSearch = NULL;
+    m_regexp.reset();
+    labelLimitReached->hide();
+
     model->removeRows(0, model->rowCount());
     if (m_dic == NULL)
     {
@@ -275,42 +292,68 @@ void DicToolsWidget::refreshRegexp()
 
     if (input != L"")
     {
-        unsigned lmin = spinBoxMinLength->value();
-        unsigned lmax = spinBoxMaxLength->value();
-        // FIXME: this value should not be hardcoded,
-        // or a warning should appear when it is reached
-        unsigned limit = 1000;
-        vector<wstring> wordList;
-        bool res = true;
-        int rowNum = 0;
         try
         {
-            res = m_dic->searchRegExp(input, wordList, lmin, lmax, limit);
+            m_regexp = m_regexpCache.get(*m_dic, input);
         }
         catch (InvalidRegexpException &e)
         {
-            model->insertRow(rowNum);
-            model->setData(model->index(rowNum, 0),
+            model->insertRow(0);
+            model->setData(model->index(0, 0),
                            _q("Invalid regular expression: %1").arg(qfl(e.what())));
-            model->setData(model->index(rowNum, 0),
+            model->setData(model->index(0, 0),
                            QBrush(Qt::red), Qt::ForegroundRole);
+            return;
         }
 
-        vector<wstring>::const_iterator it;
-        for (it = wordList.begin(); it != wordList.end(); it++)
-        {
-            model->insertRow(rowNum);
-            model->setData(model->index(rowNum, 0), qfw(*it));
-            ++rowNum;
-        }
-        if (res)
-            labelLimitReached->hide();
-        else
-            labelLimitReached->show();
+        unsigned lmin = spinBoxMinLength->value();
+        unsigned lmax = spinBoxMaxLength->value();
+        m_regexpSearch = new RegexpSearch(*m_dic, *m_regexp, lmin, lmax);
+        fetchMoreRegexp();
+    }
+}
+
+
+void DicToolsWidget::fetchMoreRegexp()
+{
+    if (m_regexpSearch == NULL || m_regexpSearch->isFinished())
+        return;
+
+    // Only display a limited number of results at a time, the next ones
+    // are fetched when the user scrolls to the end of the list
+    static const unsigned limit = 1000;
+    vector<wstring> wordList;
+    m_regexpSearch->next(wordList, limit);
+
+    QStandardItemModel *model = m_regexpModel;
+    int rowNum = model->rowCount();
+    model->insertRows(rowNum, wordList.size());
+    foreach (const wstring &word, wordList)
+    {
+        model->setData(model->index(rowNum, 0), qfw(word));
+        ++rowNum;
+    }
+
+    // If the search is finished after exactly 'limit' results, the label
+    // will be hidden on the next call
+    if (m_regexpSearch->isFinished())
+        labelLimitReached->hide();
+    else
+    {
+        labelLimitReached->setText(_q("Note: only the %1 first results have been "
+                                      "displayed. Scroll down to see more.").arg(rowNum));
+        labelLimitReached->show();
     }
 }
 
 
+void DicToolsWidget::regexpScrolled(int iValue)
+{
+    if (iValue == treeViewRegexp->verticalScrollBar()->maximum())
+        fetchMoreRegexp();
+}
+
+
 void DicToolsWidget::saveRegexpResults()
 {
     if (m_dic == NULL)
@@ -325,7 +368,8 @@ void DicToolsWidget::saveRegexpResults()
         vector<wstring> wordList;
         try
         {
-            m_dic->searchRegExp(input, wordList, lmin, lmax, 0);
+            m_dic->searchRegExp(*m_regexpCache.get(*m_dic, input),
+                                wordList, lmin, lmax, 0);
         }
         catch (InvalidRegexpException &e)
         {
@@ -26,12 +26,14 @@
 #include <QPalette>
 
 #include "ui/dic_tools_widget.ui.h"
+#include "compiled_regexp.h"
 #include "logging.h"
 
 class QStandardItemModel;
 class QString;
 class Dictionary;
 class CustomPopup;
+class RegexpSearch;
 
 class DicToolsWidget: public QWidget, private Ui::DicToolsWidget
 {
@@ -40,6 +42,7 @@ class DicToolsWidget: public QWidget, private Ui::DicToolsWidget
 
 public:
     explicit DicToolsWidget(QWidget *parent = 0);
+    virtual ~DicToolsWidget();
 
 public slots:
     void setDic(const Dictionary *iDic);
@@ -56,6 +59,12 @@ private:
     QStandardItemModel *m_plus1Model;
     /// Model of the tree view for the "regexp" search
     QStandardItemModel *m_regexpModel;
+    /// Last compiled regular expressions
+    RegexpCache m_regexpCache;
+    /// Regular expression of the current search
+    RegexpCache::CompiledRegexpPtr m_regexp;
+    /// Current regexp search, allowing to display more results
+    RegexpSearch *m_regexpSearch;
     /// Model of the tree view for the dictionary letters
     QStandardItemModel *m_dicInfoModel;
 
@@ -85,6 +94,10 @@ private slots:
     void refreshPlus1();
     /// Force synchronizing the model with the "regexp" results
     void refreshRegexp();
+    /// Add the next results of the regexp search to the model
+    void fetchMoreRegexp();
+    /// Fetch more results when the end of the list is reached
+    void regexpScrolled(int iValue);
     /// Force synchronizing the model with the dictionary letters
     void refreshDicInfo();
     /// Save the words of the dictionary to a file
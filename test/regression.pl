@@ -23,6 +23,14 @@ my @eliottxt_array = (
     "$root_path/linux/utils/eliottxt",
     "$root_path/win32/utils/eliottxt.exe"
     );
+# Places where to search for the dictionary tools (listdic and compdic),
+# used to generate the GADDAG version of the dictionary
+my @dictools_array = (
+    "$root_path/dic",
+    "$root_path/build/dic",
+    "$root_path/linux/dic",
+    "$root_path/win32/dic"
+    );
 
 # Change to the test/ directory, because some scenarii expect
 # to find saved games in there
@@ -71,20 +79,23 @@ if (not -x $eliottxt)
 }
 
 
-# Fill a map of (scenario --> randseed) from the driver file.
-# Also fill the list of scenarios in the order of the driver file.
-my %scenario_map;
-my @all_scenarios;
+# Fill a list of runs from the driver file, in the order of the driver file.
+# Each run is a scenario, its randseed, and a flag telling whether it is
+# played with the GADDAG version of the dictionary.
+my @all_runs;
+my $need_gaddag = 0;
 open(DRIVER, $driver_file) or die "Cannot open the scenario list: $!";
 while(<DRIVER>)
 {
     chomp;
     my $line = $_;
     $line =~ s/#.*//;
-    if ($line =~ /^\s*(\w+\/\w+)\s+(\d+)\s*$/)
+    if ($line =~ /^\s*(\w+\/\w+)\s+(\d+)\s*(gaddag|repeat)?\s*$/)
     {
-        $scenario_map{$1} = $2;
-        push(@all_scenarios, $1);
+        my $gaddag = (defined($3) and $3 eq "gaddag") ? 1 : 0;
+        my $repeat = (defined($3) and $3 eq "repeat") ? 1 : 0;
+        push(@all_runs, [$1, $2, $gaddag, $repeat]);
+        $need_gaddag ||= $gaddag;
     }
 }
 close(DRIVER);
@@ -92,10 +103,11 @@ close(DRIVER);
 
 # Select the scenarios to play: if there was no argument in the commandline
 # we play all the scenarios, otherwise we play only the specified ones
-my @scenarios_to_play;
+# (with all the dictionaries they are listed with)
+my @runs_to_play;
 if (@ARGV == 0)
 {
-    @scenarios_to_play = @all_scenarios;
+    @runs_to_play = @all_runs;
 }
 else
 {
@@ -103,42 +115,96 @@ else
     foreach my $item (@ARGV)
     {
         $item =~ s/$input_ext$|$ref_ext$|$run_ext$//;
-        push(@scenarios_to_play, $item);
+        my @found = grep { $_->[0] eq $item } @all_runs;
+        @found = ([$item, 0, 0, 0]) if (@found == 0);
+        push(@runs_to_play, @found);
+    }
+}
+$need_gaddag = grep { $_->[2] } @runs_to_play;
+
+
+# Generate the GADDAG version of the dictionary, with the same words and
+# letters. The GADDAG move generator must give exactly the same results
+# as the DAWG one, so the scenarios are compared to the same references.
+my $ods_gaddag = "$tmp_dir/ods_gaddag.dawg";
+if ($need_gaddag)
+{
+    my $dictools = "";
+    foreach my $dir (@dictools_array)
+    {
+        if (-x "$dir/listdic" and -x "$dir/compdic")
+        {
+            $dictools = $dir;
+            last;
+        }
+    }
+    if ($dictools eq "")
+    {
+        die "Cannot find listdic and compdic in [".join(", ", @dictools_array)."]";
     }
+
+    system("mkdir -p $tmp_dir");
+    my $header = `$dictools/listdic -e -d $ods`;
+    $header =~ /^Dictionary name: (.*)$/m or die "Cannot read the dictionary name of $ods";
+    my $dic_name = $1;
+    system("$dictools/listdic -l -d $ods > $tmp_dir/ods_letters.txt") == 0
+        or die "Cannot list the letters of $ods";
+    system("$dictools/listdic -w -d $ods > $tmp_dir/ods_words.txt") == 0
+        or die "Cannot list the words of $ods";
+    system("$dictools/compdic -g -d '$dic_name' -l $tmp_dir/ods_letters.txt " .
+           "-i $tmp_dir/ods_words.txt -o $ods_gaddag > /dev/null") == 0
+        or die "Cannot generate the GADDAG dictionary $ods_gaddag";
 }
 
 
 # Actually play the selected scenarios
 my @errors;
-foreach my $scenario (@scenarios_to_play)
+foreach my $run (@runs_to_play)
 {
-    print "Scenario: $scenario\n";
+    my ($scenario, $randseed, $gaddag, $repeat) = @$run;
+    my $name = $gaddag ? "$scenario (GADDAG)" :
+               $repeat ? "$scenario (repeated)" : $scenario;
+    my $dic = $gaddag ? $ods_gaddag : $ods;
+    print "Scenario: $name\n";
     my $input_file = $scenario . $input_ext;
-    my $ref_file   = $scenario . $ref_ext;
-    my $run_file   = $scenario . $run_ext;
-    my $randseed   = $scenario_map{$scenario};
+    # A repeated scenario has no reference file: the output of a first
+    # execution is used instead
+    my $ref_file   = $repeat ? $scenario . ".first" . $run_ext
+                             : $scenario . $ref_ext;
+    my $run_file   = $scenario . ($gaddag ? ".gaddag" : "") . $run_ext;
 
     # Check that the needed files exist
     if (not -f $input_file)
     {
         print "--> Error: missing file: $input_file\n";
-        push(@errors, $scenario);
+        push(@errors, $name);
         next;
     }
+    if ($repeat)
+    {
+        unlink $ref_file;
+        my $rc = `$eliottxt $dic $randseed < $input_file > $ref_file 2>&1`;
+        if ($rc ne "")
+        {
+            print "--> Error: execution of scenario failed (return value: $rc)\n";
+            push(@errors, $name);
+            next;
+        }
+    }
     if (not -f $ref_file)
     {
         print "--> Error: missing file: $ref_file\n";
-        push(@errors, $scenario);
+        push(@errors, $name);
         next;
     }
 
     # OK, let's do the actual stuff
     unlink $run_file;
-    my $rc = `$eliottxt $ods $randseed < $input_file > $run_file 2>&1`;
+    my $rc = `$eliottxt $dic $randseed < $input_file > $run_file 2>&1`;
     if ($rc ne "")
     {
         print "--> Error: execution of scenario failed (return value: $rc)\n";
-        push(@errors, $scenario);
+        push(@errors, $name);
         next;
     }
 
@@ -155,7 +221,7 @@ foreach my $scenario (@scenarios_to_play)
     {
         print "--> Error: found differences:\n";
         print $diff;
-        push(@errors, $scenario);
+        push(@errors, $name);
     }
 }
 
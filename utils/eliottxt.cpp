@@ -23,8 +23,10 @@
 
 #include <boost/foreach.hpp>
 #include <boost/tokenizer.hpp>
+#include <boost/scoped_ptr.hpp>
 #include <wchar.h>
 #include <fstream>
+#include <map>
 #include <iostream>
 #include <stdlib.h>
 #include <time.h>
@@ -40,9 +42,13 @@
 #include "dic.h"
 #include "header.h"
 #include "dic_exception.h"
+#include "compiled_regexp.h"
+#include "regexp_search.h"
 #include "game_io.h"
 #include "game_params.h"
 #include "game_factory.h"
+#include "game_archive.h"
+#include "binary_reader.h"
 #include "public_game.h"
 #include "game.h"
 #include "player.h"
@@ -51,6 +57,7 @@
 #include "game_exception.h"
 #include "base_exception.h"
 #include "settings.h"
+#include "simulation.h"
 #include "move.h"
 
 class Game;
@@ -184,6 +191,20 @@ int parseNum(const vector<wstring> &tokens, uint8_t index,
 }
 
 
+uint64_t parseSeed(const vector<wstring> &tokens, uint8_t index)
+{
+    if (tokens.size() <= index)
+        throw ParsingException("Not enough tokens");
+    const wstring &wstr = tokens[index];
+    BOOST_FOREACH(wchar_t wch, wstr)
+    {
+        if (!iswdigit(wch))
+            throw ParsingException("Not a numeric character: " + lfw(wch));
+    }
+    return strtoull(lfw(wstr).c_str(), NULL, 10);
+}
+
+
 wstring parseAlphaNum(const vector<wstring> &tokens, uint8_t index)
 {
     if (tokens.size() <= index)
@@ -245,7 +266,7 @@ wstring parseFileName(const vector<wstring> &tokens, uint8_t index)
 }
 
 
-PublicGame * readGame(const Dictionary &iDic,
+GameParams readParams(const Dictionary &iDic,
                       GameParams::GameMode iMode, const wstring &iToken)
 {
     GameParams params(iDic, iMode);
@@ -258,6 +279,14 @@ PublicGame * readGame(const Dictionary &iDic,
         else if (iToken[i] == L'8')
             params.addVariant(GameParams::k7AMONG8);
     }
+    return params;
+}
+
+
+PublicGame * readGame(const Dictionary &iDic,
+                      GameParams::GameMode iMode, const wstring &iToken)
+{
+    const GameParams &params = readParams(iDic, iMode, iToken);
     Game *tmpGame = GameFactory::Instance()->createGame(params);
     return new PublicGame(*tmpGame);
 }
@@ -288,7 +317,8 @@ void helpTraining()
     printf("  j [] {} : jouer le mot [] aux coordonnées {}\n");
     printf("  n [] : jouer le résultat numéro []\n");
     printf("  r    : rechercher les meilleurs résultats\n");
-    printf("  s [] : sauver la partie en cours dans le fichier []\n");
+    printf("  s [] {b} : sauver la partie en cours dans le fichier []\n");
+    printf("            b -- au format binaire (XML par défaut)\n");
     printf("  h [p|n|f|l|r] : naviguer dans l'historique (prev, next, first, last, replay)\n");
     printf("  q    : quitter le mode entraînement\n");
 }
@@ -310,7 +340,8 @@ void helpFreegame()
     printf("  d [] : vérifier le mot []\n");
     printf("  j [] {} : jouer le mot [] aux coordonnées {}\n");
     printf("  p [] : passer son tour en changeant les lettres []\n");
-    printf("  s [] : sauver la partie en cours dans le fichier []\n");
+    printf("  s [] {b} : sauver la partie en cours dans le fichier []\n");
+    printf("            b -- au format binaire (XML par défaut)\n");
     printf("  h [p|n|f|l|r] : naviguer dans l'historique (prev, next, first, last, replay)\n");
     printf("  q    : quitter le mode partie libre\n");
 }
@@ -332,7 +363,8 @@ void helpDuplicate()
     printf("  d [] : vérifier le mot []\n");
     printf("  j [] {} : jouer le mot [] aux coordonnées {}\n");
     printf("  n [] : passer au joueur n°[]\n");
-    printf("  s [] : sauver la partie en cours dans le fichier []\n");
+    printf("  s [] {b} : sauver la partie en cours dans le fichier []\n");
+    printf("            b -- au format binaire (XML par défaut)\n");
     printf("  h [p|n|f|l|r] : naviguer dans l'historique (prev, next, first, last, replay\n");
     printf("  q    : quitter le mode duplicate\n");
 }
@@ -360,7 +392,8 @@ void helpArbitration()
     printf("            w -- avertissement\n");
     printf("            p -- pénalité\n");
     printf("  f    : finaliser le tour courant\n");
-    printf("  s [] : sauver la partie en cours dans le fichier []\n");
+    printf("  s [] {b} : sauver la partie en cours dans le fichier []\n");
+    printf("            b -- au format binaire (XML par défaut)\n");
     printf("  h [p|n|f|l|r] : naviguer dans l'historique (prev, next, first, last, replay)\n");
     printf("  q    : quitter le mode arbitrage\n");
 }
@@ -383,7 +416,8 @@ void helpTopping()
     printf("  d [] : vérifier le mot []\n");
     printf("  j [] {} <> : jouer le mot [] aux coordonnées {} après <> secondes\n");
     printf("  t [] : simuler un timeout après [] secondes\n");
-    printf("  s [] : sauver la partie en cours dans le fichier []\n");
+    printf("  s [] {b} : sauver la partie en cours dans le fichier []\n");
+    printf("            b -- au format binaire (XML par défaut)\n");
     printf("  h [p|n|f|l|r] : naviguer dans l'historique (prev, next, first, last, replay)\n");
     printf("  q    : quitter le mode topping\n");
 }
@@ -424,12 +458,26 @@ void help()
     printf("                [] joueurs humains et {} joueurs IA (partie détonante)\n");
     printf("  a8 [] {} : démarrer une partie arbitrage avec\n");
     printf("                [] joueurs humains et {} joueurs IA (partie 7 sur 8)\n");
-    printf("  c []     : charger la partie du fichier []\n");
+    printf("  c [] {}  : charger la partie du fichier []\n");
+    printf("                (la partie numéro {} d'une archive, 1 par défaut)\n");
+    printf("  w [] {1} {2} ... : créer l'archive [] avec les parties\n");
+    printf("                des fichiers {1}, {2}, ...\n");
+    printf("  v [] {1} {2} : afficher les commandes du tour {2} de la partie {1}\n");
+    printf("                de l'archive []\n");
     printf("  x [] {1} {2} {3} : expressions rationnelles\n");
     printf("          [] expression à rechercher\n");
     printf("          {1} nombre de résultats à afficher\n");
     printf("          {2} longueur minimum d'un mot\n");
     printf("          {3} longueur maximum d'un mot\n");
+    printf("  m [] {1} {2} {3}... : simuler des parties entre joueurs IA\n");
+    printf("          [] mode (d ou l, suivi des variantes j, e ou 8)\n");
+    printf("          {1} nombre de parties\n");
+    printf("          {2} nombre de threads (0 : un par cœur)\n");
+    printf("          {3}... niveau de chaque joueur IA (0 à 100)\n");
+    printf("  g [] {1} {2}... : rejouer une partie simulée\n");
+    printf("          [] mode (d ou l, suivi des variantes j, e ou 8)\n");
+    printf("          {1} graine de la partie (affichée par la commande m)\n");
+    printf("          {2}... niveau de chaque joueur IA (0 à 100)\n");
     printf("  s [b|i] {1} {2} : définir la valeur {2} pour l'option {1},\n");
     printf("                    qui est de type (b)ool ou (i)nt\n");
     printf("  q        : quitter\n");
@@ -521,9 +569,12 @@ void commonCommands(PublicGame &iGame, const vector<wstring> &tokens)
     else if (command == L's')
     {
         const wstring &fileName = parseFileName(tokens, 1);
+        PublicGame::SaveFormat format = PublicGame::kSAVE_XML;
+        if (tokens.size() > 2 && parseCharInList(tokens, 2, L"b") == L'b')
+            format = PublicGame::kSAVE_BINARY;
         try
         {
-            iGame.save(lfw(fileName));
+            iGame.save(lfw(fileName), format);
         }
         catch (std::exception &e)
         {
@@ -534,6 +585,127 @@ void commonCommands(PublicGame &iGame, const vector<wstring> &tokens)
 }
 
 
+/// Print the words found by a RegexpSearch
+class RegexpPrinter : public RegexpSearch::Visitor
+{
+public:
+    virtual bool visit(const wdstring &iWord)
+    {
+        printf("%s\n", lfw(iWord).c_str());
+        return true;
+    }
+};
+
+
+/**
+ * Print the summary of each simulated game.
+ * The games finish in any order when several threads are used, so they
+ * are printed in the order of their numbers, to keep the output of a
+ * seeded simulation reproducible.
+ */
+class SimulationPrinter : public Simulation::Listener
+{
+public:
+    SimulationPrinter() : m_nextGameNb(0) {}
+
+    virtual void gameFinished(const Simulation::GameSummary &iSummary,
+                              const Game &)
+    {
+        m_pending[iSummary.gameNb] = iSummary;
+        map<unsigned, Simulation::GameSummary>::iterator it;
+        while ((it = m_pending.find(m_nextGameNb)) != m_pending.end())
+        {
+            print(it->second);
+            m_pending.erase(it);
+            ++m_nextGameNb;
+        }
+    }
+
+private:
+    /// Summaries of the finished games waiting for the previous ones
+    map<unsigned, Simulation::GameSummary> m_pending;
+    /// Number of the next game to print
+    unsigned m_nextGameNb;
+
+    void print(const Simulation::GameSummary &iSummary) const
+    {
+        printf("game %u: seed %llu, %u turns, %d points, scores:",
+               iSummary.gameNb, (unsigned long long)iSummary.seed,
+               iSummary.nbTurns, iSummary.points);
+        BOOST_FOREACH(int score, iSummary.scores)
+        {
+            printf(" %d", score);
+        }
+        printf("\n");
+    }
+};
+
+
+/**
+ * Simulate games between AI players or, if iReplay is true, replay
+ * a single simulated game from its seed
+ */
+void handleSimulation(const Dictionary& iDic, const vector<wstring> &tokens,
+                      bool iReplay)
+{
+    const wstring &mode = parseAlphaNum(tokens, 1);
+    int nbGames = 1;
+    int nbThreads = 1;
+    uint64_t gameSeed = 0;
+    if (iReplay)
+        gameSeed = parseSeed(tokens, 2);
+    else
+    {
+        nbGames = parseNum(tokens, 2);
+        nbThreads = parseNum(tokens, 3);
+    }
+    // Levels of the AI players, in percents
+    vector<int> levels;
+    for (unsigned i = iReplay ? 3 : 4; i < tokens.size(); ++i)
+        levels.push_back(parseNum(tokens, i));
+    if (nbGames < 0 || nbThreads < 0 || levels.empty())
+    {
+        printf("invalid simulation parameters\n");
+        return;
+    }
+    BOOST_FOREACH(int level, levels)
+    {
+        if (level > 100)
+        {
+            printf("invalid level: %d\n", level);
+            return;
+        }
+    }
+
+    GameParams::GameMode gameMode;
+    if (mode[0] == L'd')
+        gameMode = GameParams::kDUPLICATE;
+    else if (mode[0] == L'l')
+        gameMode = GameParams::kFREEGAME;
+    else
+    {
+        printf("invalid mode: %ls\n", mode.c_str());
+        return;
+    }
+
+    Simulation simulation(readParams(iDic, gameMode, mode));
+    BOOST_FOREACH(int level, levels)
+    {
+        simulation.addPlayer(0.01 * level);
+    }
+    SimulationPrinter printer;
+    if (iReplay)
+        simulation.runGame(gameSeed, printer);
+    else
+    {
+        // Derive the seed of the simulation from the seed given to srand(),
+        // to make it reproducible
+        simulation.setSeed(rand());
+        simulation.run(nbGames, printer, nbThreads);
+    }
+}
+
+
 void handleRegexp(const Dictionary& iDic, const vector<wstring> &tokens)
 {
     const wstring &regexp = tokens[1];
@@ -553,10 +725,13 @@ void handleRegexp(const Dictionary& iDic, const vector<wstring> &tokens)
     printf("search for %ls (%d,%d,%d)\n", regexp.c_str(),
            nres, lmin, lmax);
 
-    vector<wdstring> wordList;
+    // Keep the last regular expressions, to avoid compiling them again
+    static RegexpCache regexpCache;
+
+    RegexpCache::CompiledRegexpPtr compiled;
     try
     {
-        iDic.searchRegExp(regexp, wordList, lmin, lmax, nres);
+        compiled = regexpCache.get(iDic, regexp);
     }
     catch (InvalidRegexpException &e)
     {
@@ -564,11 +739,11 @@ void handleRegexp(const Dictionary& iDic, const vector<wstring> &tokens)
         return;
     }
 
-    BOOST_FOREACH(const wdstring &wstr, wordList)
-    {
-        printf("%s\n", lfw(wstr).c_str());
-    }
-    printf("%u printed results\n", (unsigned)wordList.size());
+    // Print the words as soon as they are found
+    RegexpPrinter printer;
+    RegexpSearch search(iDic, *compiled, lmin, lmax);
+    unsigned int nbResults = search.next(printer, nres);
+    printf("%u printed results\n", nbResults);
 }
 
 
@@ -594,6 +769,79 @@ void setSetting(const vector<wstring> &tokens)
 }
 
 
+void writeArchive(const Dictionary &iDic, const vector<wstring> &tokens)
+{
+    const string &fileName = lfw(parseFileName(tokens, 1));
+    if (tokens.size() < 3)
+        throw ParsingException("Not enough tokens");
+
+    GameArchiveWriter writer(fileName);
+    for (unsigned int i = 2; i < tokens.size(); ++i)
+    {
+        boost::scoped_ptr<Game> game(GameFactory::Instance()->load(lfw(parseFileName(tokens, i)), iDic));
+        writer.add(*game);
+    }
+    writer.close();
+    printf("%u parties écrites dans l'archive\n", (unsigned)tokens.size() - 2);
+}
+
+
+void printArchiveTurn(const Dictionary &iDic, const vector<wstring> &tokens)
+{
+    const string &fileName = lfw(parseFileName(tokens, 1));
+    // The games and the turns are numbered from 1 in the interface
+    int gameNb = parseNum(tokens, 2);
+    int turnNb = parseNum(tokens, 3);
+
+    GameArchive archive(fileName);
+    if (gameNb < 1 || gameNb > (int)archive.getNbGames())
+    {
+        printf("numéro de partie invalide : %d\n", gameNb);
+        return;
+    }
+    string data;
+    archive.getRecord(gameNb - 1, data);
+    BinaryReader reader(data, iDic);
+    if (turnNb < 1 || turnNb > (int)reader.getNbTurns())
+    {
+        printf("numéro de tour invalide : %d\n", turnNb);
+        return;
+    }
+
+    vector<BinaryReader::TurnCommand> commands;
+    reader.readTurn(turnNb - 1, commands);
+    BOOST_FOREACH(const BinaryReader::TurnCommand &tc, commands)
+    {
+        switch (tc.tag)
+        {
+            case BinaryFormat::kGAME_RACK:
+                printf("game rack: %ls\n", tc.rack.toString().c_str());
+                break;
+            case BinaryFormat::kPLAYER_RACK:
+                printf("player %u rack: %ls\n", tc.playerId, tc.rack.toString().c_str());
+                break;
+            case BinaryFormat::kPLAYER_MOVE:
+                printf("player %u move: %ls\n", tc.playerId, tc.move.toString().c_str());
+                break;
+            case BinaryFormat::kGAME_MOVE:
+                printf("game move: %ls\n", tc.move.toString().c_str());
+                break;
+            case BinaryFormat::kMASTER_MOVE:
+                printf("master move: %ls\n", tc.move.toString().c_str());
+                break;
+            case BinaryFormat::kTOPPING_MOVE:
+                printf("player %u topping move (%ds): %ls\n", tc.playerId,
+                       tc.elapsed, tc.move.toString().c_str());
+                break;
+            case BinaryFormat::kPLAYER_EVENT:
+                printf("player %u event %d: %d points\n", tc.playerId,
+                       tc.eventType, tc.points);
+                break;
+        }
+    }
+}
+
+
 void loopTraining(PublicGame &iGame)
 {
     cout << "mode entraînement" << endl;
@@ -897,9 +1145,23 @@ void mainLoop(const Dictionary &iDic)
                 case L'c':
                     {
                         const string &fileName = lfw(parseFileName(tokens, 1));
+                        int gameNb = parseNum(tokens, 2, true, 1);
                         try
                         {
-                            PublicGame *game = PublicGame::load(fileName, iDic);
+                            PublicGame *game;
+                            if (GameArchive::IsArchiveFile(fileName))
+                            {
+                                // The games are numbered from 1 in the interface
+                                GameArchive archive(fileName);
+                                if (gameNb < 1 || gameNb > (int)archive.getNbGames())
+                                {
+                                    printf("numéro de partie invalide : %d\n", gameNb);
+                                    break;
+                                }
+                                game = new PublicGame(*archive.loadGame(gameNb - 1, iDic));
+                            }
+                            else
+                                game = PublicGame::load(fileName, iDic);
                             if (game->getMode() == PublicGame::kTRAINING)
                                 loopTraining(*game);
                             else if (game->getMode() == PublicGame::kFREEGAME)
@@ -987,6 +1249,20 @@ void mainLoop(const Dictionary &iDic)
                     // Regular expression tests
                     handleRegexp(iDic, tokens);
                     break;
+                case L'm':
+                    // Simulation of games between AI players
+                    handleSimulation(iDic, tokens, false);
+                    break;
+                case L'g':
+                    // Replay of a simulated game
+                    handleSimulation(iDic, tokens, true);
+                    break;
+                case L'w':
+                    writeArchive(iDic, tokens);
+                    break;
+                case L'v':
+                    printArchiveTurn(iDic, tokens);
+                    break;
                 case L's':
                     setSetting(tokens);
                     break;
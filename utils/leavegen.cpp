@@ -0,0 +1,176 @@
+/*****************************************************************************
+ * Eliot
+ * Copyright (C) 2013 Olivier Teulière
+ * Authors: Olivier Teulière <ipkiss @@ gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#include "config.h"
+
+#include <iostream>
+#include <cstdlib>
+#include <boost/format.hpp>
+#include <getopt.h>
+
+#if ENABLE_NLS
+#   include <libintl.h>
+#   define _(String) gettext(String)
+#else
+#   define _(String) String
+#endif
+
+#include "dic.h"
+#include "game_params.h"
+#include "simulation.h"
+#include "leave_table_builder.h"
+#include "base_exception.h"
+
+using namespace std;
+
+// Useful shortcut
+#define fmt(a) boost::format(a)
+
+
+void printUsage(const string &iBinaryName)
+{
+    cout << "Usage: " << iBinaryName << " [options]" << endl
+         << _("Mandatory options:") << endl
+         << _("  -d, --dictionary <string>  Path to the dictionary") << endl
+         << _("  -o, --output <string>      Path to the generated leave table") << endl
+         << _("Other options:") << endl
+         << _("  -n, --games <num>          Number of free games to play (default: 1000)") << endl
+         << _("  -p, --players <num>        Number of AI players in each game (default: 2)") << endl
+         << _("  -s, --seed <num>           Seed of the games (default: 0)") << endl
+         << _("  -j, --threads <num>        Number of threads used to play the games") << endl
+         << _("                             (default: 0, meaning one thread per core)") << endl
+         << _("  -h, --help                 Print this help and exit") << endl
+         << _("Example:") << endl
+         << "  " << iBinaryName << _(" -d ods5.dawg -o ods5.leaves -n 100000") << endl
+         << endl
+         << _("The AI players use the leave table given by the \"general.leave-table\" "
+              "setting, if any, so a table can be refined by generating a new one "
+              "with the previous one.") << endl;
+}
+
+
+int main(int argc, char* argv[])
+{
+#if HAVE_SETLOCALE
+    // Set locale via LC_ALL
+    setlocale(LC_ALL, "");
+#endif
+
+#if ENABLE_NLS
+    // Set the message domain
+    bindtextdomain(PACKAGE, LOCALEDIR);
+    textdomain(PACKAGE);
+#endif
+
+    static const struct option long_options[] =
+    {
+        {"help", no_argument, NULL, 'h'},
+        {"dictionary", required_argument, NULL, 'd'},
+        {"output", required_argument, NULL, 'o'},
+        {"games", required_argument, NULL, 'n'},
+        {"players", required_argument, NULL, 'p'},
+        {"seed", required_argument, NULL, 's'},
+        {"threads", required_argument, NULL, 'j'},
+        {0, 0, 0, 0}
+    };
+    static const char short_options[] = "hd:o:n:p:s:j:";
+
+    string dicFileName;
+    string outFileName;
+    unsigned nbGames = 1000;
+    unsigned nbPlayers = 2;
+    uint64_t seed = 0;
+    unsigned nbThreads = 0;
+
+    int res;
+    int option_index = 1;
+    while ((res = getopt_long(argc, argv, short_options,
+                              long_options, &option_index)) != -1)
+    {
+        switch (res)
+        {
+            case 'h':
+                printUsage(argv[0]);
+                exit(0);
+            case 'd':
+                dicFileName = optarg;
+                break;
+            case 'o':
+                outFileName = optarg;
+                break;
+            case 'n':
+                nbGames = atoi(optarg);
+                break;
+            case 'p':
+                nbPlayers = atoi(optarg);
+                break;
+            case 's':
+                seed = strtoull(optarg, NULL, 10);
+                break;
+            case 'j':
+                nbThreads = atoi(optarg);
+                break;
+            default:
+                printUsage(argv[0]);
+                exit(1);
+        }
+    }
+
+    // Check mandatory options
+    if (dicFileName.empty() || outFileName.empty())
+    {
+        cerr << _("A mandatory option is missing") << endl;
+        printUsage(argv[0]);
+        exit(1);
+    }
+    if (nbPlayers == 0)
+    {
+        cerr << _("At least one player is needed") << endl;
+        exit(1);
+    }
+
+    try
+    {
+        const Dictionary dic(dicFileName);
+
+        Simulation simulation(GameParams(dic, GameParams::kFREEGAME));
+        simulation.setSeed(seed);
+        for (unsigned i = 0; i < nbPlayers; ++i)
+            simulation.addPlayer(1);
+
+        LeaveTableBuilder builder(dic);
+        simulation.run(nbGames, builder, nbThreads);
+        builder.write(outFileName);
+
+        cout << fmt(_("%1% games played, %2% leaves recorded")) % nbGames
+                % builder.getNbSamples() << endl;
+        return 0;
+    }
+    catch (const BaseException &e)
+    {
+        cerr << "Exception caught: " << e.what() << "\n" << e.getStackTrace();
+    }
+    catch (std::exception &e)
+    {
+        cerr << "Exception caught: " << e.what() << endl;
+    }
+    return 1;
+}
+